@@ -0,0 +1 @@
+DEPEND_LIBS := mpilib eaxlib
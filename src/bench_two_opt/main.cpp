@@ -0,0 +1,196 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "command_line_argument_parser.hpp"
+
+#include "tsp_loader.hpp"
+#include "tour_constructor.hpp"
+#include "two_opt.hpp"
+
+struct Arguments {
+    // 都市数のリスト (カンマ区切り)
+    std::string sizes = "1000,10000,100000";
+    // 都市数ごとに2-optを適用する初期巡回路の数
+    size_t tours = 3;
+    // 乱数のseed値
+    std::mt19937::result_type seed = std::mt19937::default_seed;
+    // 2-optの近傍範囲
+    size_t near_range = 10;
+    // 初期巡回路の構築方法
+    std::string initial_tour_type_str = "random"; // "random", "greedy", "nn", or "hilbert"
+    // 2-optに加えて Or-opt を行うかどうか
+    bool or_opt = false;
+    // 2-optに加えて 2h-opt を行うかどうか
+    bool two_h_opt = false;
+};
+
+/**
+ * @brief 一様乱数の座標を持つ EUC_2D のインスタンスをTSPLIB形式で書き出す
+ */
+void write_uniform_instance(const std::string& file_name, size_t city_count, std::mt19937& rng)
+{
+    std::ofstream out(file_name);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open the file: " + file_name);
+    }
+    std::uniform_int_distribution<int> coordinate(0, 999999);
+    out << "NAME: uniform" << city_count << "\n";
+    out << "TYPE: TSP\n";
+    out << "DIMENSION: " << city_count << "\n";
+    out << "EDGE_WEIGHT_TYPE: EUC_2D\n";
+    out << "NODE_COORD_SECTION\n";
+    for (size_t i = 0; i < city_count; ++i) {
+        out << i + 1 << " " << coordinate(rng) << " " << coordinate(rng) << "\n";
+    }
+    out << "EOF\n";
+}
+
+int64_t tour_length(const std::vector<size_t>& path, const tsp::DistanceView& distance)
+{
+    int64_t length = 0;
+    for (size_t i = 0; i < path.size(); ++i) {
+        length += distance[path[i]][path[(i + 1) % path.size()]];
+    }
+    return length;
+}
+
+/**
+ * @brief 都市0から始まるように回転した訪問順 (向きは保つ)
+ */
+std::vector<size_t> rotate_to_first_city(std::vector<size_t> path)
+{
+    std::rotate(path.begin(), std::find(path.begin(), path.end(), 0), path.end());
+    return path;
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace std;
+    Arguments args;
+    // コマンドライン引数の解析
+    mpi::CommandLineArgumentParser parser;
+
+    mpi::ArgumentSpec sizes_spec(args.sizes);
+    sizes_spec.add_argument_name("--sizes");
+    sizes_spec.set_description("--sizes <list> \t\t:Comma-separated city counts of the uniform random instances (default: 1000,10000,100000).");
+    parser.add_argument(sizes_spec);
+
+    mpi::ArgumentSpec tours_spec(args.tours);
+    tours_spec.add_argument_name("--tours");
+    tours_spec.set_description("--tours <number> \t:Number of start tours per instance (default: 3).");
+    parser.add_argument(tours_spec);
+
+    mpi::ArgumentSpec seed_spec(args.seed);
+    seed_spec.add_argument_name("--seed");
+    seed_spec.set_description("--seed <value> \t\t:Seed value for the instances and the start tours.");
+    parser.add_argument(seed_spec);
+
+    mpi::ArgumentSpec near_range_spec(args.near_range);
+    near_range_spec.add_argument_name("--near-range");
+    near_range_spec.set_description("--near-range <number> \t:Number of neighbors examined by 2-opt (default: 10).");
+    parser.add_argument(near_range_spec);
+
+    mpi::ArgumentSpec init_spec(args.initial_tour_type_str);
+    init_spec.add_argument_name("--init");
+    init_spec.set_description("--init <type> \t\t:Construction of the start tours. Options are 'random' (default), 'greedy', 'nn', and 'hilbert'.");
+    parser.add_argument(init_spec);
+
+    mpi::ArgumentSpec or_opt_spec(args.or_opt);
+    or_opt_spec.add_set_argument_name("--or-opt");
+    or_opt_spec.set_description("--or-opt \t\t:Also apply Or-opt moves (segments of 1-3 cities).");
+    parser.add_argument(or_opt_spec);
+
+    mpi::ArgumentSpec two_h_opt_spec(args.two_h_opt);
+    two_h_opt_spec.add_set_argument_name("--two-h-opt");
+    two_h_opt_spec.set_description("--two-h-opt \t\t:Also apply 2h-opt moves (moving a single city of a 2-opt move instead of reversing).");
+    parser.add_argument(two_h_opt_spec);
+
+    bool help_requested = false;
+    mpi::ArgumentSpec help_spec(help_requested);
+    help_spec.add_set_argument_name("--help");
+    help_spec.set_description("--help \t\t:Display this help message.");
+    parser.add_argument(help_spec);
+
+    parser.parse(argc, argv);
+
+    if (help_requested) {
+        parser.print_help();
+        return 0;
+    }
+
+    vector<size_t> sizes;
+    {
+        stringstream list(args.sizes);
+        string item;
+        while (getline(list, item, ',')) {
+            sizes.push_back(stoul(item));
+        }
+    }
+    const tsp::InitialTourType initial_tour_type = tsp::parse_initial_tour_type(args.initial_tour_type_str);
+
+    mt19937 rng(args.seed);
+    const string instance_file = (filesystem::temp_directory_path() / ("bench_two_opt_" + to_string(args.seed) + ".tsp")).string();
+
+    cout << "| cities | backend | time per tour [s] | mean length |" << endl;
+    cout << "|---|---|---|---|" << endl;
+    for (size_t city_count : sizes) {
+        write_uniform_instance(instance_file, city_count, rng);
+        tsp::TSP tsp = tsp::TSP_Loader::load_tsp(instance_file);
+        filesystem::remove(instance_file);
+
+        // 両方のデータ構造に同じ初期巡回路とシードを与える
+        const tsp::TourConstructor tour_constructor(tsp, initial_tour_type);
+        vector<vector<size_t>> start_tours(args.tours);
+        vector<mt19937::result_type> seeds(args.tours);
+        for (size_t i = 0; i < args.tours; ++i) {
+            seeds[i] = rng();
+            if (initial_tour_type == tsp::InitialTourType::Random) {
+                start_tours[i].resize(city_count);
+                iota(start_tours[i].begin(), start_tours[i].end(), 0);
+                shuffle(start_tours[i].begin(), start_tours[i].end(), rng);
+            } else {
+                start_tours[i] = tour_constructor.construct(rng());
+            }
+        }
+
+        vector<vector<size_t>> reference;
+        for (auto backend : {eax::TwoOptBackend::SplayTree, eax::TwoOptBackend::TwoLevelList}) {
+            const eax::TwoOpt two_opt(tsp.distance(), tsp.NN_list, args.near_range, backend, args.or_opt, args.two_h_opt);
+            vector<vector<size_t>> results = start_tours;
+            auto start_time = chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < args.tours; ++i) {
+                two_opt.apply(results[i], seeds[i]);
+            }
+            auto end_time = chrono::high_resolution_clock::now();
+
+            int64_t total_length = 0;
+            for (auto& path : results) {
+                total_length += tour_length(path, tsp.distance());
+                path = rotate_to_first_city(std::move(path));
+            }
+            // どちらのデータ構造でも同じ巡回路になるはず
+            if (reference.empty()) {
+                reference = std::move(results);
+            } else if (results != reference) {
+                throw std::runtime_error("The 2-opt backends produced different tours for " + to_string(city_count) + " cities.");
+            }
+
+            const double seconds = chrono::duration<double>(end_time - start_time).count() / static_cast<double>(max<size_t>(1, args.tours));
+            cout << "| " << city_count << " | " << (backend == eax::TwoOptBackend::SplayTree ? "splay" : "two-level") << " | "
+                 << fixed << setprecision(4) << seconds << " | "
+                 << setprecision(0) << static_cast<double>(total_length) / static_cast<double>(max<size_t>(1, args.tours)) << " |" << endl;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
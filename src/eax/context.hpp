@@ -6,6 +6,7 @@
 #include <random>
 
 #include "edge_counter.hpp"
+#include "population_content_index.hpp"
 #include "tsp_loader.hpp"
 #include "object_pool.hpp"
 #include "limited_range_integer_set.hpp"
@@ -19,7 +20,7 @@
 namespace eax {
     using Individual = eax::IndividualWithPendingDelta;
 
-    using eax_type_t = std::variant<EAX_Rand_tag, EAX_n_AB_tag, EAX_Block2_tag, EAX_full_UNIFORM_tag>;
+    using eax_type_t = std::variant<EAX_Rand_tag, EAX_n_AB_tag, EAX_Block2_tag, EAX_Sparse_Block2_tag, EAX_full_UNIFORM_tag>;
 
     enum class SelectionType {
         Greedy,
@@ -28,12 +29,14 @@ namespace eax {
     };
     
     struct Environment {
-        tsp::TSP tsp;
+        tsp::InstanceData tsp;
         size_t population_size;
         size_t num_children;
         SelectionType selection_type;
         std::mt19937::result_type random_seed;
         eax_type_t eax_type;
+        // Block2 で部分巡回路を統合する前に、選ばれない子個体を下界で捨てるかどうか
+        bool prune_children = false;
     };
 
     struct Context {
@@ -41,6 +44,8 @@ namespace eax {
 
         // std::vector<std::vector<size_t>> pop_edge_counts; // 各エッジの個数
         EdgeCounter<> pop_edge_counts;
+        // 各内容ハッシュの個体数
+        PopulationContentIndex pop_content_index;
         std::mt19937 random_gen;
 
         // 最良解の長さ
@@ -76,6 +81,7 @@ namespace eax {
         Context(const Environment& environment, const std::vector<Individual>& initial_population)
             : env(environment),
               pop_edge_counts(initial_population),
+              pop_content_index(initial_population),
               random_gen(environment.random_seed),
               entropy(pop_edge_counts.calc_entropy()) {}
     };
@@ -1,6 +1,7 @@
 #include "ga.hpp"
 
 #include <fstream>
+#include <functional>
 
 #include "genetic_algorithm.hpp"
 
@@ -26,43 +27,67 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     using namespace std;
     using Context = eax::Context;
     // オブジェクトプール
-    eax::ObjectPools object_pools(context.env.tsp.city_count);
+    eax::ObjectPools object_pools(context.env.tsp->city_count);
     
     // 交叉関数
     eax::EAX_N_AB eax_n_ab(object_pools);
     eax::EAX_Block2 eax_block2(object_pools);
+    eax::EAX_Sparse_Block2 eax_sparse_block2(object_pools);
     eax::EAX_Rand eax_rand(object_pools);
     eax::EAX_UNIFORM eax_uniform(object_pools);
-    auto crossover_func = [&eax_n_ab, &eax_block2, &eax_rand, &eax_uniform](const Individual& parent1, const Individual& parent2,
-                                Context& context) {
+    // 子個体は生成されるたびに on_child に渡し、世代交代モデルが最良のものだけを保持する
+    auto crossover_func = [&eax_n_ab, &eax_block2, &eax_sparse_block2, &eax_rand, &eax_uniform](const Individual& parent1, const Individual& parent2,
+                                Context& context, auto&& on_child) {
         auto& env = context.env;
+        using OnChild = decltype(on_child);
         
         struct {
             eax::EAX_N_AB& eax_n_ab;
             eax::EAX_Block2& eax_block2;
+            eax::EAX_Sparse_Block2& eax_sparse_block2;
             eax::EAX_Rand& eax_rand;
             eax::EAX_UNIFORM& eax_uniform;
             const Individual& parent1;
             const Individual& parent2;
             Context& context;
-            auto operator()(const eax::EAX_Rand_tag&) {
-                return eax_rand(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen);
+            OnChild on_child;
+            void operator()(const eax::EAX_Rand_tag&) {
+                eax_rand.for_each_child(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, on_child);
             }
 
-            auto operator()(const eax::EAX_n_AB_tag& n_ab) {
-                return eax_n_ab(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, n_ab.get_n());
+            void operator()(const eax::EAX_n_AB_tag& n_ab) {
+                eax_n_ab.for_each_child(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, on_child, n_ab.get_n());
             }
 
-            auto operator()(const eax::EAX_Block2_tag&) {
-                return eax_block2(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen);
+            void operator()(const eax::EAX_Block2_tag&) {
+                if (context.env.prune_children) {
+                    eax_block2.for_each_child(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, on_child);
+                } else {
+                    eax_block2.for_each_child(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, without_pruning());
+                }
             }
 
-            auto operator()(const eax::EAX_UNIFORM_tag& uniform) {
-                return eax_uniform(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, uniform.get_ratio());
+            void operator()(const eax::EAX_Sparse_Block2_tag&) {
+                if (context.env.prune_children) {
+                    eax_sparse_block2.for_each_child(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, on_child);
+                } else {
+                    eax_sparse_block2.for_each_child(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, without_pruning());
+                }
             }
-        } visitor {eax_n_ab, eax_block2, eax_rand, eax_uniform, parent1, parent2, context};
+
+            void operator()(const eax::EAX_UNIFORM_tag& uniform) {
+                eax_uniform.for_each_child(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, on_child, uniform.get_ratio());
+            }
+
+            // 子個体を on_child に渡すだけの関数 (child_pruning_handler を満たさないので、交叉は下界による枝刈りをしない)
+            auto without_pruning() {
+                return [this](eax::CrossoverDelta& child) {
+                    on_child(child);
+                };
+            }
+        } visitor {eax_n_ab, eax_block2, eax_sparse_block2, eax_rand, eax_uniform, parent1, parent2, context, std::forward<OnChild>(on_child)};
         
-        return std::visit(visitor, env.eax_type);
+        std::visit(visitor, env.eax_type);
     };
 
     // 適応度関数
@@ -80,6 +105,21 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
         }
     };
     
+    // 適応度の上界 (--prune-children の指定時に、Block2 が部分巡回路を統合する前に子個体を捨てるのに使う)
+    auto calc_fitness_upper_bound_lambda = [](int64_t delta_distance_lower_bound, Context& context) {
+        auto& env = context.env;
+        switch (env.selection_type) {
+            case eax::SelectionType::Greedy:
+                return eax::eval::delta::Greedy.upper_bound(delta_distance_lower_bound);
+            case eax::SelectionType::Ent:
+                return eax::eval::delta::Entropy.upper_bound(delta_distance_lower_bound);
+            case eax::SelectionType::DistancePreserving:
+                return eax::eval::delta::DistancePreserving.upper_bound(delta_distance_lower_bound);
+            default:
+                throw std::runtime_error("Unknown selection type");
+        }
+    };
+    
     // 更新処理関数
     struct {
         mpi::genetic_algorithm::TerminationReason operator()(vector<Individual>& population, Context& context, size_t generation) {
@@ -92,11 +132,15 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
         
         void update_individual_and_edge_counts(vector<Individual>& population, Context& context) {
             for (auto& individual : population) {
+                uint64_t old_content_hash = individual.get_content_hash();
                 auto delta = individual.apply_pending_delta();
                 auto delta_H = eax::calc_delta_entropy(delta, context.pop_edge_counts, context.env.population_size);
                 context.entropy += delta_H;
 
                 context.pop_edge_counts.apply_crossover_delta(delta);
+
+                context.pop_content_index.remove(old_content_hash);
+                context.pop_content_index.add(individual.get_content_hash());
             }
         }
 
@@ -132,11 +176,25 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     std::ofstream log_file_stream;
     if (!log_file_name.empty()) {
         log_file_stream.open(log_file_name);
-        log_file_stream << "Generation,BestLength,AverageLength,WorstLength,Entropy,TimePerGeneration" << std::endl;
+        log_file_stream << "Generation,BestLength,AverageLength,WorstLength,Entropy,TimePerGeneration,DuplicateChildren,CheckedChildren,PrunedChildren,DuplicateIndividuals" << std::endl;
     }
 
+    // 部分巡回路の統合の前に子個体を捨てた回数の全交叉の合計 (累計)
+    auto sum_pruning_stats = [&eax_n_ab, &eax_block2, &eax_sparse_block2, &eax_rand, &eax_uniform]() {
+        eax::ChildPruningStats total;
+        for (const eax::ChildPruningStats* stats : {&eax_n_ab.get_pruning_stats(), &eax_block2.get_pruning_stats(), &eax_sparse_block2.get_pruning_stats(),
+                                                    &eax_rand.get_pruning_stats(), &eax_uniform.get_pruning_stats()}) {
+            total.checked_children += stats->checked_children;
+            total.pruned_children += stats->pruned_children;
+            total.duplicate_children += stats->duplicate_children;
+        }
+        return total;
+    };
+
     struct {
         std::ofstream& log_file_stream;
+        std::function<eax::ChildPruningStats()> sum_pruning_stats;
+        eax::ChildPruningStats last_pruning_stats{};
 
         void operator()([[maybe_unused]]const vector<Individual>& population, Context& context, size_t generation) {
             double time_per_generation = 0.0;
@@ -165,9 +223,17 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
             double worst_length = *worst_length_ptr;
             double average_length = std::accumulate(lengths.begin(), lengths.end(), 0.0) / lengths.size();
             
-            log_file_stream << generation << "," << best_length << "," << average_length << "," << worst_length << "," << context.entropy << "," << time_per_generation << std::endl;
+            eax::ChildPruningStats pruning_stats = sum_pruning_stats();
+            size_t duplicate_children_per_generation = pruning_stats.duplicate_children - last_pruning_stats.duplicate_children;
+            size_t checked_children_per_generation = pruning_stats.checked_children - last_pruning_stats.checked_children;
+            size_t pruned_children_per_generation = pruning_stats.pruned_children - last_pruning_stats.pruned_children;
+            last_pruning_stats = pruning_stats;
+            
+            log_file_stream << generation << "," << best_length << "," << average_length << "," << worst_length << "," << context.entropy << "," << time_per_generation << ","
+                            << duplicate_children_per_generation << "," << checked_children_per_generation << "," << pruned_children_per_generation << ","
+                            << context.pop_content_index.duplicate_count() << std::endl;
         }
-    } logging {log_file_stream};
+    } logging {log_file_stream, sum_pruning_stats};
     
     struct {
         void operator()([[maybe_unused]]const vector<Individual>& population, Context& context, size_t generation, [[maybe_unused]]mpi::genetic_algorithm::TerminationReason reason) {
@@ -176,7 +242,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     } post_process;
 
     // 世代交代処理
-    eax::NagataGenerationChangeModel generational_step(calc_fitness_lambda, crossover_func);
+    eax::NagataGenerationChangeModel generational_step(calc_fitness_lambda, crossover_func, calc_fitness_upper_bound_lambda);
     
     // GA実行オブジェクト
     mpi::GenerationalChangeModel genetic_algorithm(generational_step, update_func, logging, post_process);
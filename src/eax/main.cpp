@@ -29,6 +29,7 @@
 #include "context.hpp"
 #include "ga.hpp"
 #include "two_opt.hpp"
+#include "common_arguments.hpp"
 #include "command_line_argument_parser.hpp"
 #include "eax_tag.hpp"
 #include <time.h>
@@ -52,8 +53,10 @@ struct Arguments {
     std::string output_file_name = "result.md";
     // ログファイル名
     std::string log_file_name = "";
-    // キャッシュディレクトリ
-    std::string cache_directory = ".";
+    // 各アプリに共通する引数 (キャッシュディレクトリ、近傍リスト、初期集団の生成)
+    eax::CommonArguments common;
+    // Block2 で部分巡回路を統合する前に子個体を枝刈りするかどうか
+    bool prune_children = false;
 };
 
 void print_result(const eax::Context& context, std::ostream& os, mpi::genetic_algorithm::TerminationReason reason)
@@ -64,7 +67,7 @@ void print_result(const eax::Context& context, std::ostream& os, mpi::genetic_al
         os << "|----------|-----------------|----------------|------------------------|------|-------------|-------------------------|-------------------|----------|--------------------|" << std::endl;
     }
     
-    os << "| " << context.env.tsp.name << " | " << context.env.population_size << " | "; 
+    os << "| " << context.env.tsp->name << " | " << context.env.population_size << " | "; 
     switch (context.env.selection_type) {
         case eax::SelectionType::Greedy:
             os << "greedy";
@@ -122,7 +125,9 @@ void execute_normal(const Arguments& args)
         throw std::runtime_error("Unknown selection type '" + args.selection_type_str + "'. Options are 'greedy', 'ent', or 'distance'.");
     }
 
-    tsp::TSP tsp = tsp::TSP_Loader::load_tsp(args.file_name);
+    const tsp::LoadOptions load_options = eax::make_load_options(args.common);
+    const tsp::InstanceData instance = tsp::TSP_Loader::load_instance(args.file_name, load_options);
+    const tsp::TSP& tsp = *instance;
     cout << "TSP Name: " << tsp.name << endl;
     cout << "Distance Type: " << tsp.distance_type << endl;
     cout << "Number of Cities: " << tsp.city_count << endl;
@@ -131,24 +136,20 @@ void execute_normal(const Arguments& args)
     mt19937 rng(args.seed);
     
     // neighbor_range
-    size_t near_range = 50; // 近傍範囲
+    size_t near_range = args.common.near_range; // 近傍範囲
+    const tsp::InitialTourType initial_tour_type = tsp::parse_initial_tour_type(args.common.initial_tour_type_str);
     // 2opt
-    eax::TwoOpt two_opt(tsp.adjacency_matrix, tsp.NN_list, near_range);
+    eax::TwoOpt two_opt(tsp.distance(), tsp.NN_list, near_range, eax::TwoOptBackend::SplayTree, args.common.or_opt, args.common.two_h_opt);
     // 初期集団生成器
-    tsp::PopulationInitializer population_initializer(args.population_size, tsp.city_count);
+    tsp::PopulationInitializer population_initializer(args.population_size, tsp::TourConstructor(tsp, initial_tour_type));
+    population_initializer.set_thread_count(args.common.thread_count);
     
     for (size_t trial = 0; trial < args.trials; ++trial) {
         cout << "Trial " << trial + 1 << " of " << args.trials << endl;
         // 乱数生成器(ローカル)
         // グローバルで初期化
         mt19937::result_type local_seed = rng();
-        string cache_file = "init_pop_cache_" + to_string(local_seed) + "_for_" + tsp.name + "_" + to_string(args.population_size) + ".txt";
-
-        if (args.cache_directory.ends_with('/')) {
-            cache_file = args.cache_directory + cache_file;
-        } else {
-            cache_file = args.cache_directory + "/" + cache_file;
-        }
+        string cache_file = eax::population_cache_file(args.common, tsp, args.population_size, local_seed);
 
         vector<vector<size_t>> initial_paths = population_initializer.initialize_population(local_seed, cache_file, [&two_opt, local_seed](vector<size_t>& path) {
             // 2-optを適用
@@ -157,7 +158,7 @@ void execute_normal(const Arguments& args)
         vector<eax::Individual> population;
         population.reserve(initial_paths.size());
         for (const auto& path : initial_paths) {
-            population.emplace_back(path, tsp.adjacency_matrix);
+            population.emplace_back(path, tsp.distance());
         }
 
         cout << "Initial population created." << endl;
@@ -167,7 +168,7 @@ void execute_normal(const Arguments& args)
         eax_type = eax::create_eax_tag_from_string<eax::eax_type_t>(args.eax_type_str);
 
         // 環境
-        eax::Environment ga_env{tsp, args.population_size, args.num_children, selection_type, local_seed, eax_type};
+        eax::Environment ga_env{instance, args.population_size, args.num_children, selection_type, local_seed, eax_type, args.prune_children};
         eax::Context ga_context{ga_env, population};
         
         cout << "Starting genetic algorithm..." << endl;
@@ -229,7 +230,7 @@ int main(int argc, char* argv[])
     
     mpi::ArgumentSpec eax_type_spec(args.eax_type_str);
     eax_type_spec.add_argument_name("--eax-type");
-    eax_type_spec.set_description("--eax-type <type> \t:EAX crossover type. Options are 'EAX_1_AB' (default), 'EAX_Rand', 'EAX_UNIFORM', and 'EAX_Block2'. EAX_{N}_AB is also supported, where {N} is a positive integer.");
+    eax_type_spec.set_description("--eax-type <type> \t:EAX crossover type. Options are 'EAX_1_AB' (default), 'EAX_Rand', 'EAX_UNIFORM', 'EAX_Block2', and 'SparseBlock2' (Block2 searching only the edges where the parents differ). EAX_{N}_AB is also supported, where {N} is a positive integer.");
     parser.add_argument(eax_type_spec);
     
     mpi::ArgumentSpec output_spec(args.output_file_name);
@@ -242,10 +243,12 @@ int main(int argc, char* argv[])
     log_file_name_spec.set_description("--log <filename> \t:Log file name.");
     parser.add_argument(log_file_name_spec);
     
-    mpi::ArgumentSpec cache_dir_spec(args.cache_directory);
-    cache_dir_spec.add_argument_name("--cache-dir");
-    cache_dir_spec.set_description("--cache-dir <directory> \t:Directory to store cache files of initial populations (default: current directory).");
-    parser.add_argument(cache_dir_spec);
+    eax::register_common_arguments(parser, args.common);
+
+    mpi::ArgumentSpec prune_children_spec(args.prune_children);
+    prune_children_spec.add_set_argument_name("--prune-children");
+    prune_children_spec.set_description("--prune-children \t:With Block2 and SparseBlock2, discard children that cannot be selected before merging their subtours (off by default; it only pays off when many children are discarded).");
+    parser.add_argument(prune_children_spec);
     
     bool help_requested = false;
     mpi::ArgumentSpec help_spec(help_requested);
@@ -26,7 +26,7 @@ namespace eax {
     };
     
     struct Environment {
-        tsp::TSP tsp;
+        tsp::InstanceData tsp;
         size_t population_size;
         size_t num_children;
         SelectionType selection_type;
@@ -30,7 +30,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     using namespace std;
     using Context = eax::Context;
     // オブジェクトプール
-    eax::ObjectPools object_pools(context.env.tsp.city_count);
+    eax::ObjectPools object_pools(context.env.tsp->city_count);
     
     // 交叉関数
     using Adaptive_N_AB = Adaptive<eax::N_AB_e_set_assembler_builder>;
@@ -51,15 +51,15 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
             const Individual& parent2;
             Context& context;
             auto operator()(const eax::EAX_Rand_tag&) {
-                return eax_rand(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, {}, std::forward_as_tuple(context.pop_edge_counts, context.env.range_size));
+                return eax_rand(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, {}, std::forward_as_tuple(context.pop_edge_counts, context.env.range_size));
             }
 
             auto operator()(const eax::EAX_n_AB_tag& n_ab) {
-                return eax_n_ab(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, n_ab.get_n(), std::forward_as_tuple(context.pop_edge_counts, context.env.range_size));
+                return eax_n_ab(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, n_ab.get_n(), std::forward_as_tuple(context.pop_edge_counts, context.env.range_size));
             }
 
             auto operator()(const eax::EAX_UNIFORM_tag& uniform) {
-                return eax_uniform(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, uniform.get_ratio(), std::forward_as_tuple(context.pop_edge_counts, context.env.range_size));
+                return eax_uniform(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, uniform.get_ratio(), std::forward_as_tuple(context.pop_edge_counts, context.env.range_size));
             }
         } visitor {adaptive_n_ab, adaptive_rand, adaptive_uniform, parent1, parent2, context};
         
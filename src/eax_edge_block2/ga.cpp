@@ -24,7 +24,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     using namespace std;
     using Context = eax::Context;
     // オブジェクトプール
-    eax::ObjectPools object_pools(context.env.tsp.city_count);
+    eax::ObjectPools object_pools(context.env.tsp->city_count);
     
     // 交叉関数
     // eax::EAX_N_AB eax_n_ab(object_pools);
@@ -35,9 +35,9 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
         auto& env = context.env;
         switch (context.eax_type) {
             case eax::EAXType::One_AB:
-                return edge_ref_n_ab(parent1, parent2, env.num_children, env.tsp, context.random_gen, 1, context.pop_edge_counts);
+                return edge_ref_n_ab(parent1, parent2, env.num_children, *env.tsp, context.random_gen, 1, context.pop_edge_counts);
             case eax::EAXType::Block2:
-                return eax_block2(parent1, parent2, env.num_children, env.tsp, context.random_gen);
+                return eax_block2(parent1, parent2, env.num_children, *env.tsp, context.random_gen);
             default:
                 throw std::runtime_error("Unknown EAX type.");
         }
@@ -155,7 +155,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
             double worst_length = *std::max_element(lengths.begin(), lengths.end());
 
             // 母集団上のある頂点の隣接頂点の数の平均をedge_countとする
-            size_t edge_count = 2 * context.pop_edge_counts.get_unique_edge_count() / context.env.tsp.city_count;
+            size_t edge_count = 2 * context.pop_edge_counts.get_unique_edge_count() / context.env.tsp->city_count;
 
             out << generation << ","
                 << best_length << ","
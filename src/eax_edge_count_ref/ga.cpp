@@ -32,7 +32,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     using namespace std;
     using Context = eax::Context;
     // オブジェクトプール
-    eax::ObjectPools object_pools(context.env.tsp.city_count);
+    eax::ObjectPools object_pools(context.env.tsp->city_count);
 
     using ECRef_N_AB = ECRef<eax::N_AB_e_set_assembler_builder>;
     using ECRef_Rand = ECRef<eax::Rand_e_set_assembler_builder>;
@@ -54,15 +54,15 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
             const Individual& parent2;
             Context& context;
             auto operator()(const eax::EAX_Rand_tag&) {
-                return eax_rand(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, {}, context.edge_counter);
+                return eax_rand(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, {}, context.edge_counter);
             }
 
             auto operator()(const eax::EAX_n_AB_tag& n_ab) {
-                return eax_n_ab(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, n_ab.get_n(), context.edge_counter);
+                return eax_n_ab(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, n_ab.get_n(), context.edge_counter);
             }
 
             auto operator()(const eax::EAX_UNIFORM_tag& uniform) {
-                return eax_uniform(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, uniform.get_ratio(), context.edge_counter);
+                return eax_uniform(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, uniform.get_ratio(), context.edge_counter);
             }
         } visitor {eax_n_ab, eax_rand, eax_uniform, parent1, parent2, context};
         
@@ -170,7 +170,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
             double average_length = std::accumulate(lengths.begin(), lengths.end(), 0.0) / lengths.size();
             
             // 母集団上のある頂点の隣接頂点の数の平均をedge_countとする
-            size_t edge_count = 2 * context.edge_counter.get_unique_edge_count() / context.env.tsp.city_count;
+            size_t edge_count = 2 * context.edge_counter.get_unique_edge_count() / context.env.tsp->city_count;
             
             log_file_stream << generation << "," << best_length << "," << average_length << "," << worst_length << "," << context.entropy << "," << time_per_generation << "," << edge_count << std::endl;
         }
@@ -31,7 +31,7 @@
 #include "buffered_individual.hpp"
 
 
-double calc_fitness(const std::vector<size_t>& path, const std::vector<std::vector<int64_t>>& adjacency_matrix){
+double calc_fitness(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix){
     double distance = 0.0;
     for (size_t i = 0; i < path.size() - 1; ++i) {
         distance += adjacency_matrix[path[i]][path[i + 1]];
@@ -41,7 +41,7 @@ double calc_fitness(const std::vector<size_t>& path, const std::vector<std::vect
     return 1.0 / distance;
 }
 
-double calc_fitness(const std::vector<std::array<size_t, 2>>& adjacency_list, const std::vector<std::vector<int64_t>>& adjacency_matrix) {
+double calc_fitness(const std::vector<std::array<size_t, 2>>& adjacency_list, tsp::DistanceView adjacency_matrix) {
     double distance = 0.0;
     for (size_t i = 0; i < adjacency_list.size(); ++i) {
         size_t next1 = adjacency_list[i][0];
@@ -108,13 +108,14 @@ int main(int argc, char* argv[])
         return 0;
     }
     
-    tsp::TSP tsp = tsp::TSP_Loader::load_tsp(file_name);
+    const tsp::InstanceData instance = tsp::TSP_Loader::load_instance(file_name);
+    const tsp::TSP& tsp = *instance;
     cout << "TSP Name: " << tsp.name << endl;
     cout << "Distance Type: " << tsp.distance_type << endl;
     cout << "Number of Cities: " << tsp.city_count << endl;
     
     // 2 optを適用するためのオブジェクト
-    eax::TwoOpt two_opt(tsp.adjacency_matrix, tsp.NN_list, std::numeric_limits<size_t>::max());
+    eax::TwoOpt two_opt(tsp.distance(), tsp.NN_list, std::numeric_limits<size_t>::max());
     // 乱数生成器(グローバル)
     mt19937 rng(seed);
     
@@ -145,7 +146,7 @@ int main(int argc, char* argv[])
         cout << "Trial " << trial + 1 << " of " << trials << endl;
 
         mt19937::result_type local_seed = rng();
-        string cache_file = "init_pop_cache_" + to_string(local_seed) + "_for_" + file_name + "_" + to_string(population_size) + ".txt";
+        string cache_file = "init_pop_cache_" + to_string(local_seed) + "_for_" + file_name + "_" + to_string(population_size) + ".bin";
         vector<vector<size_t>> paths = population_initializer.initialize_population(local_seed, cache_file, [&two_opt, local_seed](vector<size_t>& path) {
             // 2-optを適用
             two_opt.apply(path, local_seed);
@@ -154,14 +155,14 @@ int main(int argc, char* argv[])
         vector<Individual> population;
         population.reserve(population_size);
         for (const auto& path : paths) {
-            population.emplace_back(path, tsp.adjacency_matrix);
+            population.emplace_back(path, tsp.distance());
         }
 
         cout << "Initial population created." << endl;
         
         // using Env = tsp::TSP;
         struct Env {
-            tsp::TSP tsp;
+            tsp::InstanceData tsp;
             std::mt19937 random_gen;
         };
         
@@ -169,7 +170,7 @@ int main(int argc, char* argv[])
         eax::EAX_Rand eax_rand(object_pools);
         
         auto crossover = [&eax_rand](const Individual& parent1, const Individual& parent2, Env& env) {
-            auto deltas = eax_rand(parent1, parent2, 100, env.tsp, env.random_gen);
+            auto deltas = eax_rand(parent1, parent2, 100, *env.tsp, env.random_gen);
             std::vector<Individual::delta_t> delta_views;
             delta_views.reserve(deltas.size());
             for (const auto& delta : deltas) {
@@ -235,7 +236,7 @@ int main(int argc, char* argv[])
         mt19937 local_rng(local_seed);
         
         // 環境情報の設定
-        Env env = {.tsp = tsp, .random_gen = local_rng};
+        Env env = {.tsp = instance, .random_gen = local_rng};
 
         // 計測開始
         auto start_time = chrono::high_resolution_clock::now();
@@ -22,7 +22,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     using namespace std;
     using Context = eax::Context;
     // オブジェクトプール
-    eax::ObjectPools object_pools(context.env.tsp.city_count);
+    eax::ObjectPools object_pools(context.env.tsp->city_count);
     
     // 交叉関数
     eax::EAX_tabu_Rand eax_tabu_rand(object_pools);
@@ -39,15 +39,15 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
             const Individual& parent2;
             Context& context;
             auto operator()(const EAX_Rand_tag&) {
-                return eax_tabu_rand(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, {}, {}, parent1.get_tabu_edges());
+                return eax_tabu_rand(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, {}, {}, parent1.get_tabu_edges());
             }
             
             auto operator()(const EAX_n_AB_tag& n_ab) {
-                return eax_tabu_n_ab(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, n_ab.get_n(), {}, parent1.get_tabu_edges());
+                return eax_tabu_n_ab(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, n_ab.get_n(), {}, parent1.get_tabu_edges());
             }
             
             auto operator()(const EAX_UNIFORM_tag& uniform) {
-                return eax_tabu_uniform(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, uniform.get_ratio(), {}, parent1.get_tabu_edges());
+                return eax_tabu_uniform(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, uniform.get_ratio(), {}, parent1.get_tabu_edges());
             }
         } visitor {eax_tabu_rand, eax_tabu_n_ab, eax_tabu_uniform, parent1, parent2, context};
         
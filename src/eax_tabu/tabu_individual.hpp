@@ -7,7 +7,7 @@
 
 class TabuIndividual : public eax::ReadableWithBasicIndividual<TabuIndividual> {
 public:
-    TabuIndividual(const std::vector<size_t>& path, const eax::adjacency_matrix_t& adjacency_matrix, size_t tabu_range = 5)
+    TabuIndividual(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix, size_t tabu_range = 5)
         : ReadableWithBasicIndividual<TabuIndividual>(path, adjacency_matrix),
             pending_delta(*this),
             tabu_range(tabu_range),
@@ -23,7 +23,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     using namespace std;
     using Context = eax::Context;
     // オブジェクトプール
-    eax::ObjectPools object_pools(context.env.tsp.city_count);
+    eax::ObjectPools object_pools(context.env.tsp->city_count);
     
     // 交叉関数
     eax::EAX_tabu_Rand eax_tabu_rand(object_pools);
@@ -50,15 +50,15 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
             Context& context;
             const std::vector<std::pair<size_t, size_t>>* tabu_edges_ptr;
             auto operator()(const EAX_Rand_tag&) {
-                return eax_tabu_rand(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, {}, {}, std::forward_as_tuple(*tabu_edges_ptr));
+                return eax_tabu_rand(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, {}, {}, std::forward_as_tuple(*tabu_edges_ptr));
             }
             
             auto operator()(const EAX_n_AB_tag& n_ab) {
-                return eax_tabu_n_ab(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, n_ab.get_n(), {}, std::forward_as_tuple(*tabu_edges_ptr));
+                return eax_tabu_n_ab(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, n_ab.get_n(), {}, std::forward_as_tuple(*tabu_edges_ptr));
             }
             
             auto operator()(const EAX_UNIFORM_tag& uniform) {
-                return eax_tabu_uniform(parent1, parent2, context.env.num_children, context.env.tsp, context.random_gen, uniform.get_ratio(), {}, std::forward_as_tuple(*tabu_edges_ptr));
+                return eax_tabu_uniform(parent1, parent2, context.env.num_children, *context.env.tsp, context.random_gen, uniform.get_ratio(), {}, std::forward_as_tuple(*tabu_edges_ptr));
             }
         } visitor {eax_tabu_rand, eax_tabu_n_ab, eax_tabu_uniform, parent1, parent2, context, tabu_edges_ptr};
         
@@ -26,7 +26,7 @@ namespace eax {
     };
 
     struct Environment {
-        tsp::TSP tsp;
+        tsp::InstanceData tsp;
         size_t N_parameter;
         size_t population_size;
         EAXType eax_type;
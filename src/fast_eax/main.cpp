@@ -124,7 +124,8 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    tsp::TSP tsp = tsp::TSP_Loader::load_tsp(file_name);
+    const tsp::InstanceData instance = tsp::TSP_Loader::load_instance(file_name);
+    const tsp::TSP& tsp = *instance;
     cout << "TSP Name: " << tsp.name << endl;
     cout << "Distance Type: " << tsp.distance_type << endl;
     cout << "Number of Cities: " << tsp.city_count << endl;
@@ -138,7 +139,7 @@ int main(int argc, char* argv[])
         near_range = std::numeric_limits<size_t>::max(); // グローバル2-optの場合は無制限
     }
     // 2opt
-    eax::TwoOpt two_opt(tsp.adjacency_matrix, tsp.NN_list, near_range);
+    eax::TwoOpt two_opt(tsp.distance(), tsp.NN_list, near_range);
     // 初期集団生成器
     tsp::PopulationInitializer population_initializer(population_size, tsp.city_count);
     
@@ -158,7 +159,7 @@ int main(int argc, char* argv[])
         // 乱数生成器(ローカル)
         // グローバルで初期化
         mt19937::result_type local_seed = rng();
-        string cache_file = "init_pop_cache_" + to_string(local_seed) + "_for_" + file_name + "_" + to_string(population_size) + ".txt";
+        string cache_file = "init_pop_cache_" + to_string(local_seed) + "_for_" + file_name + "_" + to_string(population_size) + ".bin";
         vector<vector<size_t>> initial_paths = population_initializer.initialize_population(local_seed, cache_file, [&two_opt, local_seed](vector<size_t>& path) {
             // 2-optを適用
             two_opt.apply(path, local_seed);
@@ -166,7 +167,7 @@ int main(int argc, char* argv[])
         vector<eax::Individual> population;
         population.reserve(initial_paths.size());
         for (const auto& path : initial_paths) {
-            population.emplace_back(path, tsp.adjacency_matrix);
+            population.emplace_back(path, tsp.distance());
         }
 
         cout << "Initial population created." << endl;
@@ -180,9 +181,9 @@ int main(int argc, char* argv[])
                                  Env& env) {
             switch (env.eax_type) {
                 case eax::EAXType::Rand:
-                    return eax_rand(parent1, parent2, 30, env.tsp, env.random_gen);
+                    return eax_rand(parent1, parent2, 30, *env.tsp, env.random_gen);
                 case eax::EAXType::N_AB:
-                    return eax_n_ab(parent1, parent2, 30, env.tsp, env.random_gen, std::forward_as_tuple(env.N_parameter));
+                    return eax_n_ab(parent1, parent2, 30, *env.tsp, env.random_gen, std::forward_as_tuple(env.N_parameter));
                 default:
                     throw std::runtime_error("Unknown EAX type");
             }
@@ -314,7 +315,7 @@ int main(int argc, char* argv[])
         
         // 環境
         Env tsp_env{
-            .tsp = tsp,
+            .tsp = instance,
             .N_parameter = 1,
             .population_size = population_size,
             .eax_type = use_local_eax ? eax::EAXType::N_AB : eax::EAXType::Rand,
@@ -1,11 +1,20 @@
 #include <string>
 #include <random>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <atomic>
+#include <map>
+#include <stdexcept>
 
 #include "command_line_argument_parser.hpp"
+#include "parallel_for.hpp"
 
 #include "tsp_loader.hpp"
 #include "population_initializer.hpp"
 #include "two_opt.hpp"
+#include "common_arguments.hpp"
 
 struct Arguments {
     // TSPファイルの名前
@@ -16,10 +25,53 @@ struct Arguments {
     size_t trials = 1;
     // 集団サイズ
     size_t population_size = 0;
-    // キャッシュディレクトリ
-    std::string cache_directory = ".";
+    // 各アプリに共通する引数 (キャッシュディレクトリ、近傍リスト、初期集団の生成)
+    eax::CommonArguments common;
+    // ジョブリストのファイル名 (指定した場合は --file, --ps, --trials の代わりに使う)
+    std::string jobs_file;
 };
 
+/**
+ * @brief 初期集団のキャッシュを生成するジョブ
+ */
+struct Job {
+    // TSPファイルの名前
+    std::string file_name;
+    // 集団サイズ
+    size_t population_size;
+    // 生成するシードの数 (--seed から生成したシード列の先頭から使う)
+    size_t seed_count;
+};
+
+/**
+ * @brief ジョブリストを読み込む
+ * @details 各行は "<TSPファイル> <集団サイズ> <シードの数>"。空行と # から始まる行は無視する。
+ * @throws std::runtime_error ファイルを開けない、または書式が正しくない場合
+ */
+std::vector<Job> read_job_list(const std::string& jobs_file)
+{
+    std::ifstream in(jobs_file);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open the job list: " + jobs_file);
+    }
+    std::vector<Job> jobs;
+    std::string line;
+    for (size_t line_number = 1; std::getline(in, line); ++line_number) {
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first) || first.starts_with('#')) {
+            continue;
+        }
+        Job job{first, 0, 0};
+        std::string rest;
+        if (!(fields >> job.population_size >> job.seed_count) || (fields >> rest) || job.population_size == 0) {
+            throw std::runtime_error(jobs_file + ":" + std::to_string(line_number) + ": expected '<tsp file> <population size> <seed count>'");
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
 int main(int argc, char* argv[])
 {
     using namespace std;
@@ -48,10 +100,12 @@ int main(int argc, char* argv[])
     seed_spec.set_description("--seed <value> \t\t:Seed value for random number generation.");
     parser.add_argument(seed_spec);
 
-    mpi::ArgumentSpec cache_dir_spec(args.cache_directory);
-    cache_dir_spec.add_argument_name("--cache-dir");
-    cache_dir_spec.set_description("--cache-dir <directory> \t:Cache directory path.");
-    parser.add_argument(cache_dir_spec);
+    eax::register_common_arguments(parser, args.common);
+
+    mpi::ArgumentSpec jobs_spec(args.jobs_file);
+    jobs_spec.add_argument_name("--jobs");
+    jobs_spec.set_description("--jobs <filename> \t:Job list with lines '<tsp file> <population size> <seed count>'. Each instance is loaded once and its jobs run concurrently. Replaces --file, --ps and --trials.");
+    parser.add_argument(jobs_spec);
 
     bool help_requested = false;
     mpi::ArgumentSpec help_spec(help_requested);
@@ -66,44 +120,97 @@ int main(int argc, char* argv[])
         return 0;
     }
     
-    if (args.population_size == 0) {
-        throw std::runtime_error("Population size must be greater than 0. Specify with --ps <size>.");
+    std::vector<Job> jobs;
+    if (!args.jobs_file.empty()) {
+        jobs = read_job_list(args.jobs_file);
+    } else {
+        if (args.population_size == 0) {
+            throw std::runtime_error("Population size must be greater than 0. Specify with --ps <size>.");
+        }
+        jobs.push_back({args.file_name, args.population_size, args.trials});
     }
 
     // 引数の表示
-    cout << "TSP File: " << args.file_name << endl;
-    cout << "Population Size: " << args.population_size << endl;
-    cout << "Trials: " << args.trials << endl;
+    if (!args.jobs_file.empty()) {
+        cout << "Job List: " << args.jobs_file << " (" << jobs.size() << " jobs)" << endl;
+    } else {
+        cout << "TSP File: " << args.file_name << endl;
+        cout << "Population Size: " << args.population_size << endl;
+        cout << "Trials: " << args.trials << endl;
+    }
     cout << "Seed: " << args.seed << endl;
-    cout << "Cache Directory: " << args.cache_directory << endl;
+    cout << "Cache Directory: " << args.common.cache_directory << endl;
 
-    // TSPデータの読み込み
-    tsp::TSP tsp = tsp::TSP_Loader::load_tsp(args.file_name);
-    // 乱数成器(グローバル)
-    mt19937 rng(args.seed);
+    const tsp::LoadOptions load_options = eax::make_load_options(args.common);
     // neighbor_range
-    size_t near_range = 50; // 近傍範囲
-    // 2opt
-    eax::TwoOpt two_opt(tsp.adjacency_matrix, tsp.NN_list, near_range);
-    // 初期集団生成器
-    tsp::PopulationInitializer population_initializer(args.population_size, tsp.city_count);
-
-    for (size_t trial = 0; trial < args.trials; ++trial) {
-        // 乱数生成器(ローカル)
-        // グローバルで初期化
-        mt19937::result_type local_seed = rng();
-        string cache_file = "init_pop_cache_" + to_string(local_seed) + "_for_" + tsp.name + "_" + to_string(args.population_size) + ".txt";
-
-        if (args.cache_directory.ends_with('/')) {
-            cache_file = args.cache_directory + cache_file;
-        } else {
-            cache_file = args.cache_directory + "/" + cache_file;
+    size_t near_range = args.common.near_range; // 近傍範囲
+    const tsp::InitialTourType initial_tour_type = tsp::parse_initial_tour_type(args.common.initial_tour_type_str);
+    // 各アプリと同じく、--seed で初期化した乱数生成器の出力を試行ごとのシードとする
+    size_t max_seed_count = 0;
+    for (const auto& job : jobs) {
+        max_seed_count = std::max(max_seed_count, job.seed_count);
+    }
+    vector<mt19937::result_type> local_seeds(max_seed_count);
+    mt19937 rng(args.seed);
+    for (auto& local_seed : local_seeds) {
+        local_seed = rng();
+    }
+
+    // インスタンスごとにジョブをまとめ、各インスタンスは一度だけ読み込む
+    // 同じインスタンスと集団サイズのジョブは同じキャッシュファイルに書き込むので、試行回数の最も多いジョブ1つにまとめる
+    map<string, map<size_t, size_t>> seed_counts_by_file;
+    vector<string> file_order;
+    for (const auto& job : jobs) {
+        auto [it, inserted] = seed_counts_by_file.try_emplace(job.file_name);
+        if (inserted) {
+            file_order.push_back(job.file_name);
+        }
+        size_t& seed_count = it->second[job.population_size];
+        seed_count = std::max(seed_count, job.seed_count);
+    }
+
+    const size_t thread_count = mpi::resolve_thread_count(args.common.thread_count);
+    for (const auto& file_name : file_order) {
+        tsp::TSP tsp = tsp::TSP_Loader::load_tsp(file_name, load_options);
+        // 2opt (同じインスタンスのジョブで距離と近傍リストを共有する)
+        eax::TwoOpt two_opt(tsp.distance(), tsp.NN_list, near_range, eax::TwoOptBackend::SplayTree, args.common.or_opt, args.common.two_h_opt);
+
+        // 初期集団生成器 (集団サイズごと)
+        map<size_t, tsp::PopulationInitializer<>> initializers;
+        struct Task {
+            const tsp::PopulationInitializer<>* initializer;
+            mt19937::result_type seed;
+            string cache_file;
+        };
+        vector<Task> tasks;
+        for (const auto& [population_size, seed_count] : seed_counts_by_file[file_name]) {
+            auto it = initializers.emplace(population_size, tsp::PopulationInitializer(population_size, tsp::TourConstructor(tsp, initial_tour_type))).first;
+            for (size_t trial = 0; trial < seed_count; ++trial) {
+                mt19937::result_type local_seed = local_seeds[trial];
+                string cache_file = eax::population_cache_file(args.common, tsp, population_size, local_seed);
+                tasks.push_back({&it->second, local_seed, std::move(cache_file)});
+            }
+        }
+
+        // ジョブが十分にあればジョブ単位で、少なければ各集団の個体単位で並列化する
+        const bool parallel_tasks = tasks.size() >= thread_count;
+        for (auto& [population_size, initializer] : initializers) {
+            initializer.set_thread_count(parallel_tasks ? 1 : thread_count);
         }
+        std::atomic<size_t> generated_count = 0;
+        mpi::parallel_for(0, tasks.size(), [&](size_t i) {
+            const Task& task = tasks[i];
+            if (task.initializer->has_cache(task.seed, task.cache_file)) {
+                return;
+            }
+            task.initializer->initialize_population(task.seed, task.cache_file, [&two_opt, local_seed = task.seed](vector<size_t>& path) {
+                // 2-optを適用
+                two_opt.apply(path, local_seed);
+            });
+            ++generated_count;
+        }, parallel_tasks ? thread_count : 1, 1);
 
-        population_initializer.initialize_population(local_seed, cache_file, [&two_opt, local_seed](vector<size_t>& path) {
-            // 2-optを適用
-            two_opt.apply(path, local_seed);
-        });
+        cout << tsp.name << ": generated " << generated_count << " of " << tasks.size() << " caches (" << tasks.size() - generated_count << " already valid)" << endl;
     }
 
     return 0;
@@ -4,26 +4,28 @@
 
 #include "object_pool.hpp"
 #include "limited_range_integer_set.hpp"
+#include "epoch_stamped_array.hpp"
 
 #include "eaxdef.hpp"
 #include "object_pools.hpp"
+#include "ab_cycle_set.hpp"
 
 namespace eax {
 
-using PooledVectorPtr = mpi::pooled_unique_ptr<std::vector<size_t>>;
+using ABCycleSetPtr = mpi::pooled_unique_ptr<ABCycleSet>;
 
-inline PooledVectorPtr create_AB_cycle(std::vector<size_t>& finding_path,
+/**
+ * @brief 探索経路の末尾にできた閉路を、構築中のABサイクルとして AB_cycles の末尾に書き出す
+ * @details 確定 (close_cycle) するか破棄するかは呼び出し側で決める
+ */
+inline void create_AB_cycle(std::vector<size_t>& finding_path,
                         size_t end_index,
                         mpi::LimitedRangeIntegerSet& cities_having_2_edges,
                         mpi::LimitedRangeIntegerSet& cities_having_just_1_edge,
-                        mpi::ObjectPool<std::vector<size_t>>& any_size_vector_pool)
+                        ABCycleSet& AB_cycles)
 {
     bool starts_with_B = finding_path.size() % 2 == 0;
     size_t start_index = finding_path.size() - 1;
-    auto AB_cycle_ptr = any_size_vector_pool.acquire_unique();
-    std::vector<size_t>& AB_cycle = *AB_cycle_ptr;
-    AB_cycle.clear();
-    AB_cycle.reserve(start_index - end_index);
     
     size_t last = 0;
     // ABサイクルはAのエッジから始まるようにする
@@ -40,7 +42,7 @@ inline PooledVectorPtr create_AB_cycle(std::vector<size_t>& finding_path,
     
     for (size_t i = start_index; i > end_index; i -= 1) {
         size_t current = finding_path[i];
-        AB_cycle.push_back(current);
+        AB_cycles.push_vertex(current);
         if (cities_having_2_edges.contains(current)) {
             cities_having_2_edges.erase(current);
             cities_having_just_1_edge.insert(current);
@@ -50,12 +52,23 @@ inline PooledVectorPtr create_AB_cycle(std::vector<size_t>& finding_path,
     }
     
     if (starts_with_B) {
-        AB_cycle.push_back(last);
+        AB_cycles.push_vertex(last);
     }
     
     finding_path.resize(end_index + 1);
-    
-    return AB_cycle_ptr;
+}
+
+/**
+ * @brief 構築中のABサイクルが長さ2より長ければ確定し、そうでなければ破棄する
+ * @details 長さ2のサイクルは共通の枝を往復するだけなので、ABサイクルとして扱わない
+ */
+inline void close_AB_cycle_if_effective(ABCycleSet& AB_cycles)
+{
+    if (AB_cycles.open_cycle().size() > 2) {
+        AB_cycles.close_cycle();
+    } else {
+        AB_cycles.discard_open_cycle();
+    }
 }
 
 /**
@@ -65,18 +78,20 @@ inline PooledVectorPtr create_AB_cycle(std::vector<size_t>& finding_path,
  * @param parent2 親個体2
  * @param rng 乱数生成器
  * @param any_size_vector_pool 汎用サイズのベクタープール
- * @param vector_of_tsp_size_pool TSPの都市数と同じサイズのベクタープール
+ * @param AB_cycle_set_pool ABサイクルの集まりのプール
+ * @param stamped_array_of_tsp_size_pool TSPの都市数と同じサイズの世代付き配列のプール
  * @param doubly_linked_list_pool TSPの都市数と同じサイズの双方向リストプール
  * @param LRIS_pool 0 ~ (TSPの都市数 - 1)の整数を管理する集合のプール
- * @return ABサイクルのポインタのベクター
+ * @return 見つけたABサイクルの集まり
  */
-std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
+ABCycleSetPtr find_AB_cycles(size_t needs,
             const doubly_linked_list_readable auto& parent1,
             const doubly_linked_list_readable auto& parent2,
             std::mt19937& rng,
             mpi::ObjectPool<std::vector<size_t>>& any_size_vector_pool,
-            mpi::ObjectPool<std::vector<size_t>>& vector_of_tsp_size_pool,
-            mpi::ObjectPool<std::vector<std::array<size_t, 2>>>& doubly_linked_list_pool,
+            mpi::ObjectPool<ABCycleSet>& AB_cycle_set_pool,
+            mpi::ObjectPool<mpi::EpochStampedArray<size_t>>& stamped_array_of_tsp_size_pool,
+            mpi::ObjectPool<doubly_linked_list_t>& doubly_linked_list_pool,
             mpi::ObjectPool<mpi::LimitedRangeIntegerSet>& LRIS_pool)
 {
     using namespace std;
@@ -93,7 +108,7 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
     struct connections {
         // edge_pair[0]が least recently used edge
         // edge_pair[1]が最近通ったエッジ or すでにABサイクルを構成しているエッジ
-        std::array<size_t, 2>& edge_pair;
+        std::array<city_index_t, 2>& edge_pair;
         constexpr size_t least_recently_used_edge() const {
             return edge_pair[0];
         }
@@ -120,8 +135,8 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
 
     auto parent1_copy_ptr = doubly_linked_list_pool.acquire_unique();
     auto parent2_copy_ptr = doubly_linked_list_pool.acquire_unique();
-    std::vector<std::array<size_t, 2>>& parent1_copy = *parent1_copy_ptr;
-    std::vector<std::array<size_t, 2>>& parent2_copy = *parent2_copy_ptr;
+    doubly_linked_list_t& parent1_copy = *parent1_copy_ptr;
+    doubly_linked_list_t& parent2_copy = *parent2_copy_ptr;
     for (size_t i = 0; i < city_count; ++i) {
         parent1_copy[i][0] = parent1[i][0];
         parent1_copy[i][1] = parent1[i][1];
@@ -130,7 +145,7 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
     }
     
     struct parent {
-        std::vector<std::array<size_t, 2>>& parent;
+        doubly_linked_list_t& parent;
         constexpr connections operator[](size_t index) {
             return connections{parent[index]};
         }
@@ -144,16 +159,18 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
         }
     } parents = {{parent1_copy}, {parent2_copy}};
 
-    vector<mpi::pooled_unique_ptr<ab_cycle_t>> AB_cycles;
+    auto AB_cycles_ptr = AB_cycle_set_pool.acquire_unique();
+    ABCycleSet& AB_cycles = *AB_cycles_ptr;
+    AB_cycles.clear();
 
     uniform_int_distribution<size_t> dist_01(0, 1);
     
     auto visited_ptr = any_size_vector_pool.acquire_unique();
-    auto first_visited_ptr = vector_of_tsp_size_pool.acquire_unique();
+    auto first_visited_ptr = stamped_array_of_tsp_size_pool.acquire_unique();
     std::vector<size_t>& visited = *visited_ptr;
-    std::vector<size_t>& first_visited = *first_visited_ptr;
+    mpi::EpochStampedArray<size_t>& first_visited = *first_visited_ptr;
     visited.clear();
-    first_visited.assign(city_count, 0);
+    first_visited.reset(city_count, 0);
     
     // numeric_limits<size_t>::max() は、 cities_having_2_edges と
     // cities_having_just_1_edge のどちらにも含まれないので、
@@ -202,10 +219,8 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
                 // エッジの数が1なら、探索途中か、スタートにたどり着いて一周したか
                 if (current_city == visited.front()) { // スタートにたどり着いたなら
                     // ABサイクル構成処理
-                    auto cycle = create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, any_size_vector_pool);
-                    if (cycle->size() > 2) {
-                        AB_cycles.emplace_back(std::move(cycle));
-                    }
+                    create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+                    close_AB_cycle_if_effective(AB_cycles);
                     break;
                 } else {
                     continue; // 探索途中なら、次の都市へ
@@ -217,20 +232,16 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
                 if (current_city == visited.front()) { // スタートにたどりついたなら
                     if ((visited.size() + 1) % 2 == 0) { // 親Bのエッジでスタートして、親Aのエッジで戻ってきた
                         // ABサイクル構成処理
-                        auto cycle = create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, any_size_vector_pool);
-                        if (cycle->size() > 2) {
-                            AB_cycles.emplace_back(std::move(cycle));
-                        }
+                        create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+                        close_AB_cycle_if_effective(AB_cycles);
                         break;
                     } else { // 親Bのエッジでスタートして、親Bのエッジで帰ってきた
                         continue;
                     }
                 } else if (first_visited[current_city] != 0 && (visited.size() - first_visited[current_city] + 1) % 2 == 0) {
                     // 交差している　かつ　ABサイクルを構成するなら
-                    auto cycle = create_AB_cycle(visited, first_visited[current_city], cities_having_2_edges, cities_having_just_1_edge, any_size_vector_pool);
-                    if (cycle->size() > 2) {
-                        AB_cycles.emplace_back(std::move(cycle));
-                    }
+                    create_AB_cycle(visited, first_visited[current_city], cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+                    close_AB_cycle_if_effective(AB_cycles);
                     break;
                 } else if (first_visited[current_city] != 0) { // 交差しているが、ABサイクルを構成しないなら
                     continue;
@@ -242,7 +253,7 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
         }
         
         if (AB_cycles.size() >= needs) {
-            return AB_cycles; // 必要な数のABサイクルが見つかった
+            return AB_cycles_ptr; // 必要な数のABサイクルが見つかった
         }
     }
 
@@ -264,17 +275,15 @@ std::vector<PooledVectorPtr> find_AB_cycles(size_t needs,
             current_city = next_city;
         }
         
-        auto cycle = create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, any_size_vector_pool);
-        if (cycle->size() > 2) {
-            AB_cycles.emplace_back(std::move(cycle));
-        }
+        create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+        close_AB_cycle_if_effective(AB_cycles);
         
         if (AB_cycles.size() >= needs) {
-            return AB_cycles; // 必要な数のABサイクルが見つかった
+            return AB_cycles_ptr; // 必要な数のABサイクルが見つかった
         }
     }
     
-    return AB_cycles;
+    return AB_cycles_ptr;
 }
 
 /**
@@ -284,17 +293,20 @@ class ABCycleFinder {
 public:
     ABCycleFinder(ObjectPools& object_pools)
         : any_size_vector_pool(object_pools.any_size_vector_pool.share()),
-          vector_of_tsp_size_pool(object_pools.vector_of_tsp_size_pool.share()),
+          AB_cycle_set_pool(object_pools.AB_cycle_set_pool.share()),
+          stamped_array_of_tsp_size_pool(object_pools.stamped_array_of_tsp_size_pool.share()),
           doubly_linked_list_pool(object_pools.doubly_linked_list_pool.share()),
           LRIS_pool(object_pools.LRIS_pool.share()) {}
 
     ABCycleFinder(
         mpi::ObjectPool<std::vector<size_t>> any_size_vector_pool,
-        mpi::ObjectPool<std::vector<size_t>> vector_of_tsp_size_pool,
-        mpi::ObjectPool<std::vector<std::array<size_t, 2>>> doubly_linked_list_pool,
+        mpi::ObjectPool<ABCycleSet> AB_cycle_set_pool,
+        mpi::ObjectPool<mpi::EpochStampedArray<size_t>> stamped_array_of_tsp_size_pool,
+        mpi::ObjectPool<doubly_linked_list_t> doubly_linked_list_pool,
         mpi::ObjectPool<mpi::LimitedRangeIntegerSet> LRIS_pool)
         : any_size_vector_pool(std::move(any_size_vector_pool)),
-          vector_of_tsp_size_pool(std::move(vector_of_tsp_size_pool)),
+          AB_cycle_set_pool(std::move(AB_cycle_set_pool)),
+          stamped_array_of_tsp_size_pool(std::move(stamped_array_of_tsp_size_pool)),
           doubly_linked_list_pool(std::move(doubly_linked_list_pool)),
           LRIS_pool(std::move(LRIS_pool)) {}
 
@@ -304,23 +316,24 @@ public:
      * @param parent1 親個体1
      * @param parent2 親個体2
      * @param rng 乱数生成器
-     * @return ABサイクルのポインタのベクター
+     * @return 見つけたABサイクルの集まり
      * @tparam Individual 親個体の型
      */
     template <individual_readable Individual>
-    std::vector<PooledVectorPtr> operator()(size_t needs,
+    ABCycleSetPtr operator()(size_t needs,
             const Individual& parent1,
             const Individual& parent2,
             std::mt19937& rng)
     {
-        return find_AB_cycles(needs, parent1, parent2, rng, any_size_vector_pool, vector_of_tsp_size_pool, doubly_linked_list_pool, LRIS_pool);
+        return find_AB_cycles(needs, parent1, parent2, rng, any_size_vector_pool, AB_cycle_set_pool, stamped_array_of_tsp_size_pool, doubly_linked_list_pool, LRIS_pool);
     }
 
     using completeness_category = complete_ABCycleFinder_tag;
 private:
     mpi::ObjectPool<std::vector<size_t>> any_size_vector_pool;
-    mpi::ObjectPool<std::vector<size_t>> vector_of_tsp_size_pool;
-    mpi::ObjectPool<std::vector<std::array<size_t, 2>>> doubly_linked_list_pool;
+    mpi::ObjectPool<ABCycleSet> AB_cycle_set_pool;
+    mpi::ObjectPool<mpi::EpochStampedArray<size_t>> stamped_array_of_tsp_size_pool;
+    mpi::ObjectPool<doubly_linked_list_t> doubly_linked_list_pool;
     mpi::ObjectPool<mpi::LimitedRangeIntegerSet> LRIS_pool;
 };
 }
\ No newline at end of file
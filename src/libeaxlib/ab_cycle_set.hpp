@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#include "indexed_const_iterator.hpp"
+
+#include "eaxdef.hpp"
+
+namespace eax {
+
+/**
+ * @brief ABサイクルの集まりを、1本の頂点配列と各ABサイクルの開始位置の配列 (CSR形式) で保持するクラス
+ * @details
+ *  i 番目のABサイクルは vertices[offsets[i]] から vertices[offsets[i + 1]] の手前までで、ab_cycle_view_t として参照する。
+ *  clear() は領域を解放しないので、オブジェクトプールから取り出して交叉ごとに使い回せば、
+ *  ABサイクルの抽出で新たな確保は起こらない。
+ *  ABサイクルは末尾に1つずつ構築する。push_vertex() で頂点を追加し、close_cycle() で確定するか、
+ *  discard_open_cycle() で破棄する。
+ */
+class ABCycleSet {
+public:
+    /**
+     * @brief ABサイクルを先頭から順にたどるランダムアクセスイテレータ
+     */
+    using const_iterator = mpi::indexed_const_iterator<ABCycleSet, ab_cycle_view_t>;
+    using iterator = const_iterator;
+
+    ABCycleSet() : offsets{0} {}
+
+    /**
+     * @brief すべてのABサイクルを取り除く (領域は保持する)
+     */
+    void clear() {
+        vertices.clear();
+        offsets.resize(1);
+    }
+
+    /**
+     * @brief 確定したABサイクルの数を返す
+     */
+    size_t size() const {
+        return offsets.size() - 1;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief i 番目のABサイクルを返す
+     * @param i ABサイクルのインデックス
+     * @return ABサイクルの頂点列 (次にABサイクルを追加するまで有効)
+     */
+    ab_cycle_view_t operator[](size_t i) const {
+        return ab_cycle_view_t(vertices.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, size());
+    }
+
+    /**
+     * @brief 構築中のABサイクルの末尾に頂点を追加する
+     * @param vertex 追加する頂点
+     */
+    void push_vertex(size_t vertex) {
+        vertices.push_back(static_cast<city_index_t>(vertex));
+    }
+
+    /**
+     * @brief 構築中のABサイクルの頂点列を返す
+     */
+    ab_cycle_view_t open_cycle() const {
+        return ab_cycle_view_t(vertices.data() + offsets.back(), vertices.size() - offsets.back());
+    }
+
+    /**
+     * @brief 構築中のABサイクルを確定する
+     */
+    void close_cycle() {
+        offsets.push_back(vertices.size());
+    }
+
+    /**
+     * @brief 構築中のABサイクルを破棄する
+     */
+    void discard_open_cycle() {
+        vertices.resize(offsets.back());
+    }
+
+    /**
+     * @brief ABサイクルを並べ替える
+     * @details ABサイクルのインデックスを std::sort で並べ替えてから頂点配列を詰め直す。
+     *  比較の結果が同じなら、ABサイクルへのポインタのベクターを std::sort した場合と同じ順序になる。
+     * @param comp ab_cycle_view_t どうしの比較関数
+     */
+    template <typename Compare>
+    void sort(Compare comp) {
+        order.resize(size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [this, &comp](size_t a, size_t b) {
+            return comp((*this)[a], (*this)[b]);
+        });
+
+        sorted_vertices.clear();
+        sorted_offsets.assign(1, 0);
+        for (size_t i : order) {
+            const ab_cycle_view_t cycle = (*this)[i];
+            sorted_vertices.insert(sorted_vertices.end(), cycle.begin(), cycle.end());
+            sorted_offsets.push_back(sorted_vertices.size());
+        }
+        vertices.swap(sorted_vertices);
+        offsets.swap(sorted_offsets);
+    }
+
+private:
+    std::vector<city_index_t> vertices;
+    /**
+     * @brief 各ABサイクルの開始位置 (offsets[0] = 0、末尾は確定済みの頂点数)
+     */
+    std::vector<size_t> offsets;
+
+    // sort() の作業領域
+    std::vector<size_t> order;
+    std::vector<city_index_t> sorted_vertices;
+    std::vector<size_t> sorted_offsets;
+};
+}
\ No newline at end of file
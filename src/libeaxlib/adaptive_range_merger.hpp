@@ -22,10 +22,11 @@ public:
           subtour_finder(object_pools),
           default_merger(object_pools) {}
 
-    template <std::ranges::range ABCycles, typename Policy>
-        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, const ab_cycle_t&>
+    template <tsp::distance_matrix_like Distance, std::ranges::range ABCycles, typename Policy>
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, ab_cycle_view_t>
     void operator()(IntermediateIndividual& working_individual,
                     const tsp::TSP& tsp,
+                    const Distance& adjacency_matrix,
                     const ABCycles& applied_ab_cycles,
                     const EdgeCounter<Policy>& edge_counter,
                     const std::size_t average_neighbor_range) {
@@ -34,7 +35,6 @@ public:
             throw std::invalid_argument("average_neighbor_range must be greater than 0");
         }
 
-        auto& adjacency_matrix = tsp.adjacency_matrix;
         auto& NN_list = tsp.NN_list;
         auto& path = working_individual.get_path();
         auto& pos = working_individual.get_pos();
@@ -43,7 +43,7 @@ public:
         SubtourList& subtour_list = *subtour_list_ptr;
 
         using namespace std;
-        using distance_type = std::remove_cvref_t<decltype(adjacency_matrix)>::value_type::value_type;
+        using distance_type = int64_t;
         using edge = pair<size_t, size_t>;
 
         auto elem_of_min_sub_tour_ptr = any_size_vector_pool.acquire_unique();
@@ -56,7 +56,7 @@ public:
         
         if (average_unique_edge_count <= 2.0) {
             // average_unique_edge_count が 2.0 以下の場合、デフォルトのマージャーに委譲する
-            default_merger(working_individual, tsp, applied_ab_cycles);
+            default_merger(working_individual, tsp, adjacency_matrix, applied_ab_cycles);
             return;
         }
 
@@ -88,7 +88,37 @@ public:
             edge e2 = {0, 0};
             distance_type min_cost = std::numeric_limits<distance_type>::max();
 
+            // 部分巡回路のi番目の都市と近傍都市をつなぎ替えるコストを評価する
+            auto evaluate = [&](size_t i, size_t neighbor_city, distance_type current_to_neighbor) {
+                size_t current_city = elem_of_min_sub_tour[i];
+                for (size_t k = 0; k < 2; ++k) {
+                    size_t connected_to_current_city = elem_of_min_sub_tour[i - 1 + 2 * k];
+                    const distance_type current_edge = adjacency_matrix[current_city][connected_to_current_city];
+                    for (size_t l = 0; l < 2; ++l) {
+                        size_t connected_to_neighbor_city = working_individual[neighbor_city][l];
+                        const distance_type removed = current_edge + adjacency_matrix[neighbor_city][connected_to_neighbor_city];
+
+                        distance_type cost = - removed + current_to_neighbor + adjacency_matrix[connected_to_current_city][connected_to_neighbor_city];
+                        
+                        if (cost < min_cost) {
+                            min_cost = cost;
+                            e1 = {current_city, connected_to_current_city};
+                            e2 = {neighbor_city, connected_to_neighbor_city};
+                        }
+                        
+                        cost = - removed + adjacency_matrix[current_city][connected_to_neighbor_city] + adjacency_matrix[connected_to_current_city][neighbor_city];
+
+                        if (cost < min_cost) {
+                            min_cost = cost;
+                            e1 = {current_city, connected_to_current_city};
+                            e2 = {connected_to_neighbor_city, neighbor_city};
+                        }
+                    }
+                }
+            };
+
             while (e1.first == 0 && e2.first == 0) {
+                bool exhausted = true;
                 for (size_t i = 1; i <= min_sub_tour_size; ++i) {
                     size_t current_city = elem_of_min_sub_tour[i];
 
@@ -104,38 +134,29 @@ public:
                     size_t start = start_coefficient * range_multiplier;
                     size_t end = end_coefficient * range_multiplier;
 
-                    size_t limit = std::min(end, NN_list[current_city].size());
+                    const auto neighbors = NN_list[current_city];
+                    size_t limit = std::min(end, neighbors.size());
+                    if (start < neighbors.size()) {
+                        exhausted = false;
+                    }
 
                     for (size_t j = start; j < limit; ++j) {
-                        size_t neighbor_city = NN_list[current_city][j];
+                        size_t neighbor_city = neighbors[j];
                         if (in_min_sub_tour[neighbor_city])
                             continue;
 
-                        for (size_t k = 0; k < 2; ++k) {
-                            size_t connected_to_current_city = elem_of_min_sub_tour[i - 1 + 2 * k];
-                            for (size_t l = 0; l < 2; ++l) {
-                                size_t connected_to_neighbor_city = working_individual[neighbor_city][l];
-
-                                distance_type cost = - adjacency_matrix[current_city][connected_to_current_city] - adjacency_matrix[neighbor_city][connected_to_neighbor_city]
-                                                    + adjacency_matrix[current_city][neighbor_city] + adjacency_matrix[connected_to_current_city][connected_to_neighbor_city];
-                                
-                                if (cost < min_cost) {
-                                    min_cost = cost;
-                                    e1 = {current_city, connected_to_current_city};
-                                    e2 = {neighbor_city, connected_to_neighbor_city};
-                                }
-                                
-                                cost = - adjacency_matrix[current_city][connected_to_current_city] - adjacency_matrix[neighbor_city][connected_to_neighbor_city]
-                                    + adjacency_matrix[current_city][connected_to_neighbor_city] + adjacency_matrix[connected_to_current_city][neighbor_city];
-
-                                if (cost < min_cost) {
-                                    min_cost = cost;
-                                    e1 = {current_city, connected_to_current_city};
-                                    e2 = {connected_to_neighbor_city, neighbor_city};
-                                }
-                            }
-                        }
+                        evaluate(i, neighbor_city, neighbors.distance(j));
+                    }
+                }
+
+                if (exhausted) {
+                    // 近傍リストを使い切った場合は、部分巡回路外の最も近い都市を探索する
+                    for (size_t i = 1; i <= min_sub_tour_size; ++i) {
+                        size_t current_city = elem_of_min_sub_tour[i];
+                        size_t neighbor_city = tsp.nearest_outside(current_city, in_min_sub_tour);
+                        evaluate(i, neighbor_city, adjacency_matrix[current_city][neighbor_city]);
                     }
+                    break;
                 }
                 
                 start_coefficient = end_coefficient;
@@ -0,0 +1,338 @@
+#include "alpha_nearness.hpp"
+#include "parallel_for.hpp"
+#include "disjoint_set.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <limits>
+#include <functional>
+
+namespace tsp {
+    namespace {
+        /**
+         * @brief 劣勾配法で1-treeを構築する疎な無向グラフ (CSR形式)
+         */
+        struct SparseGraph {
+            struct Edge {
+                size_t to;
+                int64_t distance;
+            };
+            std::vector<size_t> offsets;
+            std::vector<Edge> edges;
+
+            size_t size() const {
+                return offsets.empty() ? 0 : offsets.size() - 1;
+            }
+        };
+
+        struct WeightedEdge {
+            size_t i;
+            size_t j;
+            int64_t distance;
+        };
+
+        /**
+         * @brief 近傍リストの先頭 neighbor_count 都市への辺からなるグラフを構築する
+         * @details
+         *  クラスタ化されたインスタンスでは近傍の辺だけではグラフが連結にならないことがあるので、
+         *  各連結成分からその外への最短の辺を追加する操作 (Borůvka法) を連結になるまで繰り返す。
+         */
+        SparseGraph build_ascent_graph(const TSP& tsp, size_t neighbor_count) {
+            const size_t n = tsp.city_count;
+            const size_t width = std::min(neighbor_count, tsp.NN_list.width());
+            const DistanceView distance = tsp.distance();
+
+            std::vector<WeightedEdge> edge_list;
+            edge_list.reserve(n * width);
+            mpi::DisjointSet components(n);
+            size_t component_count = n;
+            for (size_t i = 0; i < n; ++i) {
+                const auto neighbors = tsp.NN_list[i];
+                for (size_t k = 0; k < width; ++k) {
+                    size_t j = neighbors[k];
+                    edge_list.push_back({std::min(i, j), std::max(i, j), neighbors.distance(k)});
+                    if (components.unite(i, j)) {
+                        --component_count;
+                    }
+                }
+            }
+
+            std::vector<uint8_t> excluded(n, false);
+            std::vector<size_t> cities(n);
+            std::vector<size_t> roots(n);
+            while (component_count > 1) {
+                // 連結成分ごとに都市をまとめる
+                for (size_t i = 0; i < n; ++i) {
+                    roots[i] = components.find(i);
+                }
+                std::iota(cities.begin(), cities.end(), 0);
+                std::sort(cities.begin(), cities.end(), [&roots](size_t a, size_t b) {
+                    return roots[a] < roots[b];
+                });
+
+                std::vector<WeightedEdge> bridges;
+                for (size_t begin = 0; begin < n;) {
+                    size_t end = begin;
+                    while (end < n && roots[cities[end]] == roots[cities[begin]]) {
+                        excluded[cities[end++]] = true;
+                    }
+                    WeightedEdge best{0, 0, std::numeric_limits<int64_t>::max()};
+                    for (size_t k = begin; k < end; ++k) {
+                        size_t city = cities[k];
+                        size_t outside = tsp.nearest_outside(city, excluded);
+                        int64_t d = distance(city, outside);
+                        if (d < best.distance) {
+                            best = {std::min(city, outside), std::max(city, outside), d};
+                        }
+                    }
+                    for (size_t k = begin; k < end; ++k) {
+                        excluded[cities[k]] = false;
+                    }
+                    bridges.push_back(best);
+                    begin = end;
+                }
+                for (const WeightedEdge& edge : bridges) {
+                    if (components.unite(edge.i, edge.j)) {
+                        --component_count;
+                        edge_list.push_back(edge);
+                    }
+                }
+            }
+
+            std::sort(edge_list.begin(), edge_list.end(), [](const WeightedEdge& a, const WeightedEdge& b) {
+                return a.i != b.i ? a.i < b.i : a.j < b.j;
+            });
+            edge_list.erase(std::unique(edge_list.begin(), edge_list.end(), [](const WeightedEdge& a, const WeightedEdge& b) {
+                return a.i == b.i && a.j == b.j;
+            }), edge_list.end());
+
+            SparseGraph graph;
+            graph.offsets.assign(n + 1, 0);
+            for (const WeightedEdge& edge : edge_list) {
+                ++graph.offsets[edge.i + 1];
+                ++graph.offsets[edge.j + 1];
+            }
+            std::partial_sum(graph.offsets.begin(), graph.offsets.end(), graph.offsets.begin());
+            graph.edges.resize(graph.offsets[n]);
+            std::vector<size_t> fill(graph.offsets.begin(), graph.offsets.end() - 1);
+            for (const WeightedEdge& edge : edge_list) {
+                graph.edges[fill[edge.i]++] = {edge.j, edge.distance};
+                graph.edges[fill[edge.j]++] = {edge.i, edge.distance};
+            }
+            return graph;
+        }
+
+        /**
+         * @brief 疎なグラフ上で変換後の距離 d * PRECISION + pi[i] + pi[j] による最小1-treeを構築する
+         * @details
+         *  都市0を根とする最小全域木をPrim法で構築し、葉のうち木に含まれない最短の辺が最も長いものについてその辺を加える。
+         * @return 1-treeの長さ - 2 * sum(pi) (Held-Karp の下界を PRECISION 倍した値)
+         */
+        int64_t minimum_one_tree(const SparseGraph& graph, const std::vector<int64_t>& pi,
+                                 std::vector<size_t>& parent, std::vector<int64_t>& parent_cost,
+                                 std::vector<size_t>& order, std::vector<int64_t>& degree) {
+            constexpr int64_t PRECISION = AlphaNearness::PRECISION;
+            const size_t n = graph.size();
+            std::vector<int64_t> key(n, std::numeric_limits<int64_t>::max());
+            std::vector<uint8_t> in_tree(n, false);
+            parent.assign(n, 0);
+            parent_cost.assign(n, 0);
+            degree.assign(n, 0);
+            order.clear();
+
+            using HeapEntry = std::pair<int64_t, size_t>;
+            std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+            int64_t total = 0;
+            key[0] = 0;
+            heap.push({0, 0});
+            while (!heap.empty()) {
+                auto [cost, city] = heap.top();
+                heap.pop();
+                if (in_tree[city] || cost != key[city]) {
+                    continue;
+                }
+                in_tree[city] = true;
+                order.push_back(city);
+                if (city != 0) {
+                    total += cost;
+                    parent_cost[city] = cost;
+                    ++degree[city];
+                    ++degree[parent[city]];
+                }
+                for (size_t e = graph.offsets[city]; e < graph.offsets[city + 1]; ++e) {
+                    const auto& edge = graph.edges[e];
+                    if (in_tree[edge.to]) {
+                        continue;
+                    }
+                    int64_t c = edge.distance * PRECISION + pi[city] + pi[edge.to];
+                    if (c < key[edge.to]) {
+                        key[edge.to] = c;
+                        parent[edge.to] = city;
+                        heap.push({c, edge.to});
+                    }
+                }
+            }
+
+            // 1-treeにする辺を加える
+            size_t special = n;
+            size_t special_to = n;
+            int64_t special_cost = std::numeric_limits<int64_t>::min();
+            for (size_t city = 1; city < n; ++city) {
+                if (degree[city] != 1) {
+                    continue;
+                }
+                size_t best_to = n;
+                int64_t best_cost = std::numeric_limits<int64_t>::max();
+                for (size_t e = graph.offsets[city]; e < graph.offsets[city + 1]; ++e) {
+                    const auto& edge = graph.edges[e];
+                    if (edge.to == parent[city]) {
+                        continue;
+                    }
+                    int64_t c = edge.distance * PRECISION + pi[city] + pi[edge.to];
+                    if (c < best_cost) {
+                        best_cost = c;
+                        best_to = edge.to;
+                    }
+                }
+                if (best_to != n && best_cost > special_cost) {
+                    special = city;
+                    special_to = best_to;
+                    special_cost = best_cost;
+                }
+            }
+            if (special != n) {
+                total += special_cost;
+                ++degree[special];
+                ++degree[special_to];
+            }
+
+            return total - 2 * std::accumulate(pi.begin(), pi.end(), int64_t{0});
+        }
+    }
+
+    AlphaNearness::AlphaNearness(const TSP& tsp, const AlphaNearnessOptions& options)
+        : tsp(&tsp), options(options), pi(tsp.city_count, 0) {
+        const size_t n = tsp.city_count;
+        if (n < 3) {
+            parent.assign(n, 0);
+            parent_cost.assign(n, 0);
+            order.resize(n);
+            std::iota(order.begin(), order.end(), 0);
+            for (size_t i = 1; i < n; ++i) {
+                parent_cost[i] = tsp.distance()(0, i) * PRECISION;
+            }
+            return;
+        }
+
+        const SparseGraph graph = build_ascent_graph(tsp, options.ascent_neighbor_count);
+        std::vector<int64_t> degree;
+        std::vector<int64_t> last_direction(n, 0);
+
+        auto norm_of = [&degree]() {
+            int64_t norm = 0;
+            for (int64_t d : degree) {
+                norm += (d - 2) * (d - 2);
+            }
+            return norm;
+        };
+
+        // LKHと同様の劣勾配法: 下界が改善する間は最初の周期でステップ幅を倍にし、周期ごとにステップ幅と周期を半分にする
+        best_bound = minimum_one_tree(graph, pi, parent, parent_cost, order, degree);
+        std::vector<int64_t> best_pi = pi;
+        int64_t norm = norm_of();
+        const size_t initial_period = options.initial_period != 0 ? options.initial_period : std::max<size_t>(n / 2, 100);
+        bool initial_phase = true;
+        size_t iterations = 0;
+        for (size_t period = initial_period, step = PRECISION;
+             period > 0 && step > 0 && norm != 0 && iterations < options.max_iterations;
+             period /= 2, step /= 2) {
+            for (size_t p = 1; step > 0 && p <= period && norm != 0 && iterations < options.max_iterations; ++p, ++iterations) {
+                for (size_t city = 0; city < n; ++city) {
+                    int64_t direction = degree[city] - 2;
+                    if (direction != 0) {
+                        pi[city] += static_cast<int64_t>(step) * (7 * direction + 3 * last_direction[city]) / 10;
+                    }
+                    last_direction[city] = direction;
+                }
+                int64_t bound = minimum_one_tree(graph, pi, parent, parent_cost, order, degree);
+                norm = norm_of();
+                if (bound > best_bound) {
+                    best_bound = bound;
+                    best_pi = pi;
+                    if (initial_phase) {
+                        step *= 2;
+                    }
+                    if (p == period) {
+                        period = std::min(period * 2, initial_period);
+                    }
+                } else if (initial_phase && p > period / 2) {
+                    initial_phase = false;
+                    p = 0;
+                    step = 3 * step / 4;
+                }
+            }
+        }
+
+        pi = std::move(best_pi);
+        minimum_one_tree(graph, pi, parent, parent_cost, order, degree);
+    }
+
+    NeighborList AlphaNearness::candidates(size_t candidate_count) const {
+        const size_t n = tsp->city_count;
+        const size_t width = n == 0 ? 0 : std::min(candidate_count, n - 1);
+        const DistanceView distance = tsp->distance();
+        const size_t root = order.empty() ? 0 : order.front();
+
+        struct Candidate {
+            int64_t alpha;
+            int64_t cost;
+            size_t city;
+            int64_t distance;
+        };
+
+        NeighborList list(n, width);
+        mpi::parallel_for(0, n, [&](size_t i) {
+            // beta[j] = 最小全域木上の都市iから都市jへのパスで最も長い辺の長さ
+            thread_local std::vector<int64_t> beta;
+            thread_local std::vector<size_t> mark;
+            thread_local std::vector<Candidate> row;
+            beta.resize(n);
+            mark.assign(n, n);
+
+            beta[i] = std::numeric_limits<int64_t>::min();
+            mark[i] = i;
+            for (size_t city = i; city != root; city = parent[city]) {
+                beta[parent[city]] = std::max(beta[city], parent_cost[city]);
+                mark[parent[city]] = i;
+            }
+            // 親が先に現れる順序なので、根への経路上にない都市は親の値から求まる
+            for (size_t city : order) {
+                if (mark[city] != i) {
+                    beta[city] = std::max(beta[parent[city]], parent_cost[city]);
+                }
+            }
+
+            row.clear();
+            for (size_t j = 0; j < n; ++j) {
+                if (j == i) {
+                    continue;
+                }
+                int64_t d = distance(i, j);
+                int64_t cost = d * PRECISION + pi[i] + pi[j];
+                row.push_back({cost - beta[j], cost, j, d});
+            }
+            std::partial_sort(row.begin(), row.begin() + width, row.end(), [](const Candidate& a, const Candidate& b) {
+                if (a.alpha != b.alpha) {
+                    return a.alpha < b.alpha;
+                }
+                return a.cost != b.cost ? a.cost < b.cost : a.city < b.city;
+            });
+            NeighborList::Entry* entries = list.row_data(i);
+            for (size_t k = 0; k < width; ++k) {
+                entries[k] = NeighborList::make_entry(row[k].city, row[k].distance);
+            }
+        }, options.thread_count);
+        return list;
+    }
+}
\ No newline at end of file
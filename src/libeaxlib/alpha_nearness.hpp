@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "tsp_loader.hpp"
+
+namespace tsp {
+    /**
+     * @brief alpha-nearness の計算のパラメータ
+     */
+    struct AlphaNearnessOptions {
+        /**
+         * @brief 劣勾配法で1-treeを構築する疎なグラフに使う、1都市あたりの幾何的な近傍都市の数
+         */
+        size_t ascent_neighbor_count = 10;
+        /**
+         * @brief 劣勾配法の最初の周期の反復回数 (0の場合は都市数の半分、ただし100以上)
+         */
+        size_t initial_period = 0;
+        /**
+         * @brief 劣勾配法の反復回数の上限
+         */
+        size_t max_iterations = 10000;
+        /**
+         * @brief alpha値の計算に使うスレッド数 (0の場合はハードウェアのスレッド数)
+         */
+        size_t thread_count = 0;
+    };
+
+    /**
+     * @brief 1-treeの劣勾配法で求めたポテンシャルに基づく alpha-nearness
+     * @details
+     *  Held-Karp の下界を最大化するように、各都市のポテンシャル pi を1-treeの劣勾配法で求める。
+     *  都市対 (i, j) の alpha 値は、変換後の距離 d(i, j) + pi[i] + pi[j] で最小1-treeに辺 (i, j) を
+     *  強制的に含めたときの木の長さの増分である。最適巡回路の辺は alpha 値が小さい傾向があるため、
+     *  alpha 値の小さい順に並べた候補都市は、距離の近い順に比べて少ない数で良い辺を含む。
+     *  劣勾配法の各反復では、近傍リストの先頭の都市と連結性を保つための辺だけからなる疎なグラフで1-treeを構築する。
+     */
+    class AlphaNearness {
+    public:
+        /**
+         * @brief 劣勾配法でポテンシャルを求め、最終的な最小全域木を構築する
+         * @param tsp TSPのインスタンス (幾何的な近傍リストを持つこと)
+         * @param options パラメータ
+         */
+        explicit AlphaNearness(const TSP& tsp, const AlphaNearnessOptions& options = {});
+
+        /**
+         * @brief 各都市について alpha 値の小さい順に候補都市を並べた近傍リストを構築する O(N^2)
+         * @details
+         *  alpha 値が等しい場合は距離の近い順に並べる。各要素の距離は元の距離 d(i, j) を保持するので、
+         *  距離の近い順に並んだ近傍リストの代わりにそのまま使用できる。
+         * @param candidate_count 1都市あたりの候補都市の数
+         * @return 候補都市の近傍リスト
+         */
+        NeighborList candidates(size_t candidate_count) const;
+
+        /**
+         * @brief 劣勾配法で得られた Held-Karp の下界
+         * @details 1-treeを疎なグラフ上で構築するため、完全グラフでの厳密な下界よりわずかに大きくなることがある
+         */
+        double lower_bound() const {
+            return static_cast<double>(best_bound) / PRECISION;
+        }
+
+        /**
+         * @brief 各都市のポテンシャル (距離を PRECISION 倍した単位)
+         */
+        const std::vector<int64_t>& potentials() const {
+            return pi;
+        }
+
+        /**
+         * @brief ポテンシャルを整数で扱うための距離の倍率
+         */
+        static constexpr int64_t PRECISION = 100;
+
+    private:
+        const TSP* tsp;
+        AlphaNearnessOptions options;
+        std::vector<int64_t> pi;
+        int64_t best_bound = 0;
+        /**
+         * @brief 最終的な最小全域木での親 (根は自身)
+         */
+        std::vector<size_t> parent;
+        /**
+         * @brief 最終的な最小全域木での親との辺の変換後の距離
+         */
+        std::vector<int64_t> parent_cost;
+        /**
+         * @brief 最終的な最小全域木に都市を追加した順序 (親は子より先に現れる)
+         */
+        std::vector<size_t> order;
+    };
+}
\ No newline at end of file
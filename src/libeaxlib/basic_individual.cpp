@@ -1,7 +1,9 @@
 #include "basic_individual.hpp"
 
+#include "content_hash.hpp"
+
 namespace eax {
-BasicIndividual::BasicIndividual(const std::vector<size_t>& path, const adjacency_matrix_t& adjacency_matrix)
+BasicIndividual::BasicIndividual(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix)
     : doubly_linked_list(path.size()) {
     
     size_t city_count = path.size();
@@ -10,7 +12,7 @@ BasicIndividual::BasicIndividual(const std::vector<size_t>& path, const adjacenc
         size_t prev_city = path[i - 1];
         size_t next_city = path[i + 1];
 
-        doubly_linked_list[current_city] = {prev_city, next_city};
+        doubly_linked_list[current_city] = {static_cast<city_index_t>(prev_city), static_cast<city_index_t>(next_city)};
         
         distance += adjacency_matrix[current_city][prev_city];
     }
@@ -19,12 +21,33 @@ BasicIndividual::BasicIndividual(const std::vector<size_t>& path, const adjacenc
     size_t first_city = path[0];
     size_t second_city = path[1];
     size_t last_city = path[city_count - 1];
-    doubly_linked_list[first_city] = {last_city, second_city};
+    doubly_linked_list[first_city] = {static_cast<city_index_t>(last_city), static_cast<city_index_t>(second_city)};
     distance += adjacency_matrix[first_city][last_city];
 
     // 最後の都市
     size_t penultimate_city = path[city_count - 2];
-    doubly_linked_list[last_city] = {penultimate_city, first_city};
+    doubly_linked_list[last_city] = {static_cast<city_index_t>(penultimate_city), static_cast<city_index_t>(first_city)};
     distance += adjacency_matrix[last_city][penultimate_city];
+
+    set_content_hash(calc_content_hash(doubly_linked_list));
+}
+
+TourOrderPtr BasicIndividual::get_tour_order() const {
+    if (tour_order_is_stale) {
+        if (!tour_order || tour_order.use_count() > 1) {
+            tour_order = std::make_shared<TourOrder>();
+        }
+        tour_order->assign(doubly_linked_list);
+        tour_order_is_stale = false;
+    }
+    return tour_order;
+}
+
+uint64_t BasicIndividual::get_content_hash() const {
+    if (content_hash_is_stale) {
+        content_hash = calc_content_hash(doubly_linked_list);
+        content_hash_is_stale = false;
+    }
+    return content_hash;
 }
 }
\ No newline at end of file
@@ -10,13 +10,18 @@ namespace eax {
  */
 class BasicIndividual : public Checksumed {
 public:
-    BasicIndividual(const std::vector<size_t>& path, const adjacency_matrix_t& adjacency_matrix);
-
-    constexpr std::array<size_t, 2>& operator[](size_t index) {
+    BasicIndividual(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix);
+
+    /**
+     * @note 書き込み用の参照を返すので、保持している巡回路の順序と内容ハッシュは次に求められたときに計算し直す
+     */
+    constexpr std::array<city_index_t, 2>& operator[](size_t index) {
+        tour_order_is_stale = true;
+        content_hash_is_stale = true;
         return doubly_linked_list[index];
     }
 
-    constexpr std::array<size_t, 2> const& operator[](size_t index) const {
+    constexpr std::array<city_index_t, 2> const& operator[](size_t index) const {
         return doubly_linked_list[index];
     }
     
@@ -31,12 +36,50 @@ public:
     void set_distance(int64_t val) {
         distance = val;
     }
+
+    /**
+     * @brief 巡回路の内容ハッシュを取得する
+     * @details 隣接関係が set_content_hash() を通さずに変更されていれば、O(N) かけて計算し直す
+     * @return 内容ハッシュ (同じ巡回路なら同じ値)
+     */
+    uint64_t get_content_hash() const;
+
+    /**
+     * @brief 隣接関係の変更に合わせて更新した内容ハッシュを設定する
+     * @param val 現在の隣接関係の内容ハッシュ
+     */
+    void set_content_hash(uint64_t val) {
+        content_hash = val;
+        content_hash_is_stale = false;
+    }
+
+    /**
+     * @brief 巡回路の順序を取得する
+     * @details
+     *  隣接関係が変更されていなければ、前回構築した順序をそのまま返す。
+     *  変更後の最初の呼び出しで O(N) かけて構築し直すが、返した順序が他で使われている間は
+     *  その領域を書き換えず新しく確保するので、受け取った側は個体の変更後もそのまま使える。
+     * @return 巡回路の順序
+     */
+    TourOrderPtr get_tour_order() const;
 private:
     doubly_linked_list_t doubly_linked_list;
     int64_t distance = 0;
+    mutable std::shared_ptr<TourOrder> tour_order;
+    /**
+     * @brief tour_order が現在の隣接関係と一致していないかどうか
+     */
+    mutable bool tour_order_is_stale = true;
+    mutable uint64_t content_hash = 0;
+    /**
+     * @brief content_hash が現在の隣接関係と一致していないかどうか
+     */
+    mutable bool content_hash_is_stale = true;
 };
 
 static_assert(individual_writable<BasicIndividual>);
+static_assert(tour_order_readable<BasicIndividual>);
+static_assert(content_hash_writable<BasicIndividual>);
 
 /**
  * @brief BasicIndividualを内部に持つ読み取り専用個体クラスのミックスイン
@@ -46,7 +89,7 @@ static_assert(individual_writable<BasicIndividual>);
 template <typename T>
 class ReadableWithBasicIndividual {
 public:
-    constexpr std::array<size_t, 2> const& operator[](size_t index) const {
+    constexpr std::array<city_index_t, 2> const& operator[](size_t index) const {
         return individual[index];
     }
 
@@ -62,11 +105,19 @@ public:
         return individual.get_distance();
     }
 
+    TourOrderPtr get_tour_order() const {
+        return individual.get_tour_order();
+    }
+
+    uint64_t get_content_hash() const {
+        return individual.get_content_hash();
+    }
+
 private:
     friend T;
     BasicIndividual individual;
 
-    ReadableWithBasicIndividual(const std::vector<size_t>& path, const adjacency_matrix_t& adjacency_matrix)
+    ReadableWithBasicIndividual(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix)
         : individual(path, adjacency_matrix) {}
 
     ~ReadableWithBasicIndividual() = default;
@@ -85,7 +136,7 @@ template <typename T>
 class WritableWithBasicIndividual {
 public:
     // readable要件
-    constexpr std::array<size_t, 2> const& operator[](size_t index) const {
+    constexpr std::array<city_index_t, 2> const& operator[](size_t index) const {
         return individual[index];
     }
 
@@ -101,8 +152,16 @@ public:
         return individual.get_distance();
     }
 
+    TourOrderPtr get_tour_order() const {
+        return individual.get_tour_order();
+    }
+
+    uint64_t get_content_hash() const {
+        return individual.get_content_hash();
+    }
+
     // writable要件
-    std::array<size_t, 2>& operator[](size_t index) {
+    std::array<city_index_t, 2>& operator[](size_t index) {
         return individual[index];
     }
     
@@ -114,11 +173,15 @@ public:
         individual.set_distance(val);
     }
 
+    void set_content_hash(uint64_t val) {
+        individual.set_content_hash(val);
+    }
+
 private:
     friend T;
     BasicIndividual individual;
 
-    WritableWithBasicIndividual(const std::vector<size_t>& path, const adjacency_matrix_t& adjacency_matrix)
+    WritableWithBasicIndividual(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix)
         : individual(path, adjacency_matrix) {}
 
     ~WritableWithBasicIndividual() = default;
@@ -3,11 +3,14 @@
 #include <cstddef>
 #include <vector>
 #include <random>
+#include <algorithm>
 
 #include "object_pool.hpp"
+#include "epoch_stamped_array.hpp"
 
 #include "eaxdef.hpp"
 #include "object_pools.hpp"
+#include "ab_cycle_set.hpp"
 
 namespace eax {
 /**
@@ -51,6 +54,7 @@ class Block2ESetAssemblerBuilder {
 public:
     Block2ESetAssemblerBuilder(ObjectPools& object_pools)
         : vector_of_tsp_size_pool(object_pools.vector_of_tsp_size_pool.share()),
+          stamped_array_of_tsp_size_pool(object_pools.stamped_array_of_tsp_size_pool.share()),
           any_size_vector_pool(object_pools.any_size_vector_pool.share()),
           shared_vertex_count_pool(object_pools.any_size_2d_vector_pool.share()) {}
 
@@ -58,42 +62,47 @@ public:
      * @brief Block2ESetAssemblerを構築する
      * @param parent1 親個体1
      * @param parent2 親個体2
-     * @param AB_cycles ABサイクルのポインタのベクター
+     * @param AB_cycles ABサイクルの集まり
      * @return Block2ESetAssemblerのインスタンス
      */
     Block2ESetAssembler create(const individual_readable auto& parent1, const individual_readable auto& parent2,
-                               const std::vector<mpi::pooled_unique_ptr<ab_cycle_t>>& AB_cycles) {
+                               const ABCycleSet& AB_cycles) {
         using namespace std;
         
         size_t city_count = parent1.size();
         size_t cycle_count = AB_cycles.size();
 
-        auto belongs_to_AB_cycle1_ptr = vector_of_tsp_size_pool.acquire_unique();
-        auto belongs_to_AB_cycle2_ptr = vector_of_tsp_size_pool.acquire_unique();
-        vector<size_t>& belongs_to_AB_cycle1 = *belongs_to_AB_cycle1_ptr;
-        vector<size_t>& belongs_to_AB_cycle2 = *belongs_to_AB_cycle2_ptr;
+        // 世代付き配列なので、初期化はABサイクルの頂点数に比例する手間で済む
+        auto belongs_to_AB_cycle1_ptr = stamped_array_of_tsp_size_pool.acquire_unique();
+        auto belongs_to_AB_cycle2_ptr = stamped_array_of_tsp_size_pool.acquire_unique();
+        mpi::EpochStampedArray<size_t>& belongs_to_AB_cycle1 = *belongs_to_AB_cycle1_ptr;
+        mpi::EpochStampedArray<size_t>& belongs_to_AB_cycle2 = *belongs_to_AB_cycle2_ptr;
         
         const size_t NULL_CYCLE = std::numeric_limits<size_t>::max();
-        for (size_t i = 0; i < city_count; ++i) {
-            belongs_to_AB_cycle1[i] = NULL_CYCLE;
-            belongs_to_AB_cycle2[i] = NULL_CYCLE;
-        }
+        belongs_to_AB_cycle1.reset(city_count, NULL_CYCLE);
+        belongs_to_AB_cycle2.reset(city_count, NULL_CYCLE);
+
+        // いずれかのABサイクルに属することになった頂点 (重複なし)
+        auto touched_ptr = any_size_vector_pool.acquire_unique();
+        vector<size_t>& touched = *touched_ptr;
+        touched.clear();
 
         // 各ABサイクルのサイズを記録
         auto AB_cycle_size_ptr = any_size_vector_pool.acquire_unique();
         vector<size_t>& AB_cycle_size = *AB_cycle_size_ptr;
         AB_cycle_size.resize(cycle_count);
         for (size_t i = 0; i < cycle_count; ++i) {
-            const auto& cycle = *AB_cycles[i];
+            const ab_cycle_view_t cycle = AB_cycles[i];
             AB_cycle_size[i] = cycle.size();
         }
         
         // 各頂点が属するABサイクルを記録
         for (size_t i = 0; i < cycle_count; ++i) {
-            const auto& cycle = *AB_cycles[i];
+            const ab_cycle_view_t cycle = AB_cycles[i];
             for (auto city : cycle) {
                 if (belongs_to_AB_cycle1[city] == NULL_CYCLE) {
                     belongs_to_AB_cycle1[city] = i;
+                    touched.push_back(city);
                 } else if (belongs_to_AB_cycle2[city] == NULL_CYCLE) {
                     belongs_to_AB_cycle2[city] = i;
                 } else {
@@ -102,8 +111,20 @@ public:
             }
         }
         
+        // 一方のABサイクルにしか属さない頂点は無効ABサイクルの系列の端点なので、それだけを候補とする
+        // 統合の結果は端点を調べる順序に依存するので、都市番号の小さい順に調べる
+        auto chain_ends_ptr = any_size_vector_pool.acquire_unique();
+        vector<size_t>& chain_ends = *chain_ends_ptr;
+        chain_ends.clear();
+        for (size_t city : touched) {
+            if (belongs_to_AB_cycle2[city] == NULL_CYCLE) {
+                chain_ends.push_back(city);
+            }
+        }
+        std::sort(chain_ends.begin(), chain_ends.end());
+
         // 無効ABサイクルを隣接する有効ABサイクルと統合する
-        for (size_t i = 0; i < city_count; ++i) {
+        for (size_t i : chain_ends) {
             if (belongs_to_AB_cycle1[i] != NULL_CYCLE && belongs_to_AB_cycle2[i] == NULL_CYCLE) {
                 // AB_cyclesには、すべての有効ABサイクルが含まれているので、
                 // 一方しか記録されていないならば、もう一方は無効ABサイクルである
@@ -132,6 +153,7 @@ public:
                     
                     if (belongs_to_AB_cycle1[next_v1] == NULL_CYCLE) {
                         belongs_to_AB_cycle1[next_v1] = AB_cycle_index;
+                        touched.push_back(next_v1);
                     } else if (belongs_to_AB_cycle2[next_v1] == NULL_CYCLE) {
                         belongs_to_AB_cycle2[next_v1] = AB_cycle_index;
                         break; // 無効ABサイクルの系列の終端に到達した
@@ -157,8 +179,8 @@ public:
             shared_vertex_count[i].assign(cycle_count, 0);
         }
         
-        // C頂点の数と共有頂点の数をカウント
-        for (size_t i = 0; i < city_count; ++i) {
+        // C頂点の数と共有頂点の数をカウント (どのABサイクルにも属さない頂点は数えない)
+        for (size_t i : touched) {
             if (belongs_to_AB_cycle1[i] != belongs_to_AB_cycle2[i]) {
                 ++c_vertex_count[belongs_to_AB_cycle1[i]];
                 ++c_vertex_count[belongs_to_AB_cycle2[i]];
@@ -177,6 +199,7 @@ public:
     }
 private:
     mpi::ObjectPool<std::vector<size_t>> vector_of_tsp_size_pool;
+    mpi::ObjectPool<mpi::EpochStampedArray<size_t>> stamped_array_of_tsp_size_pool;
     mpi::ObjectPool<std::vector<size_t>> any_size_vector_pool;
     mpi::ObjectPool<std::vector<std::vector<size_t>>> shared_vertex_count_pool;
 };
@@ -9,7 +9,7 @@ class BufferedIndividual : public ReadableWithBasicIndividual<BufferedIndividual
 public:
     using delta_t = DeltaWithIndividual<BasicIndividual>;
 
-    BufferedIndividual(const std::vector<size_t>& path, const adjacency_matrix_t& adjacency_matrix)
+    BufferedIndividual(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix)
         : ReadableWithBasicIndividual<BufferedIndividual>(path, adjacency_matrix),
           buffered_individual(this->individual) {}
 
@@ -0,0 +1,65 @@
+#include "child_distance_lower_bound.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace eax {
+void ChildDistanceLowerBound::prepare(const tsp::TSP& tsp) {
+    if (prepared_tsp == &tsp) {
+        return;
+    }
+    prepared_tsp = &tsp;
+
+    const auto adjacency_matrix = tsp.distance();
+    const size_t n = tsp.city_count;
+    nearest_two_distance_sums.assign(n, 0);
+    if (n < 3) {
+        // 最も近い2都市が存在しない場合は 0 とする (余剰が大きくなるだけで下界は正しい)
+        return;
+    }
+
+    // 近傍リストは alpha 値の順に並ぶ場合があるので、最も近い2都市は近傍リスト外も含めて探す
+    std::vector<uint8_t> excluded(n, 0);
+    for (size_t city = 0; city < n; ++city) {
+        excluded[city] = 1;
+        const size_t first = tsp.nearest_outside(city, excluded);
+        excluded[first] = 1;
+        const size_t second = tsp.nearest_outside(city, excluded);
+        nearest_two_distance_sums[city] = adjacency_matrix[city][first] + adjacency_matrix[city][second];
+        excluded[city] = 0;
+        excluded[first] = 0;
+    }
+}
+
+void ChildDistanceLowerBound::select_largest_parent_slacks() {
+    tracked_slack_count = std::min(max_tracked_slacks, parent_slacks.size());
+    auto middle = parent_slacks.begin() + tracked_slack_count;
+    std::partial_sort(parent_slacks.begin(), middle, parent_slacks.end(), std::greater<>());
+}
+
+int64_t ChildDistanceLowerBound::sum_of_largest_slacks(size_t count, const mpi::EpochStampedArray<size_t>& in_E_set) {
+    // E-set 外の都市の余剰は親1と同じ
+    size_t taken = 0;
+    for (size_t i = 0; i < tracked_slack_count && taken < count; ++i) {
+        auto [slack, city] = parent_slacks[i];
+        if (in_E_set.is_set(city)) {
+            continue;
+        }
+        candidate_slacks.push_back(slack);
+        ++taken;
+    }
+    if (taken < count && tracked_slack_count < parent_slacks.size()) {
+        const int64_t untracked_slack_bound = parent_slacks[tracked_slack_count - 1].first;
+        candidate_slacks.insert(candidate_slacks.end(), count - taken, untracked_slack_bound);
+    }
+
+    count = std::min(count, candidate_slacks.size());
+    auto middle = candidate_slacks.begin() + count;
+    std::nth_element(candidate_slacks.begin(), middle, candidate_slacks.end(), std::greater<>());
+    int64_t sum = 0;
+    for (auto it = candidate_slacks.begin(); it != middle; ++it) {
+        sum += *it;
+    }
+    return sum;
+}
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "object_pool.hpp"
+#include "epoch_stamped_array.hpp"
+
+#include "eaxdef.hpp"
+#include "object_pools.hpp"
+#include "tsp_loader.hpp"
+#include "intermediate_individual.hpp"
+
+namespace eax {
+/**
+ * @brief 子個体の距離の変化量の下界から、その子個体が選ばれないことを判定できる子個体ハンドラ
+ * @details cannot_improve(下界) が true を返した子個体は、部分巡回路の統合と評価を省略してよい
+ */
+template <typename Handler>
+concept child_pruning_handler = requires(const std::remove_cvref_t<Handler>& handler, int64_t delta_distance_lower_bound) {
+    { handler.cannot_improve(delta_distance_lower_bound) } -> std::convertible_to<bool>;
+};
+
+/**
+ * @brief 部分巡回路の統合の前に子個体を捨てた回数
+ */
+struct ChildPruningStats {
+    size_t checked_children = 0;   // 距離の変化量の下界を計算した子個体の数
+    size_t pruned_children = 0;    // 部分巡回路を統合せずに捨てた子個体の数
+    size_t duplicate_children = 0; // 同じ交叉で既に生成したE-setだったため捨てた子個体の数
+};
+
+/**
+ * @brief ABサイクル群を適用した中間個体から、部分巡回路を統合した後の子個体の距離の変化量の下界を求めるクラス
+ * @details
+ *  都市 x に接続する2本の枝の長さの和から、x に最も近い2都市までの距離の和を引いた値を x の余剰 (>= 0) とする。
+ *  k 個の部分巡回路の統合では 2-opt 交換を k - 1 回行うので、接続が変わる都市は高々 4(k - 1) 個である。
+ *  よって子個体の距離の変化量は、ABサイクルによる変化量から、中間個体の余剰の大きい順に 4(k - 1) 都市分の和の半分を引いた値以上になる。
+ *  三角不等式は仮定しない。
+ *  親1の余剰の上位 max_tracked_slacks 個を assign() で求めておき、子個体ごとの手間は E-set の頂点数と 4(k - 1) に比例する。
+ */
+class ChildDistanceLowerBound {
+public:
+    /**
+     * @brief assign() で保持する親1の余剰の個数
+     */
+    static constexpr size_t max_tracked_slacks = 64;
+
+    ChildDistanceLowerBound(ObjectPools& object_pools)
+        : stamped_array_of_tsp_size_pool(object_pools.stamped_array_of_tsp_size_pool.share()) {}
+
+    /**
+     * @brief 親1の各都市の余剰を求める (交叉ごとに1回呼び出す)
+     * @param parent1 親個体1
+     * @param tsp TSPインスタンス
+     * @param adjacency_matrix tsp の距離 (tsp.distance().visit() で選んだ具体的な型)
+     */
+    void assign(const individual_readable auto& parent1, const tsp::TSP& tsp, const tsp::distance_matrix_like auto& adjacency_matrix) {
+        prepare(tsp);
+        const size_t n = parent1.size();
+        parent_slacks.resize(n);
+        for (size_t city = 0; city < n; ++city) {
+            const int64_t connection = adjacency_matrix[city][parent1[city][0]] + adjacency_matrix[city][parent1[city][1]];
+            parent_slacks[city] = {connection - nearest_two_distance_sums[city], city};
+        }
+        select_largest_parent_slacks();
+    }
+
+    /**
+     * @brief 子個体の距離の変化量の下界を求める
+     * @tparam Distance 距離行列の型
+     * @tparam ABCycles ABサイクル群の型
+     * @param working_individual applied_ab_cycles を適用した中間個体 (assign() に渡した親1が元)
+     * @param adjacency_matrix assign() に渡した距離
+     * @param applied_ab_cycles 適用したABサイクル群
+     * @param subtour_count 中間個体の部分巡回路の数
+     * @return 部分巡回路を統合した後の子個体の距離の変化量の下界 (部分巡回路が1つなら変化量そのもの)
+     */
+    template <tsp::distance_matrix_like Distance, std::ranges::range ABCycles>
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, ab_cycle_view_t>
+    int64_t operator()(const IntermediateIndividual& working_individual, const Distance& adjacency_matrix,
+                       const ABCycles& applied_ab_cycles, size_t subtour_count) {
+
+        // ABサイクルの偶数番目の枝は親1の枝 (取り除く)、奇数番目の枝は親2の枝 (加える)
+        int64_t ab_cycle_delta = 0;
+        for (const ab_cycle_view_t cycle : applied_ab_cycles) {
+            for (size_t i = 0; i < cycle.size(); i += 2) {
+                ab_cycle_delta += adjacency_matrix[cycle[i + 1]][cycle[(i + 2) % cycle.size()]]
+                                - adjacency_matrix[cycle[i]][cycle[i + 1]];
+            }
+        }
+
+        if (subtour_count <= 1) {
+            return ab_cycle_delta;
+        }
+
+        // 接続が変わった都市 (E-set の頂点) の余剰は中間個体で計算し直す
+        auto in_E_set_ptr = stamped_array_of_tsp_size_pool.acquire_unique();
+        auto& in_E_set = *in_E_set_ptr;
+        in_E_set.reset(0);
+        candidate_slacks.clear();
+        for (const ab_cycle_view_t cycle : applied_ab_cycles) {
+            for (size_t city : cycle) {
+                if (in_E_set.is_set(city)) {
+                    continue;
+                }
+                in_E_set[city] = 1;
+                const int64_t connection = adjacency_matrix[city][working_individual[city][0]] + adjacency_matrix[city][working_individual[city][1]];
+                candidate_slacks.push_back(connection - nearest_two_distance_sums[city]);
+            }
+        }
+
+        const int64_t slack_sum = sum_of_largest_slacks(4 * (subtour_count - 1), in_E_set);
+        return ab_cycle_delta - (slack_sum + 1) / 2;
+    }
+
+private:
+    /**
+     * @brief tsp の各都市から最も近い2都市までの距離の和を求める (TSPインスタンスが変わったときだけ計算する)
+     */
+    void prepare(const tsp::TSP& tsp);
+
+    /**
+     * @brief parent_slacks の先頭に余剰の大きい max_tracked_slacks 個を降順に並べる
+     */
+    void select_largest_parent_slacks();
+
+    /**
+     * @brief candidate_slacks と E-set 外の親1の余剰から、大きい順に count 個の和を求める
+     * @details 保持していない親1の余剰は、保持している最小の余剰で置き換えて上から抑える
+     */
+    int64_t sum_of_largest_slacks(size_t count, const mpi::EpochStampedArray<size_t>& in_E_set);
+
+    mpi::ObjectPool<mpi::EpochStampedArray<size_t>> stamped_array_of_tsp_size_pool;
+
+    const tsp::TSP* prepared_tsp = nullptr;
+    std::vector<int64_t> nearest_two_distance_sums;
+
+    /**
+     * @brief 親1の (余剰, 都市) の組 (先頭 tracked_slack_count 個は余剰の降順)
+     */
+    std::vector<std::pair<int64_t, size_t>> parent_slacks;
+    size_t tracked_slack_count = 0;
+
+    std::vector<int64_t> candidate_slacks;
+};
+}
\ No newline at end of file
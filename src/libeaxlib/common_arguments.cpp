@@ -0,0 +1,87 @@
+#include "common_arguments.hpp"
+
+namespace eax {
+void register_common_arguments(mpi::CommandLineArgumentParser& parser, CommonArguments& args) {
+    mpi::ArgumentSpec cache_dir_spec(args.cache_directory);
+    cache_dir_spec.add_argument_name("--cache-dir");
+    cache_dir_spec.set_description("--cache-dir <directory> \t:Directory to store cache files of initial populations (default: current directory).");
+    parser.add_argument(cache_dir_spec);
+
+    mpi::ArgumentSpec binary_cache_spec(args.binary_cache_directory);
+    binary_cache_spec.add_argument_name("--binary-cache");
+    binary_cache_spec.set_description("--binary-cache <directory> \t:Directory to store preprocessed instances (<TSP file name>.tspbin) for faster loading (default: none).");
+    parser.add_argument(binary_cache_spec);
+
+    mpi::ArgumentSpec candidates_spec(args.candidate_type_str);
+    candidates_spec.add_argument_name("--candidates");
+    candidates_spec.set_description("--candidates <type> \t:Order of the neighbor lists. Options are 'nearest' (default) and 'alpha' for alpha-nearness from 1-tree subgradient optimization.");
+    parser.add_argument(candidates_spec);
+
+    mpi::ArgumentSpec near_range_spec(args.near_range);
+    near_range_spec.add_argument_name("--near-range");
+    near_range_spec.set_description("--near-range <number> \t:Number of neighbors examined by 2-opt (default: " + std::to_string(args.default_near_range) + "). 5-10 is usually enough with '--candidates alpha'.");
+    parser.add_argument(near_range_spec);
+
+    mpi::ArgumentSpec init_spec(args.initial_tour_type_str);
+    init_spec.add_argument_name("--init");
+    init_spec.set_description("--init <type> \t\t:Construction of the initial tours before 2-opt. Options are 'random' (default), 'greedy' for greedy edge matching, 'nn' for nearest-neighbor tours, and 'hilbert' for Hilbert-curve tours.");
+    parser.add_argument(init_spec);
+
+    mpi::ArgumentSpec threads_spec(args.thread_count);
+    threads_spec.add_argument_name("--threads");
+    threads_spec.set_description("--threads <number> \t:Number of threads for loading and initial population generation (default: 0 for all hardware threads). The result does not depend on it.");
+    parser.add_argument(threads_spec);
+
+    mpi::ArgumentSpec or_opt_spec(args.or_opt);
+    or_opt_spec.add_set_argument_name("--or-opt");
+    or_opt_spec.set_description("--or-opt \t\t:Also apply Or-opt moves (segments of 1-3 cities) in the local search of the initial population.");
+    parser.add_argument(or_opt_spec);
+
+    mpi::ArgumentSpec two_h_opt_spec(args.two_h_opt);
+    two_h_opt_spec.add_set_argument_name("--two-h-opt");
+    two_h_opt_spec.set_description("--two-h-opt \t\t:Also apply 2h-opt moves (moving a single city of a 2-opt move instead of reversing) in the local search of the initial population.");
+    parser.add_argument(two_h_opt_spec);
+
+    mpi::ArgumentSpec neighbor_limit_spec(args.full_neighbor_list_limit);
+    neighbor_limit_spec.add_argument_name("--neighbor-limit");
+    neighbor_limit_spec.set_description("--neighbor-limit <number> \t:Keep only the 50 nearest cities in the neighbor lists of instances with more cities than this (default: no limit). Loading gets faster, but 2-opt with a large near range gives different tours.");
+    parser.add_argument(neighbor_limit_spec);
+}
+
+tsp::LoadOptions make_load_options(const CommonArguments& args) {
+    tsp::LoadOptions load_options;
+    load_options.binary_cache_directory = args.binary_cache_directory;
+    load_options.candidate_type = tsp::parse_candidate_type(args.candidate_type_str);
+    load_options.thread_count = args.thread_count;
+    load_options.full_neighbor_list_limit = args.full_neighbor_list_limit;
+    return load_options;
+}
+
+std::string population_cache_file(const CommonArguments& args, const tsp::TSP& tsp, size_t population_size, std::mt19937::result_type seed) {
+    using std::to_string;
+
+    // 既定と異なる設定で生成した初期集団は別のキャッシュファイルに保存する
+    std::string population_tag;
+    if (tsp::parse_candidate_type(args.candidate_type_str) != tsp::CandidateType::Nearest || args.near_range != args.default_near_range) {
+        population_tag += "_" + args.candidate_type_str + to_string(args.near_range);
+    }
+    if (tsp::parse_initial_tour_type(args.initial_tour_type_str) != tsp::InitialTourType::Random) {
+        population_tag += "_" + args.initial_tour_type_str;
+    }
+    if (args.or_opt) {
+        population_tag += "_oropt";
+    }
+    if (args.two_h_opt) {
+        population_tag += "_2hopt";
+    }
+    if (tsp.city_count > args.full_neighbor_list_limit) {
+        population_tag += "_nl" + to_string(args.full_neighbor_list_limit);
+    }
+
+    std::string cache_file = "init_pop_cache_" + to_string(seed) + "_for_" + tsp.name + "_" + to_string(population_size) + population_tag + ".bin";
+    if (args.cache_directory.ends_with('/')) {
+        return args.cache_directory + cache_file;
+    }
+    return args.cache_directory + "/" + cache_file;
+}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <random>
+#include <limits>
+
+#include "command_line_argument_parser.hpp"
+
+#include "tsp_loader.hpp"
+#include "tour_constructor.hpp"
+
+namespace eax {
+/**
+ * @brief 各アプリに共通する、インスタンスの読み込みと初期集団の生成に関するコマンドライン引数
+ * @details register_common_arguments() でパーサーに登録し、make_load_options() と population_cache_file() で使う
+ */
+struct CommonArguments {
+    /**
+     * @param default_near_range このアプリの2-optの近傍範囲の既定値
+     */
+    explicit CommonArguments(size_t default_near_range = 50)
+        : near_range(default_near_range), default_near_range(default_near_range) {}
+
+    // 初期集団のキャッシュディレクトリ
+    std::string cache_directory = ".";
+    // 前処理済みのインスタンス (.tspbin) を置くディレクトリ (空の場合は作らない)
+    std::string binary_cache_directory;
+    // 近傍リストの種類
+    std::string candidate_type_str = "nearest"; // "nearest" or "alpha"
+    // 2-optの近傍範囲
+    size_t near_range;
+    // 初期巡回路の構築方法
+    std::string initial_tour_type_str = "random"; // "random", "greedy", "nn", or "hilbert"
+    // 読み込みと初期集団の生成に使うスレッド数 (0の場合はハードウェアのスレッド数)
+    size_t thread_count = 0;
+    // 2-optに加えて Or-opt を行うかどうか
+    bool or_opt = false;
+    // 2-optに加えて 2h-opt を行うかどうか
+    bool two_h_opt = false;
+    // 全都市を含む近傍リストを構築する都市数の上限 (既定では切り詰めない)
+    size_t full_neighbor_list_limit = std::numeric_limits<size_t>::max();
+    // このアプリの2-optの近傍範囲の既定値 (既定値と異なる場合だけキャッシュファイル名に含める)
+    size_t default_near_range;
+};
+
+/**
+ * @brief 共通の引数 (--cache-dir, --binary-cache, --candidates, --near-range, --init, --threads, --or-opt, --two-h-opt, --neighbor-limit) をパーサーに登録する
+ * @param parser コマンドライン引数のパーサー
+ * @param args 解析結果を書き込む引数 (パーサーより長く生存すること)
+ */
+void register_common_arguments(mpi::CommandLineArgumentParser& parser, CommonArguments& args);
+
+/**
+ * @brief 共通の引数からインスタンスの読み込みオプションを作る
+ * @throws std::runtime_error 近傍リストの種類が不正な場合
+ */
+tsp::LoadOptions make_load_options(const CommonArguments& args);
+
+/**
+ * @brief 初期集団のキャッシュファイルのパスを取得する
+ * @details 既定と異なる設定 (近傍リスト、近傍範囲、初期巡回路、Or-opt、2h-opt、近傍リストの切り詰め) で生成した初期集団は別のファイルになる
+ * @param args 共通の引数
+ * @param tsp TSPインスタンス
+ * @param population_size 集団サイズ
+ * @param seed 初期集団の生成に使うシード
+ * @return キャッシュディレクトリ内のキャッシュファイルのパス
+ */
+std::string population_cache_file(const CommonArguments& args, const tsp::TSP& tsp, size_t population_size, std::mt19937::result_type seed);
+}
\ No newline at end of file
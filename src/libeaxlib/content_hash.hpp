@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "eaxdef.hpp"
+
+namespace eax {
+/**
+ * @brief 都市 from の隣接都市の1つが to であることを表す Zobrist キーを返す
+ * @details
+ *  個体の内容ハッシュは、全都市の2つの隣接都市についてキーの XOR をとった値で、同じ巡回路なら同じ値になる。
+ *  隣接都市を1つ付け替えるごとに、古いキーと新しいキーを XOR すれば O(1) で更新できる。
+ *  乱数表の代わりに (from, to) を splitmix64 で混ぜてキーを作るので、O(N^2) の表は持たない。
+ *  向きのある組のキーなので、無向辺 {u, v} の2つのキー key(u, v) と key(v, u) は打ち消し合わない。
+ */
+constexpr uint64_t zobrist_key(size_t from, size_t to) {
+    uint64_t x = static_cast<uint64_t>(from) * 0x9e3779b97f4a7c15ULL + static_cast<uint64_t>(to) + 0x632be59bd9b4e019ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief 個体の内容ハッシュを O(N) で計算する
+ * @param individual 個体
+ * @return 内容ハッシュ
+ */
+uint64_t calc_content_hash(const doubly_linked_list_readable auto& individual) {
+    uint64_t content_hash = 0;
+    for (size_t city = 0; city < individual.size(); ++city) {
+        content_hash ^= zobrist_key(city, individual[city][0]) ^ zobrist_key(city, individual[city][1]);
+    }
+    return content_hash;
+}
+}
\ No newline at end of file
@@ -7,6 +7,15 @@ int64_t CrossoverDelta::get_delta_distance() const {
     return this->delta_distance;
 }
 
+void CrossoverDelta::exchange_modifications(std::vector<Modification>& modifications, uint64_t base_checksum, int64_t delta_distance, std::size_t num_ab_cycle_modifications)
+{
+    this->modifications.swap(modifications);
+    this->base_checksum = base_checksum;
+    this->delta_checksum = compute_delta_checksum(this->modifications);
+    this->delta_distance = delta_distance;
+    this->num_ab_cycle_modifications = num_ab_cycle_modifications;
+}
+
 uint64_t CrossoverDelta::compute_delta_checksum(const std::vector<Modification> &modifications)
 {
     if (modifications.empty()) {
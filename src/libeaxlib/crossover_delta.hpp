@@ -3,8 +3,10 @@
 #include <cstddef>
 #include <utility>
 #include <stdexcept>
+#include <type_traits>
 
 #include "eaxdef.hpp"
+#include "content_hash.hpp"
 
 namespace eax {
 /**
@@ -13,17 +15,17 @@ namespace eax {
 class CrossoverDelta {
 public:
     /**
-     * @brief 交叉操作の変更内容
+     * @brief 交叉操作の変更内容 (都市の番号は city_index_t で保持する)
      */
     struct Modification {
         /**
          * @brief 変更前の辺 (v1, v2)
          */
-        std::pair<size_t, size_t> edge1;
+        std::pair<city_index_t, city_index_t> edge1;
         /**
          * @brief 変更後にv1に接続される新しい頂点
          */
-        size_t new_v2;
+        city_index_t new_v2;
     };
 
     CrossoverDelta(const individual_readable auto& individual)
@@ -46,15 +48,33 @@ public:
             delta_distance(delta_distance),
             num_ab_cycle_modifications(num_ab_cycle_modifications) {}
     
+    /**
+     * @brief 変更履歴を modifications と交換して、変更内容を置き換える
+     * @details modifications には以前の変更履歴が入るので、呼び出し側はその領域を次の変更履歴に使い回せる
+     * @param modifications 新しい変更履歴 (以前の変更履歴と交換される)
+     * @param base_checksum ベースの個体のチェックサム
+     * @param delta_distance 距離の変化
+     * @param num_ab_cycle_modifications ABサイクルによる変更のサイズ
+     * @pre modifications.size() % 2 == 0
+     */
+    void exchange_modifications(std::vector<Modification>& modifications, uint64_t base_checksum, int64_t delta_distance, std::size_t num_ab_cycle_modifications);
+
     /**
      * @brief 変更を個体に適用する
+     * @details 個体が内容ハッシュを持つ場合は、付け替えた隣接都市の Zobrist キーで O(変更数) で更新する
      */
     void apply_to(individual_writable auto& individual) const {
+        constexpr bool updates_content_hash = content_hash_writable<std::remove_cvref_t<decltype(individual)>>;
 
         if (base_checksum != individual.get_checksum()) {
             throw std::invalid_argument("CrossoverDelta::apply_to: The base checksum does not match the individual's checksum.");
         }
 
+        uint64_t content_hash = 0;
+        if constexpr (updates_content_hash) {
+            content_hash = individual.get_content_hash();
+        }
+
         for (const auto& modification : modifications) {
             auto [v1, v2] = modification.edge1;
             size_t new_v2 = modification.new_v2;
@@ -63,6 +83,13 @@ public:
             } else {
                 individual[v1][1] = new_v2;
             }
+            if constexpr (updates_content_hash) {
+                content_hash ^= zobrist_key(v1, v2) ^ zobrist_key(v1, new_v2);
+            }
+        }
+
+        if constexpr (updates_content_hash) {
+            individual.set_content_hash(content_hash);
         }
         
         uint64_t new_checksum = base_checksum ^ delta_checksum;
@@ -74,13 +101,20 @@ public:
 
     /**
      * @brief 変更を元に戻す
+     * @details 個体が内容ハッシュを持つ場合は、apply_to() と同様に O(変更数) で更新する
      */
     void undo(individual_writable auto& individual) const {
+        constexpr bool updates_content_hash = content_hash_writable<std::remove_cvref_t<decltype(individual)>>;
 
         if ((base_checksum ^ delta_checksum) != individual.get_checksum()) {
             throw std::invalid_argument("CrossoverDelta::undo: The individual's checksum does not match the expected checksum after applying the delta.");
         }
 
+        uint64_t content_hash = 0;
+        if constexpr (updates_content_hash) {
+            content_hash = individual.get_content_hash();
+        }
+
         for (auto it = modifications.rbegin(); it != modifications.rend(); ++it) {
             const auto& modification = *it;
             auto [v1, v2] = modification.edge1;
@@ -90,6 +124,13 @@ public:
             } else {
                 individual[v1][1] = v2;
             }
+            if constexpr (updates_content_hash) {
+                content_hash ^= zobrist_key(v1, new_v2) ^ zobrist_key(v1, v2);
+            }
+        }
+
+        if constexpr (updates_content_hash) {
+            individual.set_content_hash(content_hash);
         }
         
         uint64_t original_checksum = base_checksum;
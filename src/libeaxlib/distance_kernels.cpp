@@ -0,0 +1,75 @@
+#include "distance_kernels.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace tsp {
+namespace kernels {
+    namespace {
+        template <DistanceType Type>
+        int32_t scalar_distance(double x1, double y1, double x2, double y2) {
+            if constexpr (Type == DistanceType::EUC_2D) {
+                return static_cast<int32_t>(distance::EUC_2D(x1, y1, x2, y2));
+            } else if constexpr (Type == DistanceType::ATT) {
+                return static_cast<int32_t>(distance::ATT(x1, y1, x2, y2));
+            } else {
+                return static_cast<int32_t>(distance::CEIL_2D(x1, y1, x2, y2));
+            }
+        }
+
+        template <DistanceType Type>
+        void distance_row_impl(const double* xs, const double* ys, double xi, double yi,
+                               size_t j_begin, size_t j_end, int32_t* out) {
+            size_t j = j_begin;
+#ifdef __AVX2__
+            const __m256d vxi = _mm256_set1_pd(xi);
+            const __m256d vyi = _mm256_set1_pd(yi);
+            const __m256d half = _mm256_set1_pd(0.5);
+            const __m256d one = _mm256_set1_pd(1.0);
+            const __m256d ten = _mm256_set1_pd(10.0);
+            for (; j + 4 <= j_end; j += 4) {
+                __m256d dx = _mm256_sub_pd(vxi, _mm256_loadu_pd(xs + j));
+                __m256d dy = _mm256_sub_pd(vyi, _mm256_loadu_pd(ys + j));
+                __m256d squared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+                __m256d d;
+                if constexpr (Type == DistanceType::EUC_2D) {
+                    // (int)(sqrt(d^2) + 0.5)
+                    d = _mm256_add_pd(_mm256_sqrt_pd(squared), half);
+                } else if constexpr (Type == DistanceType::ATT) {
+                    // r = sqrt(d^2 / 10), t = (int)(r + 0.5), t < r なら t + 1
+                    __m256d r = _mm256_sqrt_pd(_mm256_div_pd(squared, ten));
+                    __m256d t = _mm256_round_pd(_mm256_add_pd(r, half), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                    __m256d less = _mm256_cmp_pd(t, r, _CMP_LT_OQ);
+                    d = _mm256_add_pd(t, _mm256_and_pd(less, one));
+                } else {
+                    // ceil(sqrt(d^2))
+                    d = _mm256_ceil_pd(_mm256_sqrt_pd(squared));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (j - j_begin)), _mm256_cvttpd_epi32(d));
+            }
+#endif
+            for (; j < j_end; ++j) {
+                out[j - j_begin] = scalar_distance<Type>(xi, yi, xs[j], ys[j]);
+            }
+        }
+    }
+
+    void distance_row(const Coordinates& coordinates, DistanceType type,
+                      size_t i, size_t j_begin, size_t j_end, int32_t* out) {
+        const double* xs = coordinates.x.data();
+        const double* ys = coordinates.y.data();
+        switch (type) {
+            case DistanceType::EUC_2D:
+                distance_row_impl<DistanceType::EUC_2D>(xs, ys, xs[i], ys[i], j_begin, j_end, out);
+                break;
+            case DistanceType::ATT:
+                distance_row_impl<DistanceType::ATT>(xs, ys, xs[i], ys[i], j_begin, j_end, out);
+                break;
+            case DistanceType::CEIL_2D:
+                distance_row_impl<DistanceType::CEIL_2D>(xs, ys, xs[i], ys[i], j_begin, j_end, out);
+                break;
+        }
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#include "distance_oracle.hpp"
+
+namespace tsp {
+namespace kernels {
+    /**
+     * @brief 1行分の距離をまとめて計算する
+     * @details
+     *  out[k] = 都市iと都市 j_begin + k の距離 を計算する。
+     *  距離の種類による分岐は行ごとに1回だけ行い、AVX2が使える場合は4都市ずつベクトル化して計算する。
+     *  丸めは distance::EUC_2D / ATT / CEIL_2D と完全に一致する。
+     * @param coordinates 都市の座標
+     * @param type 距離の種類
+     * @param i 基準の都市
+     * @param j_begin 計算する都市の範囲の先頭
+     * @param j_end 計算する都市の範囲の末尾 (含まない)
+     * @param out 出力先 (j_end - j_begin 要素)
+     * @pre 任意の2都市間の距離が int32_t に収まること (can_use_row_kernel で確認する)
+     */
+    void distance_row(const Coordinates& coordinates, DistanceType type,
+                      size_t i, size_t j_begin, size_t j_end, int32_t* out);
+
+    /**
+     * @brief distance_row を使えるかどうか
+     * @param max_distance 任意の2都市間の距離の上界
+     */
+    inline bool can_use_row_kernel(int64_t max_distance) {
+        return max_distance <= std::numeric_limits<int32_t>::max();
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "distance_oracle.hpp"
+
+#include <stdexcept>
+
+namespace tsp {
+    DistanceType parse_distance_type(const std::string& type_name) {
+        if (type_name == "EUC_2D") {
+            return DistanceType::EUC_2D;
+        } else if (type_name == "ATT") {
+            return DistanceType::ATT;
+        } else if (type_name == "CEIL_2D") {
+            return DistanceType::CEIL_2D;
+        }
+        throw std::runtime_error("Unsupported distance type: " + type_name);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,350 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "triangular_distance_matrix.hpp"
+
+namespace tsp {
+    namespace distance {
+        inline int64_t EUC_2D(double x1, double y1, double x2, double y2) {
+            return size_t(std::sqrt((x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2)) + 0.5);
+        }
+
+        inline int64_t ATT(double x1, double y1, double x2, double y2) {
+            double dx = x1 - x2;
+            double dy = y1 - y2;
+            double rij = std::sqrt((dx * dx + dy * dy) / 10.0);
+            int64_t tij = int(rij + 0.5);
+            if (tij < rij) return tij + 1;
+            else return tij;
+        }
+
+        inline int64_t CEIL_2D(double x1, double y1, double x2, double y2) {
+            double dx = x1 - x2;
+            double dy = y1 - y2;
+            return int64_t(std::ceil(std::sqrt(dx * dx + dy * dy)));
+        }
+    }
+
+    using adjacency_matrix_t = std::vector<std::vector<int64_t>>;
+
+    /**
+     * @brief 座標から距離を計算する距離の種類
+     */
+    enum class DistanceType {
+        EUC_2D,
+        ATT,
+        CEIL_2D,
+    };
+
+    /**
+     * @brief EDGE_WEIGHT_TYPEの文字列から距離の種類を取得する
+     * @param type_name EDGE_WEIGHT_TYPEの文字列
+     * @return 距離の種類
+     * @throws std::runtime_error 対応していない距離の種類の場合
+     */
+    DistanceType parse_distance_type(const std::string& type_name);
+
+    /**
+     * @brief 都市の座標 (SoA形式)
+     */
+    struct Coordinates {
+        std::vector<double> x;
+        std::vector<double> y;
+
+        size_t size() const {
+            return x.size();
+        }
+    };
+
+    /**
+     * @brief d[i][j] で距離を読み取れる型のコンセプト
+     * @details adjacency_matrix_t, TriangularDistanceMatrix, DistanceOracle, DistanceView がこのコンセプトを満たす
+     */
+    template <typename D>
+    concept distance_matrix_like = requires(const D& d, size_t i, size_t j) {
+        { d[i][j] } -> std::convertible_to<int64_t>;
+        { d.size() } -> std::convertible_to<size_t>;
+    };
+
+    /**
+     * @brief 座標から必要に応じて距離を計算する距離オラクル
+     * @details
+     *  N×N の距離行列を持たずに、座標から EUC_2D / ATT / CEIL_2D の距離を計算する。
+     *  局所探索や部分巡回路の統合では同じ都市対を繰り返し参照するため、
+     *  計算結果はスレッドごとの小さな直接マップキャッシュに保持する。
+     *  座標はコピー間で共有され、変更されない。
+     */
+    class DistanceOracle {
+    public:
+        using value_type = int64_t;
+
+        /**
+         * @brief 行の距離を読み取るためのプロキシ (oracle[i][j] の形で使用する)
+         */
+        class Row {
+        public:
+            int64_t operator[](size_t j) const {
+                return (*oracle)(i, j);
+            }
+        private:
+            friend class DistanceOracle;
+            Row(const DistanceOracle* oracle, size_t i) : oracle(oracle), i(i) {}
+            const DistanceOracle* oracle;
+            size_t i;
+        };
+
+        /**
+         * @brief 座標を持たない空のオラクルを構築する
+         */
+        DistanceOracle() = default;
+
+        /**
+         * @brief 指定した座標と距離の種類でオラクルを構築する
+         * @param coordinates 都市の座標
+         * @param type 距離の種類
+         */
+        DistanceOracle(Coordinates coordinates, DistanceType type)
+            : coordinates_ptr(std::make_shared<const Coordinates>(std::move(coordinates))),
+              type(type),
+              instance_id(next_instance_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+        /**
+         * @brief 都市iと都市jの距離を取得する (キャッシュを使用する)
+         */
+        int64_t operator()(size_t i, size_t j) const {
+            if (i == j) {
+                return 0;
+            }
+            if (i > j) {
+                std::swap(i, j);
+            }
+
+            const uint64_t key = (static_cast<uint64_t>(i) << 32) | static_cast<uint64_t>(j);
+            auto& entry = cache.entries[hash_key(key) & (Cache::SIZE - 1)];
+            if (entry.owner == instance_id && entry.key == key) {
+                return entry.value;
+            }
+
+            int64_t value = compute(i, j);
+            entry = {instance_id, key, value};
+            return value;
+        }
+
+        Row operator[](size_t i) const {
+            return Row(this, i);
+        }
+
+        /**
+         * @brief 都市iと都市jの距離をキャッシュを使わずに計算する
+         */
+        int64_t compute(size_t i, size_t j) const {
+            const auto& c = *coordinates_ptr;
+            switch (type) {
+                case DistanceType::EUC_2D:
+                    return distance::EUC_2D(c.x[i], c.y[i], c.x[j], c.y[j]);
+                case DistanceType::ATT:
+                    return distance::ATT(c.x[i], c.y[i], c.x[j], c.y[j]);
+                case DistanceType::CEIL_2D:
+                    return distance::CEIL_2D(c.x[i], c.y[i], c.x[j], c.y[j]);
+            }
+            return 0;
+        }
+
+        size_t size() const {
+            return coordinates_ptr ? coordinates_ptr->size() : 0;
+        }
+
+        /**
+         * @brief 任意の2都市間の距離の上界を取得する
+         * @details 座標のバウンディングボックスの対角の距離を返す。距離関数は座標差について単調なので、これが上界になる
+         */
+        int64_t max_distance_bound() const {
+            if (size() == 0) {
+                return 0;
+            }
+            const auto& c = *coordinates_ptr;
+            auto [min_x, max_x] = std::minmax_element(c.x.begin(), c.x.end());
+            auto [min_y, max_y] = std::minmax_element(c.y.begin(), c.y.end());
+            switch (type) {
+                case DistanceType::EUC_2D:
+                    return distance::EUC_2D(*min_x, *min_y, *max_x, *max_y);
+                case DistanceType::ATT:
+                    return distance::ATT(*min_x, *min_y, *max_x, *max_y);
+                case DistanceType::CEIL_2D:
+                    return distance::CEIL_2D(*min_x, *min_y, *max_x, *max_y);
+            }
+            return 0;
+        }
+
+        /**
+         * @brief 座標を持っているかどうか
+         */
+        bool has_coordinates() const {
+            return coordinates_ptr != nullptr;
+        }
+
+        const Coordinates& coordinates() const {
+            return *coordinates_ptr;
+        }
+
+        DistanceType get_type() const {
+            return type;
+        }
+
+    private:
+        struct Cache {
+            static constexpr size_t SIZE = 2048;
+            struct Entry {
+                uint64_t owner = 0;
+                uint64_t key = 0;
+                int64_t value = 0;
+            };
+            std::array<Entry, SIZE> entries;
+        };
+
+        static uint64_t hash_key(uint64_t key) {
+            key ^= key >> 29;
+            key *= 0xbf58476d1ce4e5b9ULL;
+            key ^= key >> 32;
+            return key;
+        }
+
+        std::shared_ptr<const Coordinates> coordinates_ptr;
+        DistanceType type = DistanceType::EUC_2D;
+        /**
+         * @brief キャッシュのエントリがどのオラクルのものかを識別するID (0は無効)
+         */
+        uint64_t instance_id = 0;
+
+        static inline std::atomic<uint64_t> next_instance_id = 1;
+        static thread_local Cache cache;
+    };
+
+    inline thread_local DistanceOracle::Cache DistanceOracle::cache;
+
+    static_assert(distance_matrix_like<DistanceOracle>);
+    static_assert(distance_matrix_like<adjacency_matrix_t>);
+    static_assert(distance_matrix_like<TriangularDistanceMatrix<uint16_t>>);
+    static_assert(distance_matrix_like<TriangularDistanceMatrix<int32_t>>);
+
+    /**
+     * @brief 距離行列または距離オラクルを参照する非所有の距離ビュー
+     * @details
+     *  密な距離行列、上三角の距離行列、距離オラクルのいずれかを参照する。
+     *  参照先はビューより長く生存している必要がある。
+     *  operator() は参照ごとに参照先の種類で分岐するので、距離を繰り返し参照する処理では
+     *  visit() で具体的な型を一度だけ選び、その型に対して実体化したテンプレートで参照する。
+     */
+    class DistanceView {
+    public:
+        using value_type = int64_t;
+
+        class Row;
+
+        DistanceView(const adjacency_matrix_t& matrix)
+            : source(&matrix), kind(Kind::Dense) {}
+
+        DistanceView(const TriangularDistanceMatrix<uint16_t>& matrix)
+            : source(&matrix), kind(Kind::Triangular16) {}
+
+        DistanceView(const TriangularDistanceMatrix<int32_t>& matrix)
+            : source(&matrix), kind(Kind::Triangular32) {}
+
+        DistanceView(const DistanceOracle& oracle)
+            : source(&oracle), kind(Kind::Oracle) {}
+
+        int64_t operator()(size_t i, size_t j) const {
+            switch (kind) {
+                case Kind::Dense:
+                    return (*static_cast<const adjacency_matrix_t*>(source))[i][j];
+                case Kind::Triangular16:
+                    return (*static_cast<const TriangularDistanceMatrix<uint16_t>*>(source))(i, j);
+                case Kind::Triangular32:
+                    return (*static_cast<const TriangularDistanceMatrix<int32_t>*>(source))(i, j);
+                case Kind::Oracle:
+                    return (*static_cast<const DistanceOracle*>(source))(i, j);
+            }
+            return 0;
+        }
+
+        Row operator[](size_t i) const;
+
+        /**
+         * @brief 参照先を具体的な型の const 参照として f に渡す
+         * @details f は adjacency_matrix_t, TriangularDistanceMatrix<uint16_t>, TriangularDistanceMatrix<int32_t>, DistanceOracle のいずれでも呼び出せること
+         * @param f 距離を受け取る関数オブジェクト (ジェネリックラムダなど)
+         * @return f の戻り値
+         */
+        template <typename F>
+        decltype(auto) visit(F&& f) const {
+            switch (kind) {
+                case Kind::Dense:
+                    return std::forward<F>(f)(*static_cast<const adjacency_matrix_t*>(source));
+                case Kind::Triangular16:
+                    return std::forward<F>(f)(*static_cast<const TriangularDistanceMatrix<uint16_t>*>(source));
+                case Kind::Triangular32:
+                    return std::forward<F>(f)(*static_cast<const TriangularDistanceMatrix<int32_t>*>(source));
+                case Kind::Oracle:
+                    break;
+            }
+            return std::forward<F>(f)(*static_cast<const DistanceOracle*>(source));
+        }
+
+        size_t size() const {
+            switch (kind) {
+                case Kind::Dense:
+                    return static_cast<const adjacency_matrix_t*>(source)->size();
+                case Kind::Triangular16:
+                    return static_cast<const TriangularDistanceMatrix<uint16_t>*>(source)->size();
+                case Kind::Triangular32:
+                    return static_cast<const TriangularDistanceMatrix<int32_t>*>(source)->size();
+                case Kind::Oracle:
+                    return static_cast<const DistanceOracle*>(source)->size();
+            }
+            return 0;
+        }
+
+    private:
+        enum class Kind : uint8_t {
+            Dense,
+            Triangular16,
+            Triangular32,
+            Oracle,
+        };
+
+        const void* source;
+        Kind kind;
+    };
+
+    /**
+     * @brief 行の距離を読み取るためのプロキシ (view[i][j] の形で使用する)
+     * @details 一時オブジェクトのビューからも安全に使えるよう、ビューを値で保持する
+     */
+    class DistanceView::Row {
+    public:
+        int64_t operator[](size_t j) const {
+            return view(i, j);
+        }
+    private:
+        friend class DistanceView;
+        Row(const DistanceView& view, size_t i) : view(view), i(i) {}
+        DistanceView view;
+        size_t i;
+    };
+
+    inline DistanceView::Row DistanceView::operator[](size_t i) const {
+        return Row(*this, i);
+    }
+
+    static_assert(distance_matrix_like<DistanceView>);
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+
 #include "eaxdef.hpp"
 #include "crossover_delta.hpp"
 #include "edge_counter.hpp"
@@ -90,6 +93,17 @@ struct DistancePreserving {
         // 減少多様性当たりの距離の減少量を評価値とする
         return delta_L / delta_H;
     }
+
+    /**
+     * @brief 距離の変化量が delta_distance_lower_bound 以上の子個体の評価値の上界を返す
+     * @details 距離が伸びる子個体の評価値は常に -1 なので、それ以外は上から抑えられない
+     */
+    double upper_bound(int64_t delta_distance_lower_bound) const {
+        if (delta_distance_lower_bound > 0) {
+            return -1.0;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
 };
 } // namespace impl
 
@@ -0,0 +1,70 @@
+#include "e_set_hash_set.hpp"
+
+#include <algorithm>
+
+namespace eax {
+void ESetHashSet::clear() {
+    indices.clear();
+    offsets.resize(1);
+    hashes.clear();
+    std::fill(slots.begin(), slots.end(), 0);
+}
+
+bool ESetHashSet::insert(const std::vector<size_t>& e_set_indices) {
+    canonical.assign(e_set_indices.begin(), e_set_indices.end());
+    std::sort(canonical.begin(), canonical.end());
+    const uint64_t h = hash(canonical.data(), canonical.data() + canonical.size());
+
+    const size_t mask = slots.size() - 1;
+    size_t slot = h & mask;
+    while (slots[slot] != 0) {
+        const size_t entry = slots[slot] - 1;
+        if (hashes[entry] == h && equals(entry, canonical.data(), canonical.size())) {
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    slots[slot] = static_cast<uint32_t>(hashes.size() + 1);
+    hashes.push_back(h);
+    indices.insert(indices.end(), canonical.begin(), canonical.end());
+    offsets.push_back(indices.size());
+
+    // 負荷率を 1/2 以下に保つ
+    if (hashes.size() * 2 > slots.size()) {
+        grow();
+    }
+    return true;
+}
+
+uint64_t ESetHashSet::hash(const size_t* first, const size_t* last) {
+    // FNV-1a をインデックス単位で適用し、最後に splitmix64 の仕上げで下位ビットを混ぜる
+    uint64_t h = 14695981039346656037ULL;
+    for (const size_t* it = first; it != last; ++it) {
+        h ^= static_cast<uint64_t>(*it);
+        h *= 1099511628211ULL;
+    }
+    h ^= static_cast<uint64_t>(last - first);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+bool ESetHashSet::equals(size_t entry, const size_t* canonical, size_t length) const {
+    const size_t begin = offsets[entry];
+    const size_t end = offsets[entry + 1];
+    return end - begin == length && std::equal(indices.begin() + begin, indices.begin() + end, canonical);
+}
+
+void ESetHashSet::grow() {
+    slots.assign(slots.size() * 2, 0);
+    const size_t mask = slots.size() - 1;
+    for (size_t entry = 0; entry < hashes.size(); ++entry) {
+        size_t slot = hashes[entry] & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = static_cast<uint32_t>(entry + 1);
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace eax {
+/**
+ * @brief 最良の子個体を1つだけ選ぶ子個体ハンドラ
+ * @details
+ *  同じE-setからは同じ子個体が生成され、適応度が同じなら先に生成された子個体が選ばれるので、
+ *  このハンドラに渡す交叉では、2回目以降に現れたE-setの子個体を生成せずに済む。
+ */
+template <typename Handler>
+concept single_best_child_handler = std::remove_cvref_t<Handler>::selects_single_best;
+
+/**
+ * @brief 1回の交叉で生成したE-setを覚えておき、同じE-setの2回目以降を検出する集合
+ * @details
+ *  E-setはABサイクルのインデックスを昇順に並べたものを正規形とし、そのハッシュ値をキーとする
+ *  オープンアドレス法のハッシュ表で管理する。ハッシュ値が一致した場合はインデックス列を比較するので、
+ *  異なるE-setを重複と誤判定することはない。
+ *  交叉ごとに clear() してから使う。E-setの数は子個体の数程度なので、表は小さいまま使い回される。
+ */
+class ESetHashSet {
+public:
+    ESetHashSet() : offsets{0}, slots(16, 0) {}
+
+    /**
+     * @brief 登録したE-setをすべて取り除く (領域は保持する)
+     */
+    void clear();
+
+    /**
+     * @brief E-setを登録する
+     * @param e_set_indices E-setを構成するABサイクルのインデックス (順不同)
+     * @return 新たに登録した場合はtrue、既に登録されていた場合はfalse
+     */
+    bool insert(const std::vector<size_t>& e_set_indices);
+
+    /**
+     * @brief 登録したE-setの数を返す
+     */
+    size_t size() const {
+        return hashes.size();
+    }
+private:
+    /**
+     * @brief 昇順に並べたインデックス列のハッシュ値を計算する
+     */
+    static uint64_t hash(const size_t* first, const size_t* last);
+
+    /**
+     * @brief entry 番目のE-setが canonical (長さ length) と等しいかを判定する
+     */
+    bool equals(size_t entry, const size_t* canonical, size_t length) const;
+
+    /**
+     * @brief 表を2倍に広げて、登録済みのE-setを入れ直す
+     */
+    void grow();
+
+    // 登録したE-setの正規形 (i 番目は indices[offsets[i]] から indices[offsets[i + 1]] の手前まで)
+    std::vector<size_t> indices;
+    std::vector<size_t> offsets;
+    std::vector<uint64_t> hashes;
+
+    /**
+     * @brief ハッシュ表 (要素数は2の冪、0 は空き、それ以外は登録番号 + 1)
+     */
+    std::vector<uint32_t> slots;
+
+    // insert() の作業領域
+    std::vector<size_t> canonical;
+};
+}
\ No newline at end of file
@@ -10,19 +10,27 @@
 #include "crossover_delta.hpp"
 #include "tsp_loader.hpp"
 #include "ab_cycle_finder.hpp"
+#include "sparse_ab_cycle_finder.hpp"
+#include "ab_cycle_set.hpp"
 #include "block2_e_set_assembler.hpp"
 #include "subtour_merger.hpp"
+#include "child_distance_lower_bound.hpp"
 
 namespace eax {
-class EAX_Block2 {
+/**
+ * @brief Block2 によるEAX交叉を行うクラス
+ * @tparam AB_Cycle_Finder すべてのABサイクルを見つけるクラス
+ */
+template <typename AB_Cycle_Finder = ABCycleFinder>
+class EAX_Block2_base {
 public:
-    EAX_Block2(ObjectPools& object_pools)
-        : vector_of_tsp_size_pool(object_pools.vector_of_tsp_size_pool.share()),
-          any_size_vector_pool(object_pools.any_size_vector_pool.share()),
+    EAX_Block2_base(ObjectPools& object_pools)
+        : any_size_vector_pool(object_pools.any_size_vector_pool.share()),
           intermediate_individual_pool(object_pools.intermediate_individual_pool.share()),
           ab_cycle_finder(object_pools),
           block2_e_set_assembler_builder(object_pools),
-          subtour_merger(object_pools) {}
+          subtour_merger(object_pools),
+          child_distance_lower_bound(object_pools) {}
 
     /**
      * @brief 交叉操作を実行する
@@ -35,89 +43,135 @@ public:
      */
     std::vector<CrossoverDelta> operator()(const individual_readable auto& parent1, const individual_readable auto& parent2, size_t children_size,
                                         const tsp::TSP& tsp, std::mt19937& rng) {
-        auto& adjacency_matrix = tsp.adjacency_matrix;
+        std::vector<CrossoverDelta> children;
+        for_each_child(parent1, parent2, children_size, tsp, rng, [&children](CrossoverDelta& child) {
+            children.emplace_back(std::move(child));
+        });
+        return children;
+    }
+
+    /**
+     * @brief 交叉操作を実行し、子個体を生成するたびに on_child に渡す
+     * @details
+     *  子個体は1つの CrossoverDelta に上書きしながら渡す。on_child が子個体をムーブしなければ、
+     *  その変更履歴の領域は次の子個体に使い回されるので、子個体ごとの確保は起こらない。
+     *  on_child が child_pruning_handler を満たす場合は、部分巡回路を統合する前に距離の変化量の下界を求め、
+     *  選ばれないと判定された子個体を捨てる。
+     * @param on_child 子個体を受け取る関数 (CrossoverDelta& を引数に取る)
+     */
+    template <typename ChildHandler>
+        requires std::invocable<ChildHandler&, CrossoverDelta&>
+    void for_each_child(const individual_readable auto& parent1, const individual_readable auto& parent2, size_t children_size,
+                        const tsp::TSP& tsp, std::mt19937& rng, ChildHandler&& on_child) {
         using namespace std;
 
         const size_t n = parent1.size();
 
-        auto path_ptr = vector_of_tsp_size_pool.acquire_unique();
-        auto pos_ptr = vector_of_tsp_size_pool.acquire_unique();
-        vector<size_t>& path = *path_ptr;
-        vector<size_t>& pos = *pos_ptr;
-        
-        // 親間で異なる枝の本数
+        // 親間で異なる枝の本数 (各枝を両端で数えるので最後に2で割る)
         size_t different_edges_count = 0;
-        for (size_t i = 0, prev = 0, current = 0; i < n; ++i) {
-            path[i] = current;
-            pos[current] = i;
-            size_t next = parent1[current][0];
-            if (next == prev) {
-                next = parent1[current][1];
+        for (size_t city = 0; city < n; ++city) {
+            for (size_t e = 0; e < 2; ++e) {
+                const size_t neighbor = parent1[city][e];
+                if (parent2[city][0] != neighbor && parent2[city][1] != neighbor)
+                    ++different_edges_count;
             }
-            
-            if (parent2[current][0] != next && parent2[current][1] != next)
-                ++different_edges_count;
-            prev = current;
-            current = next;
         }
+        different_edges_count /= 2;
 
-        auto AB_cycles = ab_cycle_finder(numeric_limits<size_t>::max(), parent1, parent2, rng);
+        auto AB_cycles_ptr = ab_cycle_finder(numeric_limits<size_t>::max(), parent1, parent2, rng);
+        ABCycleSet& AB_cycles = *AB_cycles_ptr;
         
-        sort(AB_cycles.begin(), AB_cycles.end(), [](const mpi::pooled_unique_ptr<ab_cycle_t>& a, const mpi::pooled_unique_ptr<ab_cycle_t>& b) {
-            return a->size() > b->size();
+        AB_cycles.sort([](ab_cycle_view_t a, ab_cycle_view_t b) {
+            return a.size() > b.size();
         });
         
         auto block2_e_set_assembler = block2_e_set_assembler_builder.create(parent1, parent2, AB_cycles);
         
         children_size = min(children_size, AB_cycles.size());
 
-        vector<CrossoverDelta> children;
-        auto working_individual = intermediate_individual_pool.acquire_unique();
-        working_individual->assign(parent1);
-        for (size_t child_index = 0; child_index < children_size; ++child_index) {
-            auto selected_AB_cycles_indices_ptr = block2_e_set_assembler(child_index, rng);
-            auto& selected_AB_cycles_indices = *selected_AB_cycles_indices_ptr;
-            
-            if (selected_AB_cycles_indices.size() == AB_cycles.size()) {
-                continue; // 全てのABサイクルを選択している場合はスキップ
+        // 距離の型は交叉ごとに1回だけ選び、子個体の生成はその型で実体化したコードで行う
+        tsp.distance().visit([&](const auto& adjacency_matrix) {
+            CrossoverDelta child(parent1);
+            auto working_individual = intermediate_individual_pool.acquire_unique();
+            working_individual->assign(parent1);
+
+            constexpr bool prunes_children = child_pruning_handler<ChildHandler>;
+            if constexpr (prunes_children) {
+                child_distance_lower_bound.assign(parent1, tsp, adjacency_matrix);
             }
+
+            for (size_t child_index = 0; child_index < children_size; ++child_index) {
+                auto selected_AB_cycles_indices_ptr = block2_e_set_assembler(child_index, rng);
+                auto& selected_AB_cycles_indices = *selected_AB_cycles_indices_ptr;
+            
+                if (selected_AB_cycles_indices.size() == AB_cycles.size()) {
+                    continue; // 全てのABサイクルを選択している場合はスキップ
+                }
             
-            auto selected_AB_cycles_view = selected_AB_cycles_indices | views::transform([&AB_cycles](size_t index) -> const ab_cycle_t& {
-                return *AB_cycles[index];
-            });
+                auto selected_AB_cycles_view = selected_AB_cycles_indices | views::transform([&AB_cycles](size_t index) -> ab_cycle_view_t {
+                    return AB_cycles[index];
+                });
 
-            working_individual->apply_AB_cycles(selected_AB_cycles_view);
+                working_individual->apply_AB_cycles(selected_AB_cycles_view);
 
-            subtour_merger(*working_individual, tsp, selected_AB_cycles_view);
+                if constexpr (prunes_children) {
+                    auto subtour_list_ptr = subtour_merger.find_subtours(*working_individual, selected_AB_cycles_view);
+                    const int64_t delta_distance_lower_bound = child_distance_lower_bound(*working_individual, adjacency_matrix, selected_AB_cycles_view, subtour_list_ptr->sub_tour_count());
+                    ++pruning_stats.checked_children;
+                    if (on_child.cannot_improve(delta_distance_lower_bound)) {
+                        // 部分巡回路をどう統合しても選ばれない
+                        ++pruning_stats.pruned_children;
+                        working_individual->discard();
+                        continue;
+                    }
+                    subtour_merger.merge_subtours(*working_individual, tsp, adjacency_matrix, *subtour_list_ptr);
+                } else {
+                    subtour_merger(*working_individual, tsp, adjacency_matrix, selected_AB_cycles_view);
+                }
             
-            // 削除された親1の枝の数(追加された親２の枝の数)
-            size_t swapped_edges_count = 0;
-            for (size_t i = 0; i < selected_AB_cycles_indices.size(); ++i) {
-                const auto& cycle = *AB_cycles[selected_AB_cycles_indices[i]];
-                swapped_edges_count += cycle.size() / 2;
-            }
+                // 削除された親1の枝の数(追加された親２の枝の数)
+                size_t swapped_edges_count = 0;
+                for (size_t i = 0; i < selected_AB_cycles_indices.size(); ++i) {
+                    swapped_edges_count += AB_cycles[selected_AB_cycles_indices[i]].size() / 2;
+                }
             
-            if (swapped_edges_count * 2 >= different_edges_count &&
-                parent1.get_distance() + working_individual->calc_delta_distance(adjacency_matrix) == parent2.get_distance()) {
-                // 交換された枝の数が親間で異なる枝の数の半分以上であり、
-                // 子供の距離が親2と同じ場合は、子供を追加しない
-                working_individual->discard();
-                continue;
+                if (swapped_edges_count * 2 >= different_edges_count &&
+                    parent1.get_distance() + working_individual->calc_delta_distance(adjacency_matrix) == parent2.get_distance()) {
+                    // 交換された枝の数が親間で異なる枝の数の半分以上であり、
+                    // 子供の距離が親2と同じ場合は、子供を追加しない
+                    working_individual->discard();
+                    continue;
+                }
+
+                working_individual->get_delta_and_revert(adjacency_matrix, child);
+                on_child(child);
             }
+        });
+    }
 
-            children.emplace_back(working_individual->get_delta_and_revert(adjacency_matrix));
-        }
-        return children;
+    /**
+     * @brief 部分巡回路の統合の前に子個体を捨てた回数を返す
+     */
+    const ChildPruningStats& get_pruning_stats() const {
+        return pruning_stats;
     }
 private:
-    mpi::ObjectPool<std::vector<size_t>> vector_of_tsp_size_pool;
     mpi::ObjectPool<std::vector<size_t>> any_size_vector_pool;
     mpi::ObjectPool<IntermediateIndividual> intermediate_individual_pool;
-    ABCycleFinder ab_cycle_finder;
+    AB_Cycle_Finder ab_cycle_finder;
     Block2ESetAssemblerBuilder block2_e_set_assembler_builder;
     SubtourMerger subtour_merger;
+    ChildDistanceLowerBound child_distance_lower_bound;
+    ChildPruningStats pruning_stats;
 };
 
+using EAX_Block2 = EAX_Block2_base<>;
+/**
+ * @brief 親間で異なる枝だけからABサイクルを探索する Block2
+ * @details 親がほとんど同じになる終盤ではABサイクルの探索が速いが、ABサイクルの分け方が EAX_Block2 とは異なる
+ */
+using EAX_Sparse_Block2 = EAX_Block2_base<SparseABCycleFinder>;
+
 class EAX_Block2_tag {
 public:
     EAX_Block2_tag() = default;
@@ -133,4 +187,20 @@ public:
         return "Block2";
     }
 };
+
+class EAX_Sparse_Block2_tag {
+public:
+    EAX_Sparse_Block2_tag() = default;
+    EAX_Sparse_Block2_tag(const std::string& str) {
+        if (!match_string(str)) {
+            throw std::invalid_argument("Invalid EAX type string for EAX_Sparse_Block2.");
+        }
+    }
+    static bool match_string(const std::string& str) {
+        return str == "SparseBlock2";
+    }
+    std::string to_string() const {
+        return "SparseBlock2";
+    }
+};
 }
\ No newline at end of file
@@ -75,7 +75,7 @@ public:
     N_AB_e_set_assembler_builder(ObjectPools& object_pools) :
         any_size_vector_pool(object_pools.any_size_vector_pool.share()) {}
 
-    N_AB_e_set_assembler build(const std::vector<mpi::pooled_unique_ptr<ab_cycle_t>>& AB_cycles, const auto&, const auto&, size_t, const tsp::TSP&, std::mt19937& rng, size_t N_parameter) {
+    N_AB_e_set_assembler build(const ABCycleSet& AB_cycles, const auto&, const auto&, size_t, const tsp::TSP&, std::mt19937& rng, size_t N_parameter) {
         return N_AB_e_set_assembler(AB_cycles.size(), N_parameter, any_size_vector_pool.share(), rng);
     }
 
@@ -11,7 +11,10 @@
 #include "crossover_delta.hpp"
 #include "object_pools.hpp"
 #include "ab_cycle_finder.hpp"
+#include "ab_cycle_set.hpp"
 #include "subtour_merger.hpp"
+#include "child_distance_lower_bound.hpp"
+#include "e_set_hash_set.hpp"
 
 namespace eax {
 /**
@@ -25,6 +28,7 @@ class EAX_normal {
 public:
     EAX_normal(ObjectPools& object_pools)
         : intermediate_individual_pool(object_pools.intermediate_individual_pool.share()),
+          e_set_hash_set_pool(object_pools.e_set_hash_set_pool.share()),
           ab_cycle_finder(object_pools),
           subtour_merger(object_pools),
           e_set_assembler_builder(object_pools) {}
@@ -32,8 +36,28 @@ public:
     template <typename BuilderArgsTuple = std::tuple<>, typename MergerArgsTuple = std::tuple<>, typename FinderArgsTuple = std::tuple<>>
     std::vector<CrossoverDelta> operator()(const individual_readable auto& parent1, const individual_readable auto& parent2, size_t children_size, const tsp::TSP& tsp, std::mt19937& rng,
                                             BuilderArgsTuple&& builder_args = {}, MergerArgsTuple&& merger_args = {}, FinderArgsTuple&& finder_args = {}) {
+        std::vector<CrossoverDelta> children;
+        for_each_child(parent1, parent2, children_size, tsp, rng, [&children](CrossoverDelta& child) {
+            children.emplace_back(std::move(child));
+        }, std::forward<BuilderArgsTuple>(builder_args), std::forward<MergerArgsTuple>(merger_args), std::forward<FinderArgsTuple>(finder_args));
+        return children;
+    }
+
+    /**
+     * @brief 交叉操作を実行し、子個体を生成するたびに on_child に渡す
+     * @details
+     *  子個体は1つの CrossoverDelta に上書きしながら渡す。on_child が子個体をムーブしなければ、
+     *  その変更履歴の領域は次の子個体に使い回されるので、子個体ごとの確保は起こらない。
+     *  on_child が single_best_child_handler を満たす場合は、同じ交叉で既に生成したE-setを ABサイクルの適用前に読み飛ばす。
+     * @param on_child 子個体を受け取る関数 (CrossoverDelta& を引数に取る)
+     */
+    template <typename ChildHandler, typename BuilderArgsTuple = std::tuple<>, typename MergerArgsTuple = std::tuple<>, typename FinderArgsTuple = std::tuple<>>
+        requires std::invocable<ChildHandler&, CrossoverDelta&>
+    void for_each_child(const individual_readable auto& parent1, const individual_readable auto& parent2, size_t children_size, const tsp::TSP& tsp, std::mt19937& rng,
+                        ChildHandler&& on_child,
+                        BuilderArgsTuple&& builder_args = {}, MergerArgsTuple&& merger_args = {}, FinderArgsTuple&& finder_args = {}) {
         using namespace std;
-        
+
         size_t ab_cycle_need = [&]() {
             if constexpr (mpi::tuple_like<BuilderArgsTuple>) {
                 // BuilderArgsTupleがtuple_likeであれば引数を展開して渡す
@@ -48,7 +72,7 @@ public:
             }
         }();
         
-        auto AB_cycles = [&]() {
+        auto AB_cycles_ptr = [&]() {
             if constexpr (mpi::tuple_like<FinderArgsTuple>) {
                 // FinderArgsTupleがtuple_likeであれば引数を展開して渡す
                 return std::apply(
@@ -62,6 +86,8 @@ public:
             }
         }();
 
+        const ABCycleSet& AB_cycles = *AB_cycles_ptr;
+
         auto e_set_assembler = [&]() {
             if constexpr (mpi::tuple_like<BuilderArgsTuple>) {
                 // BuilderArgsTupleがtuple_likeであれば引数を展開して渡す
@@ -76,43 +102,70 @@ public:
             }
         }();
         
-        std::vector<CrossoverDelta> children;
+        // 距離の型は交叉ごとに1回だけ選び、子個体の生成はその型で実体化したコードで行う
+        tsp.distance().visit([&](const auto& adjacency_matrix) {
+            CrossoverDelta child(parent1);
         
-        auto working_individual_ptr = intermediate_individual_pool.acquire_unique();
-        IntermediateIndividual& working_individual = *working_individual_ptr;
-        working_individual.assign(parent1);
+            auto working_individual_ptr = intermediate_individual_pool.acquire_unique();
+            IntermediateIndividual& working_individual = *working_individual_ptr;
+            working_individual.assign(parent1);
+
+            constexpr bool skips_duplicate_e_sets = single_best_child_handler<ChildHandler>;
+            auto seen_e_sets_ptr = e_set_hash_set_pool.acquire_unique();
+            ESetHashSet& seen_e_sets = *seen_e_sets_ptr;
+            seen_e_sets.clear();
         
-        for (size_t i = 0; i < children_size && e_set_assembler.has_next(); ++i) {
-            auto e_set_indices_ptr = e_set_assembler.next(rng);
-            auto& e_set_indices = *e_set_indices_ptr;
+            for (size_t i = 0; i < children_size && e_set_assembler.has_next(); ++i) {
+                auto e_set_indices_ptr = e_set_assembler.next(rng);
+                auto& e_set_indices = *e_set_indices_ptr;
+
+                if constexpr (skips_duplicate_e_sets) {
+                    if (!seen_e_sets.insert(e_set_indices)) {
+                        // 同じE-setからは同じ子個体しか生成されない
+                        ++pruning_stats.duplicate_children;
+                        continue;
+                    }
+                }
  
-            auto selected_AB_cycles_view = std::views::transform(e_set_indices, [&AB_cycles](size_t index) -> const ab_cycle_t& {
-                return *AB_cycles[index];
-            }); 
+                auto selected_AB_cycles_view = std::views::transform(e_set_indices, [&AB_cycles](size_t index) -> ab_cycle_view_t {
+                    return AB_cycles[index];
+                }); 
 
-            working_individual.apply_AB_cycles(selected_AB_cycles_view);
+                working_individual.apply_AB_cycles(selected_AB_cycles_view);
             
-            if constexpr (mpi::tuple_like<MergerArgsTuple>) {
-                // MergerArgsTupleがtuple_likeであれば引数を展開して渡す
-                std::apply(
-                    [&](auto&&... args) {
-                        subtour_merger(working_individual, tsp, selected_AB_cycles_view, std::forward<decltype(args)>(args)...);
-                    }, std::forward<MergerArgsTuple>(merger_args)
-                );
-            } else {
-                // そうでなければそのまま渡す
-                subtour_merger(working_individual, tsp, selected_AB_cycles_view, std::forward<MergerArgsTuple>(merger_args));
+                if constexpr (mpi::tuple_like<MergerArgsTuple>) {
+                    // MergerArgsTupleがtuple_likeであれば引数を展開して渡す
+                    std::apply(
+                        [&](auto&&... args) {
+                            subtour_merger(working_individual, tsp, adjacency_matrix, selected_AB_cycles_view, std::forward<decltype(args)>(args)...);
+                        }, std::forward<MergerArgsTuple>(merger_args)
+                    );
+                } else {
+                    // そうでなければそのまま渡す
+                    subtour_merger(working_individual, tsp, adjacency_matrix, selected_AB_cycles_view, std::forward<MergerArgsTuple>(merger_args));
+                }
+
+                working_individual.get_delta_and_revert(adjacency_matrix, child);
+                on_child(child);
             }
+        });
+    }
 
-            children.emplace_back(working_individual.get_delta_and_revert(tsp.adjacency_matrix));
-        }
-        
-        return children;
+    /**
+     * @brief 子個体を捨てた回数を返す
+     * @details
+     *  部分巡回路の統合の前の下界による枝刈りは行わない (checked_children と pruned_children は常に0)。
+     *  N_AB や Rand の子個体はほとんど刈れず、下界の計算の分だけ遅くなるため。
+     */
+    const ChildPruningStats& get_pruning_stats() const {
+        return pruning_stats;
     }
 private:
     mpi::ObjectPool<IntermediateIndividual> intermediate_individual_pool;
+    mpi::ObjectPool<ESetHashSet> e_set_hash_set_pool;
     AB_Cycle_Finder ab_cycle_finder;
     Subtour_Merger subtour_merger;
     E_Set_Assembler_Builder e_set_assembler_builder;
+    ChildPruningStats pruning_stats;
 };
 }
\ No newline at end of file
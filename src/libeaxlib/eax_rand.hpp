@@ -43,7 +43,7 @@ public:
     Rand_e_set_assembler_builder(ObjectPools& object_pools) :
         any_size_vector_pool(object_pools.any_size_vector_pool.share()) {}
     
-    Rand_e_set_assembler build(const std::vector<mpi::pooled_unique_ptr<ab_cycle_t>>& AB_cycles, const auto&, const auto&, size_t, const tsp::TSP&, std::mt19937&) {
+    Rand_e_set_assembler build(const ABCycleSet& AB_cycles, const auto&, const auto&, size_t, const tsp::TSP&, std::mt19937&) {
         return Rand_e_set_assembler(AB_cycles.size(), any_size_vector_pool.share());
     }
 
@@ -48,7 +48,7 @@ public:
     uniform_e_set_assembler_builder(ObjectPools& object_pools) :
         any_size_vector_pool(object_pools.any_size_vector_pool.share()) {}
     
-    uniform_e_set_assembler build(const std::vector<mpi::pooled_unique_ptr<ab_cycle_t>>& AB_cycles, const auto&, const auto&, size_t, const tsp::TSP&, std::mt19937&, double target_size_ratio = 1.0) {
+    uniform_e_set_assembler build(const ABCycleSet& AB_cycles, const auto&, const auto&, size_t, const tsp::TSP&, std::mt19937&, double target_size_ratio = 1.0) {
         return uniform_e_set_assembler(AB_cycles.size(), target_size_ratio, any_size_vector_pool.share());
     }
 
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <vector>
 #include <array>
+#include <memory>
+#include <span>
 
 #include "tsp_loader.hpp"
 
@@ -10,8 +12,18 @@ namespace eax {
 using adjacency_matrix_t = tsp::adjacency_matrix_t;
 using NN_list_t = tsp::NN_list_t;
 
-using ab_cycle_t = std::vector<size_t>;
-using doubly_linked_list_t = std::vector<std::array<size_t, 2>>;
+/**
+ * @brief 個体や変更履歴に保持する都市の番号の型
+ * @details 都市数は uint32 に収まること (TSPのバイナリ形式やTwoLevelListTourと同じ制限)
+ */
+using city_index_t = uint32_t;
+
+using ab_cycle_t = std::vector<city_index_t>;
+/**
+ * @brief ABサイクルの頂点列への読み取り専用の参照 (ab_cycle_t や ABCycleSet の要素から変換できる)
+ */
+using ab_cycle_view_t = std::span<const city_index_t>;
+using doubly_linked_list_t = std::vector<std::array<city_index_t, 2>>;
 using edge_counts_t [[deprecated("Use EdgeCounter class instead")]] = std::vector<std::vector<size_t>>;
 
 /**
@@ -51,6 +63,23 @@ concept checksum_writable =
         t.set_checksum(val);
     };
 
+/**
+ * @brief 巡回路の内容から求めたハッシュ値の読み取りが可能なコンセプト
+ */
+template <typename T>
+concept content_hash_readable = requires(const T t) {
+        { t.get_content_hash() } -> std::convertible_to<uint64_t>;
+    };
+
+/**
+ * @brief 巡回路の内容から求めたハッシュ値の書き込みが可能なコンセプト
+ */
+template <typename T>
+concept content_hash_writable =
+    content_hash_readable<T> && requires(T t, uint64_t val) {
+        t.set_content_hash(val);
+    };
+
 /**
  * @brief 距離の読み取りが可能なコンセプト
  */
@@ -86,6 +115,52 @@ concept individual_writable =
     checksum_writable<T> &&
     distance_writable<T>;
 
+/**
+ * @brief 巡回路の順序と各都市の位置
+ * @details 都市0から、都市0の0番目の隣接都市の向きにたどった順序で表す
+ */
+struct TourOrder {
+    std::vector<city_index_t> path;
+    std::vector<city_index_t> pos;
+
+    /**
+     * @brief 個体の隣接関係をたどって順序を構築する O(N)
+     * @param individual 順序を求める個体
+     */
+    void assign(const doubly_linked_list_readable auto& individual) {
+        const size_t n = individual.size();
+        path.resize(n);
+        pos.resize(n);
+        size_t prev = 0;
+        size_t current = 0;
+        for (size_t i = 0; i < n; ++i) {
+            path[i] = static_cast<city_index_t>(current);
+            pos[current] = static_cast<city_index_t>(i);
+
+            size_t next = individual[current][0];
+            if (next == prev) {
+                next = individual[current][1];
+            }
+
+            prev = current;
+            current = next;
+        }
+    }
+};
+
+/**
+ * @brief 共有される読み取り専用の巡回路の順序
+ */
+using TourOrderPtr = std::shared_ptr<const TourOrder>;
+
+/**
+ * @brief 巡回路の順序を保持し、共有できる個体のコンセプト
+ */
+template <typename T>
+concept tour_order_readable = requires(const T t) {
+        { t.get_tour_order() } -> std::convertible_to<TourOrderPtr>;
+    };
+
 /**
  * @brief すべてのABサイクルを見つけることが保証されたクラスのタグ
  */
@@ -20,13 +20,13 @@ public:
           in_min_sub_tour_pool(object_pools.in_min_sub_tour_pool.share()),
           subtour_finder(object_pools) {}
 
-    template <std::ranges::range ABCycles, typename Policy>
-        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, const ab_cycle_t&>
+    template <tsp::distance_matrix_like Distance, std::ranges::range ABCycles, typename Policy>
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, ab_cycle_view_t>
     void operator()(IntermediateIndividual& working_individual,
-                    const tsp::TSP& tsp,
+                    const tsp::TSP&,
+                    const Distance& adjacency_matrix,
                     const ABCycles& applied_ab_cycles,
                     const EdgeCounter<Policy>& edge_counter) { 
-        auto& adjacency_matrix = tsp.adjacency_matrix;
         auto& path = working_individual.get_path();
         auto& pos = working_individual.get_pos();
                                     
@@ -34,7 +34,7 @@ public:
         SubtourList& subtour_list = *subtour_list_ptr;
 
         using namespace std;
-        using distance_type = std::remove_cvref_t<decltype(adjacency_matrix)>::value_type::value_type;
+        using distance_type = int64_t;
         using edge = pair<size_t, size_t>;
 
         auto elem_of_min_sub_tour_ptr = any_size_vector_pool.acquire_unique();
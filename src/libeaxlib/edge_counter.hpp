@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <algorithm>
 #include <ranges>
@@ -14,6 +15,11 @@ struct NaivePolicy {};
 struct CompactPolicy {};
 struct OrderedCompactPolicy {};
 
+/**
+ * @brief 辺の出現回数の型 (個体数以下)
+ */
+using edge_count_t = uint32_t;
+
 /**
  * @tparam Policy エッジカウンタのポリシー
  */
@@ -31,7 +37,7 @@ class EdgeCounter<NaivePolicy> {
 public:
 
     EdgeCounter(size_t num_vertices, size_t population_size)
-        : edge_counts(num_vertices, std::vector<size_t>(num_vertices, 0)),
+        : edge_counts(num_vertices, std::vector<edge_count_t>(num_vertices, 0)),
           unique_edge_counts_per_vertex(num_vertices, 0),
           population_size(population_size),
           unique_edge_count(0) {}
@@ -119,7 +125,7 @@ public:
         std::vector<size_t> connected_vertices;
         for (size_t v2 = 0; v2 < edge_counts[v1].size(); ++v2) {
             if (edge_counts[v1][v2] > 0) {
-                connected_vertices.push_back(v2);
+                connected_vertices.push_back(static_cast<city_index_t>(v2));
             }
         }
         std::sort(connected_vertices.begin(), connected_vertices.end(),
@@ -169,7 +175,7 @@ public:
     }
     
 private:
-    std::vector<std::vector<size_t>> edge_counts;
+    std::vector<std::vector<edge_count_t>> edge_counts;
     std::vector<size_t> unique_edge_counts_per_vertex;
     size_t population_size;
     size_t unique_edge_count = 0;
@@ -231,7 +237,7 @@ public:
      * @param v1 始点頂点
      * @return 接続されている頂点のvector
      */
-    const std::vector<size_t>& get_connected_vertices(size_t v1) const {
+    const std::vector<city_index_t>& get_connected_vertices(size_t v1) const {
         return vertex_counters[v1].connected_vertices;
     }
     
@@ -339,7 +345,7 @@ private:
             auto it = std::find(connected_vertices.begin(), connected_vertices.end(), v2);
 
             if (it == connected_vertices.end()) {
-                connected_vertices.push_back(v2);
+                connected_vertices.push_back(static_cast<city_index_t>(v2));
                 return;
             }
 
@@ -428,7 +434,7 @@ private:
         /**
          * @brief 1回以上出現する辺の接続先
          */
-        std::vector<size_t> connected_vertices;
+        std::vector<city_index_t> connected_vertices;
         
         /**
          * @brief connected_verticesに対応する出現回数の範囲の開始位置
@@ -437,7 +443,7 @@ private:
          *          もし、[count_range_begins[0], connected_vertices.size()) の範囲に
          *          頂点が存在する場合、その頂点は出現回数が 1 回であることを示す。
          */
-        std::vector<size_t> count_range_begins;
+        std::vector<uint32_t> count_range_begins;
 
         friend class EdgeCounter;
     };
@@ -518,7 +524,7 @@ public:
      * @param v1 始点頂点
      * @return 接続されている頂点のvector
      */
-    const std::vector<size_t>& get_connected_vertices(size_t v1) const {
+    const std::vector<city_index_t>& get_connected_vertices(size_t v1) const {
         return vertex_counters[v1].connected_vertices;
     }
 
@@ -612,7 +618,7 @@ private:
             auto it = std::find(connected_vertices.begin(), connected_vertices.end(), v2);
 
             if (it == connected_vertices.end()) {
-                connected_vertices.push_back(v2);
+                connected_vertices.push_back(static_cast<city_index_t>(v2));
                 edge_counts.push_back(1);
                 return;
             }
@@ -676,13 +682,13 @@ private:
         /**
          * @brief 1回以上出現する辺の接続先
          */
-        std::vector<size_t> connected_vertices;
+        std::vector<city_index_t> connected_vertices;
         
         /**
          * @brief connected_verticesに対応する辺の出現回数
          * @invariant connected_vertices.size() == edge_counts.size()
          */
-        std::vector<size_t> edge_counts;
+        std::vector<edge_count_t> edge_counts;
 
         friend class EdgeCounter;
     };
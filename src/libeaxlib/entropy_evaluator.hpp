@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cmath>
+#include <limits>
 
 #include "eaxdef.hpp"
 #include "crossover_delta.hpp"
@@ -135,6 +137,17 @@ struct Entropy {
         // 減少多様性当たりの距離の減少量を評価値とする
         return delta_L / delta_H;
     }
+
+    /**
+     * @brief 距離の変化量が delta_distance_lower_bound 以上の子個体の評価値の上界を返す
+     * @details 距離が伸びる子個体の評価値は常に -1 なので、それ以外は上から抑えられない
+     */
+    double upper_bound(int64_t delta_distance_lower_bound) const {
+        if (delta_distance_lower_bound > 0) {
+            return -1.0;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
 };
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "crossover_delta.hpp"
 
 namespace eax {
@@ -10,6 +12,13 @@ struct Greedy {
     double operator()(const CrossoverDelta& child) const {
         return -1.0 * child.get_delta_distance();
     }
+
+    /**
+     * @brief 距離の変化量が delta_distance_lower_bound 以上の子個体の評価値の上界を返す
+     */
+    double upper_bound(int64_t delta_distance_lower_bound) const {
+        return -1.0 * delta_distance_lower_bound;
+    }
 };
 }
 
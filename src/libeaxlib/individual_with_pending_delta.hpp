@@ -9,7 +9,7 @@ class IndividualWithPendingDelta : public ReadableWithBasicIndividual<Individual
 public:
     using DeltaType = CrossoverDelta;
 
-    IndividualWithPendingDelta(const std::vector<size_t>& path, const adjacency_matrix_t& adjacency_matrix)
+    IndividualWithPendingDelta(const std::vector<size_t>& path, tsp::DistanceView adjacency_matrix)
         : ReadableWithBasicIndividual<IndividualWithPendingDelta>(path, adjacency_matrix),
           pending_delta(*this) {}
 
@@ -9,28 +9,22 @@ namespace eax {
 IntermediateIndividual::IntermediateIndividual(size_t size)
     : individual_being_edited(size),
       modifications(),
-      path(size),
-      pos(size) {
+      own_tour_order(std::make_shared<TourOrder>()) {
     
     // 適当に初期化
+    own_tour_order->path.resize(size);
+    own_tour_order->pos.resize(size);
     for (size_t i = 0; i < size; ++i) {
-        path[i] = i;
-        pos[i] = i;
+        own_tour_order->path[i] = static_cast<city_index_t>(i);
+        own_tour_order->pos[i] = static_cast<city_index_t>(i);
     }
+    tour_order = own_tour_order;
     
     for (size_t i = 1; i < size - 1; ++i) {
-        individual_being_edited[i] = {i - 1, i + 1};
+        individual_being_edited[i] = {static_cast<city_index_t>(i - 1), static_cast<city_index_t>(i + 1)};
     }
-    individual_being_edited[0] = {size - 1, 1};
-    individual_being_edited[size - 1] = {size - 2, 0};
-}
-
-CrossoverDelta IntermediateIndividual::get_delta_and_revert(const adjacency_matrix_t& adjacency_matrix) {
-    revert();
-    int64_t delta_distance = calc_delta_distance(adjacency_matrix);
-    CrossoverDelta delta(std::move(modifications), base_checksum, delta_distance, num_ab_cycle_modifications);
-    reset();
-    return delta;
+    individual_being_edited[0] = {static_cast<city_index_t>(size - 1), 1};
+    individual_being_edited[size - 1] = {static_cast<city_index_t>(size - 2), 0};
 }
 
 void IntermediateIndividual::discard() {
@@ -38,12 +32,12 @@ void IntermediateIndividual::discard() {
     reset();
 }
 
-const std::array<size_t, 2>& IntermediateIndividual::operator[](size_t index) const {
+const std::array<city_index_t, 2>& IntermediateIndividual::operator[](size_t index) const {
     return individual_being_edited[index];
 }
 
 void IntermediateIndividual::change_connection(size_t v1, size_t v2, size_t new_v2) {
-    modifications.emplace_back(std::pair{v1, v2}, new_v2);
+    modifications.emplace_back(std::pair<city_index_t, city_index_t>(v1, v2), static_cast<city_index_t>(new_v2));
 
     if (individual_being_edited[v1][0] == v2) {
         individual_being_edited[v1][0] = new_v2;
@@ -65,25 +59,12 @@ void IntermediateIndividual::swap_edges(std::pair<size_t, size_t> edge1, std::pa
     change_connection(u1, u2, v1);
 }
 
-const std::vector<size_t>& IntermediateIndividual::get_path() const {
-    return path;
+const std::vector<city_index_t>& IntermediateIndividual::get_path() const {
+    return tour_order->path;
 }
 
-const std::vector<size_t>& IntermediateIndividual::get_pos() const {
-    return pos;
-}
-
-int64_t IntermediateIndividual::calc_delta_distance(const std::vector<std::vector<int64_t>>& adjacency_matrix) const {
-    int64_t delta_distance = 0;
-    for (auto& modification : modifications) {
-        auto [v1, v2] = modification.edge1;
-        size_t new_v2 = modification.new_v2;
-        delta_distance -= adjacency_matrix[v1][v2];
-        delta_distance += adjacency_matrix[v1][new_v2];
-    }
-    
-    delta_distance /= 2;
-    return delta_distance;
+const std::vector<city_index_t>& IntermediateIndividual::get_pos() const {
+    return tour_order->pos;
 }
 
 void IntermediateIndividual::revert() {
@@ -93,7 +74,7 @@ void IntermediateIndividual::revert() {
 }
 
 /**
- * @brief individual_being_edited, path, posを除くすべてのメンバ変数を初期化する。
+ * @brief individual_being_edited, tour_orderを除くすべてのメンバ変数を初期化する。
  * @note この関数は、revert()が呼び出された後、change_connection()やswap_edges()が呼び出される前に呼び出されることを想定している。
  */
 void IntermediateIndividual::reset() {
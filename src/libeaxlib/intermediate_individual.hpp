@@ -1,6 +1,9 @@
 #pragma once
 
 #include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "eaxdef.hpp"
 #include "crossover_delta.hpp"
@@ -26,36 +29,30 @@ public:
     IntermediateIndividual(const individual_readable auto& individual)
         : individual_being_edited(individual.size()),
         base_checksum(individual.get_checksum()),
-        modifications(),
-        path(individual.size()),
-        pos(individual.size()) {
+        modifications() {
         assign(individual);
     }
 
     /**
      * @brief 指定した個体を中間個体に代入する
+     * @details 個体が巡回路の順序を保持していれば、それを共有して順序の構築を省く
      * @param individual 代入する個体
      */
     void assign(const individual_readable auto& individual) {
         reset();
         base_checksum = individual.get_checksum();
         for (size_t i = 0; i < individual.size(); ++i) {
-            individual_being_edited[i] = {individual[i][0], individual[i][1]};
+            individual_being_edited[i] = {static_cast<city_index_t>(individual[i][0]), static_cast<city_index_t>(individual[i][1])};
         }
 
-        size_t prev = 0;
-        size_t current = 0;
-        for (size_t i = 0; i < individual.size(); ++i) {
-            path[i] = current;
-            pos[current] = i;
-
-            size_t next = individual[current][0];
-            if (next == prev) {
-                next = individual[current][1];
+        if constexpr (tour_order_readable<std::remove_cvref_t<decltype(individual)>>) {
+            tour_order = individual.get_tour_order();
+        } else {
+            if (!own_tour_order) {
+                own_tour_order = std::make_shared<TourOrder>();
             }
-
-            prev = current;
-            current = next;
+            own_tour_order->assign(individual);
+            tour_order = own_tour_order;
         }
     }
     
@@ -64,7 +61,25 @@ public:
      * @param adjacency_matrix 隣接行列
      * @return 変更内容
      */
-    CrossoverDelta get_delta_and_revert(const adjacency_matrix_t& adjacency_matrix);
+    CrossoverDelta get_delta_and_revert(const tsp::distance_matrix_like auto& adjacency_matrix) {
+        revert();
+        int64_t delta_distance = calc_delta_distance(adjacency_matrix);
+        CrossoverDelta delta(std::move(modifications), base_checksum, delta_distance, num_ab_cycle_modifications);
+        reset();
+        return delta;
+    }
+    /**
+     * @brief 現在の変更内容を delta に書き出し、中間個体を元に戻す
+     * @details delta が保持していた変更履歴の領域を、この中間個体の次の変更履歴に使い回す
+     * @param adjacency_matrix 隣接行列
+     * @param delta 変更内容の書き出し先
+     */
+    void get_delta_and_revert(const tsp::distance_matrix_like auto& adjacency_matrix, CrossoverDelta& delta) {
+        revert();
+        int64_t delta_distance = calc_delta_distance(adjacency_matrix);
+        delta.exchange_modifications(modifications, base_checksum, delta_distance, num_ab_cycle_modifications);
+        reset();
+    }
     /**
      * @brief 現在の変更内容を破棄し、中間個体を元に戻す
      */
@@ -75,7 +90,7 @@ public:
      * @param index 頂点のインデックス
      * @return 頂点の隣接頂点の配列
      */
-    const std::array<size_t, 2>& operator[](size_t index) const;
+    const std::array<city_index_t, 2>& operator[](size_t index) const;
     
     /**
      * @brief 指定した2つの辺を入れ替える
@@ -94,7 +109,7 @@ public:
      * @param AB_cycles 適用するABサイクル群
      */
     template <std::ranges::range ABCycles>
-        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, const ab_cycle_t&>
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, ab_cycle_view_t>
     void apply_AB_cycles(const ABCycles& AB_cycles) {
         using namespace std;
 
@@ -103,7 +118,7 @@ public:
             change_connection(ab, ba, b2);
         };
 
-        for (const ab_cycle_t& cycle : AB_cycles) {
+        for (const ab_cycle_view_t cycle : AB_cycles) {
             for (size_t i = 2; i < cycle.size() - 2; i += 2) {
                 edge_swap(cycle[i - 1], cycle[i], cycle[i + 1], cycle[i + 2]);
             }
@@ -124,18 +139,29 @@ public:
      * @brief 現在の個体の巡回路の順序を取得する
      * @return 巡回路の順序を表す頂点のベクター
      */
-    const std::vector<size_t>& get_path() const;
+    const std::vector<city_index_t>& get_path() const;
     /**
      * @brief 現在の個体の各頂点の巡回路における位置を取得する
      * @return 各頂点の巡回路における位置を表すベクター
      */
-    const std::vector<size_t>& get_pos() const;
+    const std::vector<city_index_t>& get_pos() const;
     /**
      * @brief 中間個体の元の個体に対する距離の変化を計算する
      * @param adjacency_matrix 隣接行列
      * @return 距離の変化
      */
-    int64_t calc_delta_distance(const std::vector<std::vector<int64_t>>& adjacency_matrix) const;
+    int64_t calc_delta_distance(const tsp::distance_matrix_like auto& adjacency_matrix) const {
+        int64_t delta_distance = 0;
+        for (auto& modification : modifications) {
+            auto [v1, v2] = modification.edge1;
+            size_t new_v2 = modification.new_v2;
+            delta_distance -= adjacency_matrix[v1][v2];
+            delta_distance += adjacency_matrix[v1][new_v2];
+        }
+
+        delta_distance /= 2;
+        return delta_distance;
+    }
     size_t size() const;
 private:
     /**
@@ -162,7 +188,13 @@ private:
      * @brief ABサイクルによる変化のサイズ
      */
     std::size_t num_ab_cycle_modifications = 0;
-    std::vector<size_t> path;
-    std::vector<size_t> pos;
+    /**
+     * @brief 元の個体の巡回路の順序 (元の個体から共有したもの、または own_tour_order)
+     */
+    TourOrderPtr tour_order;
+    /**
+     * @brief 元の個体が順序を保持していない場合に、この中間個体で構築した順序
+     */
+    std::shared_ptr<TourOrder> own_tour_order;
 };
 }
\ No newline at end of file
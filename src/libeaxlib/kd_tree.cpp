@@ -0,0 +1,244 @@
+#include "kd_tree.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace tsp {
+    KDTree::KDTree(const Coordinates& coordinates) {
+        const size_t n = coordinates.size();
+        ids.resize(n);
+        std::iota(ids.begin(), ids.end(), 0);
+        xs = coordinates.x;
+        ys = coordinates.y;
+        split_axis.assign(n, 0);
+
+        build(0, n);
+
+        // 点を木の順序に並べ替える
+        std::vector<double> sorted_xs(n), sorted_ys(n);
+        index_of_city.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            sorted_xs[i] = coordinates.x[ids[i]];
+            sorted_ys[i] = coordinates.y[ids[i]];
+            index_of_city[ids[i]] = i;
+        }
+        xs = std::move(sorted_xs);
+        ys = std::move(sorted_ys);
+    }
+
+    void KDTree::build(size_t begin, size_t end) {
+        if (end - begin <= BUCKET_SIZE) {
+            return;
+        }
+
+        // 広がりの大きい軸で分割する
+        double min_x = std::numeric_limits<double>::max(), max_x = std::numeric_limits<double>::lowest();
+        double min_y = std::numeric_limits<double>::max(), max_y = std::numeric_limits<double>::lowest();
+        for (size_t i = begin; i < end; ++i) {
+            min_x = std::min(min_x, xs[ids[i]]);
+            max_x = std::max(max_x, xs[ids[i]]);
+            min_y = std::min(min_y, ys[ids[i]]);
+            max_y = std::max(max_y, ys[ids[i]]);
+        }
+        const uint8_t axis = (max_x - min_x >= max_y - min_y) ? 0 : 1;
+        const auto& key = axis == 0 ? xs : ys;
+
+        const size_t mid = begin + (end - begin) / 2;
+        std::nth_element(ids.begin() + begin, ids.begin() + mid, ids.begin() + end,
+                         [&key](size_t a, size_t b) {
+                             return key[a] < key[b] || (key[a] == key[b] && a < b);
+                         });
+        split_axis[mid] = axis;
+
+        build(begin, mid);
+        build(mid + 1, end);
+    }
+
+    template <typename Visitor>
+    void KDTree::search(size_t begin, size_t end, double qx, double qy, Visitor& visitor) const {
+        if (begin >= end || visitor.prune(begin, end)) {
+            return;
+        }
+        if (end - begin <= BUCKET_SIZE) {
+            for (size_t i = begin; i < end; ++i) {
+                visitor.offer(i, squared_distance(i, qx, qy));
+            }
+            return;
+        }
+
+        const size_t mid = begin + (end - begin) / 2;
+        const double diff = split_axis[mid] == 0 ? qx - xs[mid] : qy - ys[mid];
+        visitor.offer(mid, squared_distance(mid, qx, qy));
+
+        if (diff < 0) {
+            search(begin, mid, qx, qy, visitor);
+            if (diff * diff <= visitor.radius()) {
+                search(mid + 1, end, qx, qy, visitor);
+            }
+        } else {
+            search(mid + 1, end, qx, qy, visitor);
+            if (diff * diff <= visitor.radius()) {
+                search(begin, mid, qx, qy, visitor);
+            }
+        }
+    }
+
+    std::vector<size_t> KDTree::k_nearest(size_t city, size_t k) const {
+        // 距離、都市番号の辞書順で小さいk個を保持する最大ヒープ
+        struct Visitor {
+            const KDTree& tree;
+            size_t self;
+            size_t k;
+            std::priority_queue<std::pair<double, size_t>> heap;
+
+            void offer(size_t index, double d2) {
+                size_t id = tree.ids[index];
+                if (id == self) {
+                    return;
+                }
+                if (heap.size() < k) {
+                    heap.emplace(d2, id);
+                } else if (std::make_pair(d2, id) < heap.top()) {
+                    heap.pop();
+                    heap.emplace(d2, id);
+                }
+            }
+
+            double radius() const {
+                return heap.size() < k ? std::numeric_limits<double>::max() : heap.top().first;
+            }
+
+            bool prune(size_t, size_t) const {
+                return false;
+            }
+        };
+
+        k = std::min(k, size() == 0 ? 0 : size() - 1);
+        if (k == 0) {
+            return {};
+        }
+
+        const size_t index = index_of_city[city];
+        Visitor visitor{*this, city, k, {}};
+        search(0, size(), xs[index], ys[index], visitor);
+
+        std::vector<size_t> result(visitor.heap.size());
+        for (size_t i = result.size(); i-- > 0;) {
+            result[i] = visitor.heap.top().second;
+            visitor.heap.pop();
+        }
+        return result;
+    }
+
+    size_t KDTree::nearest_outside(size_t city, const std::vector<uint8_t>& excluded) const {
+        struct Visitor {
+            const KDTree& tree;
+            const std::vector<uint8_t>& excluded;
+            double best_d2 = std::numeric_limits<double>::max();
+            size_t best = std::numeric_limits<size_t>::max();
+
+            void offer(size_t index, double d2) {
+                size_t id = tree.ids[index];
+                if (excluded[id]) {
+                    return;
+                }
+                if (d2 < best_d2 || (d2 == best_d2 && id < best)) {
+                    best_d2 = d2;
+                    best = id;
+                }
+            }
+
+            double radius() const {
+                return best_d2;
+            }
+
+            bool prune(size_t, size_t) const {
+                return false;
+            }
+        };
+
+        const size_t index = index_of_city[city];
+        Visitor visitor{*this, excluded};
+        search(0, size(), xs[index], ys[index], visitor);
+        return visitor.best;
+    }
+
+    KDTree::ActiveSet KDTree::make_active_set() const {
+        ActiveSet active_set;
+        active_set.active.assign(size(), true);
+        active_set.subtree_count.assign(size(), 0);
+        fill_subtree_count(active_set, 0, size());
+        return active_set;
+    }
+
+    size_t KDTree::fill_subtree_count(ActiveSet& active_set, size_t begin, size_t end) const {
+        if (begin >= end) {
+            return 0;
+        }
+        size_t count = end - begin;
+        if (end - begin > BUCKET_SIZE) {
+            const size_t mid = begin + (end - begin) / 2;
+            fill_subtree_count(active_set, begin, mid);
+            fill_subtree_count(active_set, mid + 1, end);
+        }
+        active_set.subtree_count[node_position(begin, end)] = count;
+        return count;
+    }
+
+    void KDTree::deactivate(ActiveSet& active_set, size_t city) const {
+        const size_t index = index_of_city[city];
+        active_set.active[index] = false;
+        size_t begin = 0;
+        size_t end = size();
+        while (true) {
+            --active_set.subtree_count[node_position(begin, end)];
+            if (end - begin <= BUCKET_SIZE) {
+                break;
+            }
+            const size_t mid = begin + (end - begin) / 2;
+            if (index == mid) {
+                break;
+            } else if (index < mid) {
+                end = mid;
+            } else {
+                begin = mid + 1;
+            }
+        }
+    }
+
+    size_t KDTree::nearest_active(size_t city, const ActiveSet& active_set) const {
+        struct Visitor {
+            const KDTree& tree;
+            const ActiveSet& active_set;
+            size_t self;
+            double best_d2 = std::numeric_limits<double>::max();
+            size_t best = std::numeric_limits<size_t>::max();
+
+            void offer(size_t index, double d2) {
+                size_t id = tree.ids[index];
+                if (!active_set.active[index] || id == self) {
+                    return;
+                }
+                if (d2 < best_d2 || (d2 == best_d2 && id < best)) {
+                    best_d2 = d2;
+                    best = id;
+                }
+            }
+
+            double radius() const {
+                return best_d2;
+            }
+
+            bool prune(size_t begin, size_t end) const {
+                return active_set.subtree_count[node_position(begin, end)] == 0;
+            }
+        };
+
+        const size_t index = index_of_city[city];
+        Visitor visitor{*this, active_set, city};
+        search(0, size(), xs[index], ys[index], visitor);
+        return visitor.best;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+#include "distance_oracle.hpp"
+
+namespace tsp {
+    /**
+     * @brief 都市の座標に対する2次元k-d木
+     * @details
+     *  EUC_2D / ATT / CEIL_2D の距離はいずれもユークリッド距離について単調なので、
+     *  ユークリッド距離での近傍探索の結果をそのまま距離の近い順として扱える。
+     *  点は木の順序に並べ替えて保持し、葉はバケットとして線形探索する。
+     */
+    class KDTree {
+    public:
+        /**
+         * @brief 探索の対象として残っている点の集合
+         * @details
+         *  部分木ごとに残っている点の数を保持し、点が残っていない部分木は探索しない。
+         *  最近傍法のように探索の対象から点を順に取り除いていく場合に、nearest_outside より高速に探索できる。
+         */
+        class ActiveSet {
+        private:
+            friend class KDTree;
+            /**
+             * @brief 木の順序での位置ごとの、点が残っているかどうか
+             */
+            std::vector<uint8_t> active;
+            /**
+             * @brief 部分木に残っている点の数 (内部節点は中央の位置、葉は先頭の位置に保持する)
+             */
+            std::vector<size_t> subtree_count;
+        };
+
+
+        /**
+         * @brief 点を持たない空の木を構築する
+         */
+        KDTree() = default;
+
+        /**
+         * @brief 指定した座標からk-d木を構築する O(N log N)
+         * @param coordinates 都市の座標
+         */
+        explicit KDTree(const Coordinates& coordinates);
+
+        /**
+         * @brief 都市に近い順にk個の都市を取得する (都市自身は含まない)
+         * @param city 基準の都市
+         * @param k 取得する都市の数
+         * @return 近い順に並んだ都市のベクター
+         */
+        std::vector<size_t> k_nearest(size_t city, size_t k) const;
+
+        /**
+         * @brief excluded[c] が偽である都市のうち、都市に最も近い都市を取得する
+         * @param city 基準の都市
+         * @param excluded 除外する都市のフラグ
+         * @return 最も近い都市 (該当する都市がない場合は std::numeric_limits<size_t>::max())
+         */
+        size_t nearest_outside(size_t city, const std::vector<uint8_t>& excluded) const;
+
+        /**
+         * @brief すべての点が残っている集合を作成する O(N)
+         */
+        ActiveSet make_active_set() const;
+
+        /**
+         * @brief 集合から都市を取り除く O(log N)
+         * @param active_set 対象の集合
+         * @param city 取り除く都市 (集合に残っていること)
+         */
+        void deactivate(ActiveSet& active_set, size_t city) const;
+
+        /**
+         * @brief 集合に残っている都市のうち、都市に最も近い都市を取得する (都市自身は含まない)
+         * @param city 基準の都市 (集合に残っていなくてもよい)
+         * @param active_set 対象の集合
+         * @return 最も近い都市 (該当する都市がない場合は std::numeric_limits<size_t>::max())
+         */
+        size_t nearest_active(size_t city, const ActiveSet& active_set) const;
+
+        size_t size() const {
+            return ids.size();
+        }
+
+        bool empty() const {
+            return ids.empty();
+        }
+
+    private:
+        /**
+         * @brief これ以下の点しか含まない部分木は分割せず葉として扱う
+         */
+        static constexpr size_t BUCKET_SIZE = 8;
+
+        void build(size_t begin, size_t end);
+
+        /**
+         * @brief 部分木 [begin, end) の情報を保持する位置 (内部節点は中央の位置、葉は先頭の位置)
+         */
+        static size_t node_position(size_t begin, size_t end) {
+            return end - begin <= BUCKET_SIZE ? begin : begin + (end - begin) / 2;
+        }
+
+        size_t fill_subtree_count(ActiveSet& active_set, size_t begin, size_t end) const;
+
+        template <typename Visitor>
+        void search(size_t begin, size_t end, double qx, double qy, Visitor& visitor) const;
+
+        double squared_distance(size_t index, double qx, double qy) const {
+            double dx = xs[index] - qx;
+            double dy = ys[index] - qy;
+            return dx * dx + dy * dy;
+        }
+
+        /**
+         * @brief 木の順序に並べた点の座標と都市番号
+         */
+        std::vector<double> xs;
+        std::vector<double> ys;
+        std::vector<size_t> ids;
+        /**
+         * @brief 各部分木の中央の点での分割軸 (0: x, 1: y)
+         */
+        std::vector<uint8_t> split_axis;
+        /**
+         * @brief 都市番号から木の順序での位置への対応
+         */
+        std::vector<size_t> index_of_city;
+    };
+}
\ No newline at end of file
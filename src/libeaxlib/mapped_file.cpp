@@ -0,0 +1,41 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tsp {
+    MappedFile::MappedFile(const std::string& file_name) {
+        int fd = ::open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open the file: " + file_name);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not stat the file: " + file_name);
+        }
+        length = static_cast<size_t>(st.st_size);
+
+        if (length > 0) {
+            void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map the file: " + file_name);
+            }
+            address = mapped;
+        }
+        // マップ後はファイル記述子を閉じてもよい
+        ::close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (address != nullptr) {
+            ::munmap(address, length);
+        }
+    }
+}
\ No newline at end of file
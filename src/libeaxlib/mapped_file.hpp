@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace tsp {
+    /**
+     * @brief 読み取り専用でメモリマップしたファイル
+     */
+    class MappedFile {
+    public:
+        /**
+         * @brief 指定したファイルを読み取り専用でメモリマップする
+         * @param file_name ファイル名
+         * @throws std::runtime_error ファイルを開けない、またはマップできない場合
+         */
+        explicit MappedFile(const std::string& file_name);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const std::byte* data() const {
+            return static_cast<const std::byte*>(address);
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+    private:
+        void* address = nullptr;
+        size_t length = 0;
+    };
+}
\ No newline at end of file
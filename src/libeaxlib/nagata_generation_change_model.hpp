@@ -3,24 +3,67 @@
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <concepts>
+#include <cstdint>
 #include <type_traits>
 #include <random>
+#include <utility>
+
+#include "eaxdef.hpp"
+
 namespace eax {
 
+/**
+ * @brief NagataGenerationChangeModel に適応度の上界を計算する関数を渡さない場合の型
+ */
+struct NoFitnessBound {};
+
 /**
  * @brief 1世代の世代交代を行う関数オブジェクト
  * @details 「局所的な交叉EAXを用いたGAの高速化とTSPへの適用」(DOI:10.1527/tjsai.22.542)
  *          に記述されている世代交代モデルの実装。
+ *          交叉関数が子個体を受け取る関数を第4引数に取れて、個体が DeltaType を定義していれば、
+ *          子個体を生成されるたびに評価し、最良の子個体だけを保持する (子個体のベクターは作らない)。
+ *          さらに適応度の上界を計算する関数を渡すと、交叉関数は最良の子個体を超えられない子個体を
+ *          部分巡回路の統合の前に捨てられる (child_pruning_handler を参照。子個体の多くを刈れる Block2 だけが対応する)。
+ *          個体が内容ハッシュを持つ場合は、内容が同じ親Aと親Bの組では交叉を呼び出さない。
+ *          同じ巡回路どうしではABサイクルが作れず子個体は生成されないので、親Aは置き換わらない
+ *          (ただし交叉がABサイクルの探索で消費していた乱数は消費されなくなる)。
  * @tparam FitnessFunc 適応度を計算する関数オブジェクト
  * @tparam CrossOverFunc 交叉を行う関数オブジェクト
+ * @tparam FitnessBoundFunc 距離の変化量の下界と実行コンテキストから、適応度の上界を計算する関数オブジェクト
  */
-template <typename FitnessFunc, typename CrossOverFunc>
+template <typename FitnessFunc, typename CrossOverFunc, typename FitnessBoundFunc = NoFitnessBound>
 class NagataGenerationChangeModel
 {
+    /**
+     * @brief 交叉関数が子個体のベクターを返すかどうか
+     */
+    template <typename Individual, typename Context>
+    static constexpr bool is_materializing = requires(std::vector<Individual> population, FitnessFunc fitness_func, CrossOverFunc cross_over, Context context) {
+        { fitness_func(cross_over(population[0], population[1], context)[0], context) } -> std::convertible_to<double>;
+        population[0] = cross_over(population[0], population[1], context)[0];
+    };
+
+    /**
+     * @brief 交叉関数が子個体を1つずつ関数に渡せるかどうか
+     */
+    template <typename Individual, typename Context>
+    static constexpr bool is_streaming = requires { typename Individual::DeltaType; }
+        && requires(Individual parent, FitnessFunc fitness_func, CrossOverFunc cross_over, Context context,
+                    typename Individual::DeltaType child, void (*on_child)(typename Individual::DeltaType&)) {
+        cross_over(parent, parent, context, on_child);
+        { fitness_func(child, context) } -> std::convertible_to<double>;
+        parent = std::move(child);
+    };
+
 public:
     NagataGenerationChangeModel(FitnessFunc fitness_func, CrossOverFunc cross_over_func)
         : fitness_func(std::move(fitness_func)), cross_over(std::move(cross_over_func)){}
 
+    NagataGenerationChangeModel(FitnessFunc fitness_func, CrossOverFunc cross_over_func, FitnessBoundFunc fitness_upper_bound)
+        : fitness_func(std::move(fitness_func)), cross_over(std::move(cross_over_func)), fitness_upper_bound(std::move(fitness_upper_bound)) {}
+
     /**
      * @brief 世代交代モデルの１回の世代交代を実行する
      * @param population 集団
@@ -28,12 +71,136 @@ public:
      * @note contextはrandom_genメンバ変数を持ち、それはコンセプトstd::uniform_random_bit_generatorを満たす型である必要があります。
      */
     template <typename Individual, typename Context>
-        requires(requires(std::vector<Individual> population, FitnessFunc fitness_func, CrossOverFunc cross_over, Context context) {
-            { fitness_func(cross_over(population[0], population[1], context)[0], context) } -> std::convertible_to<double>;
-            population[0] = cross_over(population[0], population[1], context)[0];
-            context.random_gen;
-        } && std::uniform_random_bit_generator<decltype(Context::random_gen)>)
+        requires((is_materializing<Individual, Context> || is_streaming<Individual, Context>)
+            && requires(Context context) { context.random_gen; }
+            && std::uniform_random_bit_generator<decltype(Context::random_gen)>)
     void operator()(std::vector<Individual>& population, Context& context)
+    {
+        if constexpr (is_streaming<Individual, Context>) {
+            streaming_step(population, context);
+        } else {
+            materializing_step(population, context);
+        }
+    }
+
+    /**
+     * @brief 内容が同じだったため交叉を省略した親Aと親Bの組の数 (これまでの累計) を返す
+     */
+    size_t get_identical_parent_pair_count() const {
+        return identical_parent_pair_count;
+    }
+private:
+    /**
+     * @brief 親Aと親Bの内容が同じかを内容ハッシュで O(1) で判定する (内容ハッシュを持たない個体では常に false)
+     */
+    template <typename Individual>
+    bool is_identical_pair(const Individual& parent_A, const Individual& parent_B) {
+        if constexpr (content_hash_readable<Individual>) {
+            if (parent_A.get_content_hash() == parent_B.get_content_hash()) {
+                ++identical_parent_pair_count;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 交叉関数に渡す子個体ハンドラ。子個体を評価して、最良の子個体だけを保持する
+     * @details 最良の子個体と渡された子個体を交換するので、変更履歴の領域は2つだけで済む。
+     */
+    template <typename Child, typename Context>
+    class BestChildSelector {
+    public:
+        /**
+         * @brief 最良の子個体を1つだけ選ぶ (single_best_child_handler を参照)
+         */
+        static constexpr bool selects_single_best = true;
+
+        BestChildSelector(NagataGenerationChangeModel& model, Context& context, Child& best_child)
+            : model(model), context(context), best_child(best_child) {}
+
+        void operator()(Child& child) {
+            double fitness = model.fitness_func(child, context);
+            if (!has_child || fitness > best_fitness) {
+                best_fitness = fitness;
+                std::swap(best_child, child);
+                has_child = true;
+            }
+        }
+
+        /**
+         * @brief 距離の変化量が delta_distance_lower_bound 以上の子個体が、保持している子個体に勝てないかを判定する
+         * @details 適応度が同じ場合は先に生成された子個体が選ばれるので、上界が最良の適応度以下なら勝てない
+         */
+        bool cannot_improve(int64_t delta_distance_lower_bound) const
+            requires (!std::same_as<FitnessBoundFunc, NoFitnessBound>) {
+            return has_child && !(model.fitness_upper_bound(delta_distance_lower_bound, context) > best_fitness);
+        }
+
+        bool has_selected() const {
+            return has_child;
+        }
+
+        double get_best_fitness() const {
+            return best_fitness;
+        }
+    private:
+        NagataGenerationChangeModel& model;
+        Context& context;
+        Child& best_child;
+        double best_fitness = 0.0;
+        bool has_child = false;
+    };
+
+    /**
+     * @brief 親Aと親Bの組ごとに子個体を生成し、生成されるたびに評価して最良の子個体だけを保持する
+     * @details
+     *  選ばれる個体は materializing_step と同じ (適応度が同じなら先に生成された子個体、親Aは最後の候補)。
+     */
+    template <typename Individual, typename Context>
+    void streaming_step(std::vector<Individual>& population, Context& context)
+    {
+        using Child = typename Individual::DeltaType;
+        size_t population_size = population.size();
+
+        if (population_size < 2) {
+            return; // 集団サイズが2未満の場合は何もしない
+        }
+
+        std::vector<size_t> indices(population_size);
+        std::iota(indices.begin(), indices.end(), 0);
+        std::shuffle(indices.begin(), indices.end(), context.random_gen);
+
+        for (size_t i = 0; i < population_size; ++i) {
+            size_t parent_A_index = indices[i];
+            size_t parent_B_index = indices[(i + 1) % population_size];
+            Individual& parent_A = population[parent_A_index];
+            Individual& parent_B = population[parent_B_index];
+
+            if (is_identical_pair(parent_A, parent_B)) {
+                continue; // 同じ巡回路どうしでは子供が生成されないのでスキップ
+            }
+
+            Child best_child(parent_A);
+            BestChildSelector<Child, Context> selector(*this, context, best_child);
+            cross_over(parent_A, parent_B, context, selector);
+
+            if (!selector.has_selected()) {
+                continue; // 子供が生成されなかった場合はスキップ
+            }
+
+            // 子供and親Aの中で最良の個体を選択
+            Child parent_A_itself(parent_A);
+            if (fitness_func(parent_A_itself, context) > selector.get_best_fitness()) {
+                parent_A = std::move(parent_A_itself);
+            } else {
+                parent_A = std::move(best_child);
+            }
+        }
+    }
+
+    template <typename Individual, typename Context>
+    void materializing_step(std::vector<Individual>& population, Context& context)
     {
         using Child = std::invoke_result_t<CrossOverFunc, Individual&, Individual&, Context&>::value_type;
         auto calc_all_fitness = [](const std::vector<Child>& children, Context& context, FitnessFunc& fitness_func) {
@@ -59,6 +226,11 @@ public:
             size_t parent_B_index = indices[(i + 1) % population_size];
             Individual& parent_A = population[parent_A_index];
             Individual& parent_B = population[parent_B_index];
+
+            if (is_identical_pair(parent_A, parent_B)) {
+                continue; // 同じ巡回路どうしでは子供が生成されないのでスキップ
+            }
+
             std::vector<Child> children = cross_over(parent_A, parent_B, context);
 
             if (children.empty()) {
@@ -83,9 +255,11 @@ public:
         }
 
     }
-private:
+
     FitnessFunc fitness_func;
     CrossOverFunc cross_over;
+    [[no_unique_address]] FitnessBoundFunc fitness_upper_bound;
+    size_t identical_parent_pair_count = 0;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "shared_array.hpp"
+
+namespace tsp {
+    /**
+     * @brief 各都市の近傍都市を距離の近い順に保持する近傍リスト
+     * @details
+     *  全都市の行を1本の配列に格納し、近傍都市とその距離を交互に並べて保持する。
+     *  すべての行は同じ長さ (width) を持つ。
+     *  list[i][j] で都市iのj番目に近い都市を、list[i].distance(j) でその距離を取得できる。
+     */
+    class NeighborList {
+    public:
+        /**
+         * @brief 近傍都市とその距離 (8バイト。全都市を保持する近傍リストは都市数の2乗に比例するため狭い型で持つ)
+         */
+        struct Entry {
+            uint32_t city;
+            int32_t distance;
+        };
+
+        /**
+         * @brief 都市番号と距離から要素を作る
+         * @throws std::overflow_error 都市番号が32ビットに、距離が int32_t に収まらない場合
+         */
+        static Entry make_entry(size_t city, int64_t distance) {
+            if (city > std::numeric_limits<uint32_t>::max()
+                || distance < std::numeric_limits<int32_t>::min() || distance > std::numeric_limits<int32_t>::max()) {
+                throw std::overflow_error("Neighbor list entry out of range (city " + std::to_string(city) + ", distance " + std::to_string(distance) + ").");
+            }
+            return {static_cast<uint32_t>(city), static_cast<int32_t>(distance)};
+        }
+
+        /**
+         * @brief 1都市分の近傍リストへのビュー
+         */
+        class Row {
+        public:
+            size_t operator[](size_t j) const {
+                return entries[j].city;
+            }
+
+            int64_t distance(size_t j) const {
+                return entries[j].distance;
+            }
+
+            size_t size() const {
+                return width;
+            }
+
+            const Entry* begin() const {
+                return entries;
+            }
+
+            const Entry* end() const {
+                return entries + width;
+            }
+        private:
+            friend class NeighborList;
+            Row(const Entry* entries, size_t width) : entries(entries), width(width) {}
+            const Entry* entries;
+            size_t width;
+        };
+
+        NeighborList() = default;
+
+        /**
+         * @brief 指定した都市数と行の長さで近傍リストを確保する
+         * @param city_count 都市数
+         * @param width 1都市あたりの近傍都市の数
+         */
+        NeighborList(size_t city_count, size_t width)
+            : city_count(city_count), row_width(width), entries(city_count * width) {}
+
+        /**
+         * @brief 既存の配列から近傍リストを構築する
+         * @param city_count 都市数
+         * @param width 1都市あたりの近傍都市の数
+         * @param entries 全都市の行を並べた配列 (要素数は city_count * width)
+         */
+        NeighborList(size_t city_count, size_t width, SharedArray<Entry> entries)
+            : city_count(city_count), row_width(width), entries(std::move(entries)) {}
+
+        Row operator[](size_t i) const {
+            return Row(entries.data() + i * row_width, row_width);
+        }
+
+        /**
+         * @brief 都市iの行の先頭を取得する (構築用)
+         */
+        Entry* row_data(size_t i) {
+            return entries.mutable_data() + i * row_width;
+        }
+
+        const SharedArray<Entry>& data() const {
+            return entries;
+        }
+
+        size_t size() const {
+            return city_count;
+        }
+
+        /**
+         * @brief 1都市あたりの近傍都市の数
+         */
+        size_t width() const {
+            return row_width;
+        }
+
+        /**
+         * @brief 全都市を近傍として保持しているかどうか
+         */
+        bool is_complete() const {
+            return city_count == 0 || row_width + 1 >= city_count;
+        }
+
+    private:
+        size_t city_count = 0;
+        size_t row_width = 0;
+        SharedArray<Entry> entries;
+    };
+
+    using NN_list_t = NeighborList;
+}
\ No newline at end of file
@@ -5,10 +5,13 @@
 
 #include "object_pool.hpp"
 #include "limited_range_integer_set.hpp"
+#include "epoch_stamped_array.hpp"
 
 #include "eaxdef.hpp"
 #include "intermediate_individual.hpp"
 #include "subtour_list.hpp"
+#include "ab_cycle_set.hpp"
+#include "e_set_hash_set.hpp"
 
 namespace eax {
 /**
@@ -24,6 +27,9 @@ struct ObjectPools {
     mpi::ObjectPool<std::vector<std::tuple<size_t, size_t, size_t>>> cut_positions_pool;
     mpi::ObjectPool<SubtourList> subtour_list_pool;
     mpi::ObjectPool<std::vector<std::vector<size_t>>> any_size_2d_vector_pool;
+    mpi::ObjectPool<mpi::EpochStampedArray<size_t>> stamped_array_of_tsp_size_pool;
+    mpi::ObjectPool<ABCycleSet> AB_cycle_set_pool;
+    mpi::ObjectPool<ESetHashSet> e_set_hash_set_pool;
     
     ObjectPools(size_t city_size)
         : vector_of_tsp_size_pool([city_size]() {
@@ -52,6 +58,15 @@ struct ObjectPools {
         }),
           any_size_2d_vector_pool([]() {
             return new std::vector<std::vector<size_t>>();
+        }),
+          stamped_array_of_tsp_size_pool([city_size]() {
+            return new mpi::EpochStampedArray<size_t>(city_size);
+        }),
+          AB_cycle_set_pool([]() {
+            return new ABCycleSet();
+        }),
+          e_set_hash_set_pool([]() {
+            return new ESetHashSet();
         }) {}
 };
 }
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "population_cache.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+
+#include "mapped_file.hpp"
+#include "tsp_binary_format.hpp"
+
+namespace tsp {
+namespace binary {
+    namespace {
+        constexpr std::array<char, 8> POPULATION_MAGIC = {'E', 'A', 'X', 'P', 'O', 'P', 'B', '\0'};
+
+        /**
+         * @brief ファイル先頭のヘッダ (ネイティブのエンディアンで保存する)
+         */
+        struct PopulationHeader {
+            std::array<char, 8> magic;
+            uint32_t version;
+            uint32_t city_index_size;
+            uint64_t instance_hash;
+            uint64_t seed;
+            uint64_t population_size;
+            uint64_t city_count;
+        };
+
+        using CityIndex = uint32_t;
+    }
+
+    uint64_t fingerprint_instance(const TSP& tsp) {
+        uint64_t hash = hash_bytes(tsp.name.data(), tsp.name.size());
+        hash = hash_bytes(tsp.distance_type.data(), tsp.distance_type.size(), hash);
+        const uint64_t city_count = tsp.city_count;
+        hash = hash_bytes(&city_count, sizeof(city_count), hash);
+        if (tsp.distance_oracle.has_coordinates()) {
+            const Coordinates& coordinates = tsp.distance_oracle.coordinates();
+            hash = hash_bytes(coordinates.x.data(), coordinates.x.size() * sizeof(double), hash);
+            hash = hash_bytes(coordinates.y.data(), coordinates.y.size() * sizeof(double), hash);
+        } else {
+            std::visit([&hash](const auto& matrix) {
+                if constexpr (!std::is_same_v<std::remove_cvref_t<decltype(matrix)>, std::monostate>) {
+                    hash = hash_bytes(matrix.data().data(), matrix.data().size_bytes(), hash);
+                }
+            }, tsp.distance_matrix);
+        }
+        return hash;
+    }
+
+    std::optional<std::vector<std::vector<size_t>>> load_population(const std::string& cache_file, const PopulationKey& key) {
+        if (!std::filesystem::exists(cache_file)) {
+            return std::nullopt;
+        }
+
+        std::optional<MappedFile> file;
+        try {
+            file.emplace(cache_file);
+        } catch (const std::runtime_error&) {
+            return std::nullopt;
+        }
+
+        if (file->size() < sizeof(PopulationHeader)) {
+            return std::nullopt;
+        }
+        PopulationHeader header;
+        std::memcpy(&header, file->data(), sizeof(PopulationHeader));
+        if (header.magic != POPULATION_MAGIC
+            || header.version != POPULATION_FORMAT_VERSION
+            || header.city_index_size != sizeof(CityIndex)
+            || PopulationKey{header.instance_hash, header.seed, header.population_size, header.city_count} != key) {
+            return std::nullopt;
+        }
+
+        // 途中で切れたファイルは大きさが一致しない
+        const size_t city_count = key.city_count;
+        const size_t tours_size = key.population_size * city_count * sizeof(CityIndex);
+        if (file->size() != sizeof(PopulationHeader) + tours_size + sizeof(uint64_t)) {
+            return std::nullopt;
+        }
+        uint64_t checksum;
+        std::memcpy(&checksum, file->data() + sizeof(PopulationHeader) + tours_size, sizeof(checksum));
+        if (hash_bytes(file->data(), sizeof(PopulationHeader) + tours_size) != checksum) {
+            return std::nullopt;
+        }
+
+        std::vector<std::vector<size_t>> population(key.population_size);
+        const std::byte* tours = file->data() + sizeof(PopulationHeader);
+        std::vector<CityIndex> buffer(city_count);
+        for (size_t i = 0; i < population.size(); ++i) {
+            std::memcpy(buffer.data(), tours + i * city_count * sizeof(CityIndex), city_count * sizeof(CityIndex));
+            auto& cities = population[i];
+            cities.resize(city_count);
+            for (size_t j = 0; j < city_count; ++j) {
+                if (buffer[j] >= city_count) {
+                    return std::nullopt;
+                }
+                cities[j] = buffer[j];
+            }
+        }
+        return population;
+    }
+
+    void save_population(const std::vector<std::vector<size_t>>& population, const std::string& cache_file, const PopulationKey& key) {
+        if (key.city_count > std::numeric_limits<CityIndex>::max()) {
+            throw std::runtime_error("Too many cities for the population cache: " + std::to_string(key.city_count));
+        }
+
+        PopulationHeader header{};
+        header.magic = POPULATION_MAGIC;
+        header.version = POPULATION_FORMAT_VERSION;
+        header.city_index_size = sizeof(CityIndex);
+        header.instance_hash = key.instance_hash;
+        header.seed = key.seed;
+        header.population_size = key.population_size;
+        header.city_count = key.city_count;
+
+        const std::string temp_file = temporary_file_name(cache_file);
+        {
+            std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not open the file: " + temp_file);
+            }
+
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            uint64_t checksum = hash_bytes(&header, sizeof(header));
+
+            std::vector<CityIndex> buffer(key.city_count);
+            bool valid = population.size() == key.population_size;
+            for (const auto& cities : population) {
+                if (cities.size() != key.city_count) {
+                    valid = false;
+                    break;
+                }
+                for (size_t j = 0; j < cities.size(); ++j) {
+                    buffer[j] = static_cast<CityIndex>(cities[j]);
+                }
+                out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(CityIndex));
+                checksum = hash_bytes(buffer.data(), buffer.size() * sizeof(CityIndex), checksum);
+            }
+            out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+            if (!valid || !out) {
+                out.close();
+                std::filesystem::remove(temp_file);
+                throw std::runtime_error(valid ? "Failed to write the file: " + temp_file
+                                               : "The population does not match the cache header: " + cache_file);
+            }
+        }
+        std::filesystem::rename(temp_file, cache_file);
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+#include "tsp_loader.hpp"
+
+namespace tsp {
+namespace binary {
+    /**
+     * @brief 初期集団のバイナリ形式のバージョン (レイアウトを変更したら更新する)
+     */
+    constexpr uint32_t POPULATION_FORMAT_VERSION = 1;
+
+    /**
+     * @brief 初期集団のキャッシュが対象とする集団の情報
+     * @details 読み込んだファイルのヘッダがすべて一致しない場合は別の集団のキャッシュとみなす
+     */
+    struct PopulationKey {
+        /**
+         * @brief インスタンスの内容のハッシュ (fingerprint_instance、不明な場合は0)
+         */
+        uint64_t instance_hash = 0;
+        /**
+         * @brief 集団の生成に使った乱数シード
+         */
+        uint64_t seed = 0;
+        uint64_t population_size = 0;
+        uint64_t city_count = 0;
+
+        bool operator==(const PopulationKey&) const = default;
+    };
+
+    /**
+     * @brief インスタンスの内容のハッシュを計算する
+     * @details 名前、距離の種類、都市数と、座標 (座標がない場合は距離行列) からハッシュを計算する
+     * @param tsp TSPのインスタンス
+     * @return ハッシュ
+     */
+    uint64_t fingerprint_instance(const TSP& tsp);
+
+    /**
+     * @brief バイナリ形式の初期集団のキャッシュをメモリマップして読み込む
+     * @details
+     *  ファイルは先頭のヘッダ (PopulationKey)、都市番号を uint32 で並べた各巡回路、末尾のチェックサムからなる。
+     *  途中で切れたファイルやチェックサムの一致しないファイルは読み込まない。
+     * @param cache_file キャッシュファイル名
+     * @param key 読み込む集団の情報
+     * @return 初期集団 (ファイルが存在しない、壊れている、または key が一致しない場合は std::nullopt)
+     */
+    std::optional<std::vector<std::vector<size_t>>> load_population(const std::string& cache_file, const PopulationKey& key);
+
+    /**
+     * @brief 初期集団をバイナリ形式のキャッシュファイルに保存する
+     * @details 一時ファイルに書き込んでから置き換えるため、並行して読み込まれても書きかけのファイルは見えない
+     * @param population 初期集団 (各巡回路の長さは key.city_count であること)
+     * @param cache_file キャッシュファイル名
+     * @param key 保存する集団の情報
+     * @throws std::runtime_error 書き込みに失敗した場合、または都市番号が uint32 に収まらない場合
+     */
+    void save_population(const std::vector<std::vector<size_t>>& population, const std::string& cache_file, const PopulationKey& key);
+}
+}
\ No newline at end of file
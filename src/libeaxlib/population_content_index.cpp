@@ -0,0 +1,26 @@
+#include "population_content_index.hpp"
+
+#include <stdexcept>
+
+namespace eax {
+void PopulationContentIndex::add(uint64_t content_hash) {
+    ++counts[content_hash];
+    ++individual_count;
+}
+
+void PopulationContentIndex::remove(uint64_t content_hash) {
+    auto it = counts.find(content_hash);
+    if (it == counts.end()) {
+        throw std::invalid_argument("PopulationContentIndex::remove: The content hash is not registered.");
+    }
+    if (--it->second == 0) {
+        counts.erase(it);
+    }
+    --individual_count;
+}
+
+size_t PopulationContentIndex::count(uint64_t content_hash) const {
+    auto it = counts.find(content_hash);
+    return it == counts.end() ? 0 : it->second;
+}
+}
\ No newline at end of file
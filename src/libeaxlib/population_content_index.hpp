@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <unordered_map>
+
+#include "eaxdef.hpp"
+
+namespace eax {
+/**
+ * @brief 集団の個体の内容ハッシュごとの個体数を管理するクラス
+ * @details
+ *  内容ハッシュが同じ個体は同じ巡回路である (とみなす) ので、集団の重複個体の数を O(1) で参照できる。
+ *  個体を置き換えるときは remove() と add() で更新する。
+ */
+class PopulationContentIndex {
+public:
+    PopulationContentIndex() = default;
+
+    /**
+     * @brief 集団の全個体を登録する
+     * @param population 集団
+     */
+    template <std::ranges::range Population>
+        requires content_hash_readable<std::ranges::range_value_t<Population>>
+    PopulationContentIndex(const Population& population) {
+        for (const auto& individual : population) {
+            add(individual.get_content_hash());
+        }
+    }
+
+    /**
+     * @brief 内容ハッシュを1つ登録する
+     */
+    void add(uint64_t content_hash);
+
+    /**
+     * @brief 内容ハッシュを1つ取り除く
+     * @throws std::invalid_argument 登録されていない内容ハッシュの場合
+     */
+    void remove(uint64_t content_hash);
+
+    /**
+     * @brief 内容ハッシュが content_hash の個体の数を返す
+     */
+    size_t count(uint64_t content_hash) const;
+
+    /**
+     * @brief 他の個体と内容が重複している個体の数 (個体数 - 異なる内容の数) を返す
+     */
+    size_t duplicate_count() const {
+        return individual_count - counts.size();
+    }
+
+    /**
+     * @brief 異なる内容の数を返す
+     */
+    size_t distinct_count() const {
+        return counts.size();
+    }
+private:
+    std::unordered_map<uint64_t, size_t> counts;
+    size_t individual_count = 0;
+};
+}
\ No newline at end of file
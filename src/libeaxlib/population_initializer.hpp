@@ -7,67 +7,153 @@
 #include <fstream>
 #include <algorithm>
 #include <numeric>
+#include <filesystem>
+
+#include <optional>
 
 #include "utils.hpp"
+#include "parallel_for.hpp"
+#include "tour_constructor.hpp"
+#include "population_cache.hpp"
 
 namespace tsp {
     template <std::uniform_random_bit_generator RandomGen = std::mt19937>
     class PopulationInitializer {
         public:
+            /**
+             * @brief ランダムな順列から初期集団を生成する
+             * @param population_size 集団サイズ
+             * @param city_count 都市数
+             */
             PopulationInitializer(size_t population_size, size_t city_count)
                 : population_size_(population_size), city_count_(city_count) {}
+            /**
+             * @brief 指定した方法で構築した巡回路から初期集団を生成する
+             * @param population_size 集団サイズ
+             * @param tour_constructor 巡回路の構築方法 (Random の場合はランダムな順列と同じ)
+             */
+            PopulationInitializer(size_t population_size, TourConstructor tour_constructor)
+                : population_size_(population_size), city_count_(tour_constructor.city_count()),
+                  tour_constructor_(std::move(tour_constructor))
+            {
+                instance_hash_ = binary::fingerprint_instance(tour_constructor_->instance());
+            }
             ~PopulationInitializer() = default;
+
+            /**
+             * @brief 巡回路の構築と post_process に使うスレッド数を設定する (既定は1)
+             * @details
+             *  2以上 (または0) の場合、post_process は異なる個体について異なるスレッドから同時に呼び出されるので、
+             *  スレッド安全であること。各個体の乱数シードと初期巡回路は逐次に決めるので、生成される集団はスレッド数によらない。
+             * @param thread_count スレッド数 (0の場合はハードウェアのスレッド数)
+             */
+            void set_thread_count(size_t thread_count) {
+                thread_count_ = thread_count;
+            }
             
+            /**
+             * @brief 初期集団を生成する (キャッシュがあれば読み込む)
+             * @details
+             *  キャッシュは cache_file の拡張子を .bin に置き換えたバイナリ形式 (binary::load_population) で保存する。
+             *  バイナリ形式がなく、拡張子を .txt に置き換えた旧形式のテキストファイルがあればそれを読み込み、バイナリ形式に変換して保存する。
+             *  どちらのファイルも、途中で切れている場合や集団の情報が一致しない場合は使わずに集団を生成し直す。
+             * @param seed 乱数シード
+             * @param cache_file キャッシュファイル名
+             * @param post_process 生成した各巡回路に適用する関数 (2-optなど)
+             * @throws std::runtime_error キャッシュファイルに書き込めない場合
+             */
             template <typename PostProcessFunc = mpi::NOP_Function>
                 requires std::invocable<PostProcessFunc, std::vector<size_t>&>
             std::vector<std::vector<size_t>> initialize_population(RandomGen::result_type seed, std::string cache_file, PostProcessFunc&& post_process = {}) const
             {
+                const std::string binary_file = std::filesystem::path(cache_file).replace_extension(".bin").string();
+                const std::string text_file = std::filesystem::path(cache_file).replace_extension(".txt").string();
+                const binary::PopulationKey key = cache_key(seed);
+                if (auto cached = binary::load_population(binary_file, key)) {
+                    return std::move(*cached);
+                }
+                if (auto cached = load_text_cache(text_file)) {
+                    binary::save_population(*cached, binary_file, key);
+                    return std::move(*cached);
+                }
+
                 std::vector<std::vector<size_t>> population;
                 population.reserve(population_size_);
                 
-                std::ifstream cache(cache_file);
-                if (cache.is_open()) {
-                    for (size_t i = 0; i < population_size_; ++i) {
-                        std::vector<size_t> cities(city_count_);
-                        cities.clear();
-                        for (size_t j = 0; j < city_count_; ++j) {
-                            size_t city;
-                            cache >> city;
-                            cities.push_back(city);
-                        }
-                        population.emplace_back(std::move(cities));
-                    }
-                    cache.close();
-                    return population;
-                }
-                
                 RandomGen rng(seed);
                 
+                // 乱数の消費順を逐次生成と同じにするため、初期巡回路 (構築法を使う場合はそのシード) は逐次に決める
+                const bool uses_constructor = tour_constructor_ && tour_constructor_->get_type() != InitialTourType::Random;
+                population.resize(population_size_);
+                std::vector<typename RandomGen::result_type> construct_seeds;
                 for (size_t i = 0; i < population_size_; ++i) {
-                    std::vector<size_t> cities(city_count_);
-                    std::iota(cities.begin(), cities.end(), 0);
-                    std::shuffle(cities.begin(), cities.end(), rng);
-                    post_process(cities);
-                    population.emplace_back(std::move(cities));
+                    if (uses_constructor) {
+                        construct_seeds.push_back(rng());
+                    } else {
+                        auto& cities = population[i];
+                        cities.resize(city_count_);
+                        std::iota(cities.begin(), cities.end(), 0);
+                        std::shuffle(cities.begin(), cities.end(), rng);
+                    }
                 }
                 
-                std::ofstream out(cache_file);
-                if (out.is_open()) {
-                    for (const auto& cities : population) {
-                        for (const auto& city : cities) {
-                            out << city << " ";
-                        }
-                        out << std::endl;
+                mpi::parallel_for(0, population_size_, [&](size_t i) {
+                    if (uses_constructor) {
+                        // 2-optの前に貪欲法などで巡回路を構築しておく
+                        population[i] = tour_constructor_->construct(construct_seeds[i]);
                     }
-                    out.close();
-                } else {
-                    throw std::runtime_error(std::format("Failed to open cache file: {}", cache_file));
-                }
+                    post_process(population[i]);
+                }, thread_count_, 1);
+                
+                binary::save_population(population, binary_file, key);
                 
                 return population;
             }
+
+            /**
+             * @brief 指定したシードの集団の有効なバイナリ形式のキャッシュがすでにあるかどうか
+             * @param seed 乱数シード
+             * @param cache_file キャッシュファイル名 (initialize_population と同じ)
+             */
+            bool has_cache(RandomGen::result_type seed, const std::string& cache_file) const
+            {
+                const std::string binary_file = std::filesystem::path(cache_file).replace_extension(".bin").string();
+                return binary::load_population(binary_file, cache_key(seed)).has_value();
+            }
         private:
+            binary::PopulationKey cache_key(RandomGen::result_type seed) const
+            {
+                return {instance_hash_, static_cast<uint64_t>(seed), population_size_, city_count_};
+            }
+
+            /**
+             * @brief 旧形式 (空白区切りのテキスト) の初期集団のキャッシュを読み込む
+             * @return 初期集団 (ファイルが存在しない、または都市数に対して短い場合は std::nullopt)
+             */
+            std::optional<std::vector<std::vector<size_t>>> load_text_cache(const std::string& text_file) const
+            {
+                std::ifstream cache(text_file);
+                if (!cache.is_open()) {
+                    return std::nullopt;
+                }
+                std::vector<std::vector<size_t>> population(population_size_, std::vector<size_t>(city_count_));
+                for (auto& cities : population) {
+                    for (auto& city : cities) {
+                        if (!(cache >> city) || city >= city_count_) {
+                            return std::nullopt;
+                        }
+                    }
+                }
+                return population;
+            }
+
             size_t population_size_;
             size_t city_count_;
+            std::optional<TourConstructor> tour_constructor_;
+            size_t thread_count_ = 1;
+            /**
+             * @brief キャッシュのヘッダに記録するインスタンスのハッシュ (都市数だけを指定した場合は0)
+             */
+            uint64_t instance_hash_ = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace tsp {
+    /**
+     * @brief コピー間で共有される読み取り専用の配列
+     * @details
+     *  自身で確保したバッファか、メモリマップしたファイルなど外部の領域を参照する。
+     *  外部の領域は owner が生存している間有効である。
+     *  自身で確保したバッファだけが mutable_data() で書き換え可能で、これは構築時にのみ使用する。
+     * @tparam T 要素の型
+     */
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    class SharedArray {
+    public:
+        SharedArray() = default;
+
+        /**
+         * @brief 要素数 count のバッファを確保する
+         */
+        explicit SharedArray(size_t count, const T& value = T{})
+            : storage(std::make_shared<std::vector<T>>(count, value)),
+              owner(storage),
+              ptr(storage->data()),
+              count(count) {}
+
+        /**
+         * @brief 外部の領域を参照する
+         * @param owner 領域を生存させるオブジェクト
+         * @param data 領域の先頭
+         * @param count 要素数
+         */
+        SharedArray(std::shared_ptr<const void> owner, const T* data, size_t count)
+            : owner(std::move(owner)), ptr(data), count(count) {}
+
+        const T& operator[](size_t i) const {
+            return ptr[i];
+        }
+
+        const T* data() const {
+            return ptr;
+        }
+
+        /**
+         * @brief 書き換え可能な先頭ポインタを取得する (自身で確保したバッファのみ)
+         * @throws std::logic_error 外部の領域を参照している場合
+         */
+        T* mutable_data() {
+            if (!storage) {
+                throw std::logic_error("SharedArray: external storage is read-only");
+            }
+            return storage->data();
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        size_t size_bytes() const {
+            return count * sizeof(T);
+        }
+
+    private:
+        std::shared_ptr<std::vector<T>> storage;
+        std::shared_ptr<const void> owner;
+        const T* ptr = nullptr;
+        size_t count = 0;
+    };
+}
\ No newline at end of file
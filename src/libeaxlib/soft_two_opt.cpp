@@ -2,64 +2,124 @@
 
 #include <iostream>
 #include <chrono>
+#include <atomic>
+#include <algorithm>
 
 namespace {
-    void inversion(std::vector<size_t>& tour, std::vector<size_t>& pos, size_t left, size_t right) {
-        if(left <= right) {
-            for(size_t i = 0; i < (right - left + 1) / 2; ++i) {
-                std::swap(tour[left + i], tour[right - i]);
-                pos[tour[left + i]] = left + i;
-                pos[tour[right - i]] = right - i;
-            }
-        } else {
-            for(size_t i = 0; i < (tour.size() - (left - right) + 1) / 2; ++i) {
-                std::swap(tour[(left + i) % tour.size()], tour[(right - i + tour.size()) % tour.size()]);
-                pos[tour[(left + i) % tour.size()]] = (left + i) % tour.size();
-                pos[tour[(right - i + tour.size()) % tour.size()]] = (right - i + tour.size()) % tour.size();
-            }
+    /**
+     * @brief 位置 begin から end まで (巡回的、両端を含む) の区間を反転する
+     * @details 補集合の方が短い場合は補集合を反転する (巡回路としては同じになる)
+     */
+    void reverse_positions(std::vector<size_t>& tour, std::vector<uint32_t>& pos, size_t begin, size_t end) {
+        const size_t n = tour.size();
+        size_t length = (end + n - begin) % n + 1;
+        if (2 * length > n) {
+            const size_t complement_begin = (end + 1) % n;
+            end = (begin + n - 1) % n;
+            begin = complement_begin;
+            length = n - length;
+        }
+        for (size_t k = 0; k < length / 2; ++k) {
+            std::swap(tour[begin], tour[end]);
+            pos[tour[begin]] = static_cast<uint32_t>(begin);
+            pos[tour[end]] = static_cast<uint32_t>(end);
+            begin = begin + 1 == n ? 0 : begin + 1;
+            end = end == 0 ? n - 1 : end - 1;
         }
     }
 
+    template <tsp::distance_matrix_like Distance>
     void apply_soft_2opt(
-        std::vector<size_t>& path,
-        const tsp::adjacency_matrix_t& distance_matrix,
+        std::vector<size_t>& tour,
+        const std::vector<size_t>* active_cities,
+        const Distance& distance_matrix,
         const tsp::NN_list_t& nearest_neighbors,
-        size_t near_range
+        size_t near_range,
+        bool sorted_by_distance
     ) {
-        const size_t n = path.size();
-        std::vector<size_t> tour = path;
-        std::vector<size_t> pos(n);
+        const size_t n = tour.size();
+        if (n < 4) {
+            return;
+        }
+
+        // 作業領域はスレッドごとに使い回す
+        thread_local std::vector<uint32_t> pos;
+        thread_local std::vector<uint8_t> queued;
+        thread_local std::vector<size_t> queue;
+        pos.resize(n);
         for (size_t i = 0; i < n; ++i) {
-            pos[tour[i]] = i;
+            pos[tour[i]] = static_cast<uint32_t>(i);
         }
+        queued.assign(n, false);
+        queue.clear();
+        auto push = [](size_t city) {
+            if (!queued[city]) {
+                queued[city] = true;
+                queue.push_back(city);
+            }
+        };
+        if (active_cities != nullptr) {
+            for (size_t city : *active_cities) {
+                push(city);
+            }
+        } else {
+            for (size_t city : tour) {
+                push(city);
+            }
+        }
+
+        auto next = [&tour, n](size_t city) {
+            const size_t i = pos[city] + 1;
+            return tour[i == n ? 0 : i];
+        };
+        auto prev = [&tour, n](size_t city) {
+            const size_t i = pos[city];
+            return tour[i == 0 ? n - 1 : i - 1];
+        };
 
-        near_range = std::min(near_range, nearest_neighbors[0].size());
-
-        double improve = 1.;
-        while (improve > 0.) {
-            improve = 0.;
-            for(size_t i = 1; i < n; ++i) {
-                std::pair<size_t, size_t> swap_pos;
-                size_t u1 = tour[i];
-                size_t v1 = tour[(i + 1) % n];
-                for(size_t d = 0; d < near_range; ++d) {
-                    size_t u2 = tour[pos[nearest_neighbors[u1][d]]];
-                    size_t v2 = tour[(pos[nearest_neighbors[u1][d]] + 1) % n];
-                    if((distance_matrix[u1][v1] + distance_matrix[u2][v2]) - (distance_matrix[u1][u2] + distance_matrix[v1][v2]) > improve) {
-                        improve = (distance_matrix[u1][v1] + distance_matrix[u2][v2]) - (distance_matrix[u1][u2] + distance_matrix[v1][v2]);
-                        swap_pos = std::make_pair((i + 1) % n, pos[nearest_neighbors[u1][d]]);
+        // キューは先頭から順に取り出す (末尾に追加された都市は後で調べる)
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const size_t a = queue[head];
+            queued[a] = false;
+
+            bool improved = false;
+            for (bool forward : {true, false}) {
+                // forward: 辺 (a, next(a)) と (c, next(c)) を (a, c) と (b, d) に繋ぎ変える
+                // それ以外: 辺 (prev(a), a) と (prev(c), c) を (a, c) と (b, d) に繋ぎ変える
+                const size_t b = forward ? next(a) : prev(a);
+                const int64_t d_ab = distance_matrix[a][b];
+                for (size_t i = 0; i < near_range; ++i) {
+                    const size_t c = nearest_neighbors[a][i];
+                    const int64_t g1 = d_ab - distance_matrix[a][c];
+                    if (g1 <= 0) {
+                        if (sorted_by_distance) break;
+                        continue;
+                    }
+                    const size_t d = forward ? next(c) : prev(c);
+                    if (c == b || d == a) {
+                        continue;
+                    }
+                    if (g1 + distance_matrix[c][d] - distance_matrix[b][d] > 0) {
+                        if (forward) {
+                            reverse_positions(tour, pos, pos[b], pos[c]);
+                        } else {
+                            reverse_positions(tour, pos, pos[a], pos[d]);
+                        }
+                        push(a);
+                        push(b);
+                        push(c);
+                        push(d);
+                        improved = true;
+                        break;
                     }
                 }
-                if(swap_pos != std::pair<size_t, size_t>()) {
-                    inversion(tour, pos, swap_pos.first, swap_pos.second);
-                }
+                if (improved) break;
             }
         }
-        path = tour;
     }
 
-    double time_a = 0.0;
-    
+    std::atomic<double> time_a = 0.0;
+
 }
 
 namespace eax {
@@ -68,19 +128,41 @@ void print_soft_2opt_time() {
     std::cout << "Time: " << time_a << " seconds" << std::endl;
 }
 
-//TODO: SoftTwoOptの実装
-SoftTwoOpt::SoftTwoOpt(const tsp::adjacency_matrix_t& distance_matrix, const tsp::NN_list_t& nearest_neighbors, size_t near_range)
-    : distance_matrix(distance_matrix), nearest_neighbors(nearest_neighbors), near_range(near_range)
-{}
+SoftTwoOpt::SoftTwoOpt(tsp::DistanceView distance_matrix, const tsp::NN_list_t& nearest_neighbors, size_t near_range)
+    : distance_matrix(distance_matrix), nearest_neighbors(nearest_neighbors), near_range(std::min(near_range, nearest_neighbors.width()))
+{
+    for (size_t i = 0; i < nearest_neighbors.size() && sorted_by_distance; ++i) {
+        const auto neighbors = nearest_neighbors[i];
+        for (size_t j = 1; j < this->near_range; ++j) {
+            if (neighbors.distance(j) < neighbors.distance(j - 1)) {
+                sorted_by_distance = false;
+                break;
+            }
+        }
+    }
+}
 
-void SoftTwoOpt::apply(std::vector<size_t>& path)
+void SoftTwoOpt::apply(std::vector<size_t>& path) const
 {
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    apply_soft_2opt(path, distance_matrix, nearest_neighbors, near_range);
+    distance_matrix.visit([&](const auto& distance) {
+        apply_soft_2opt(path, nullptr, distance, nearest_neighbors, near_range, sorted_by_distance);
+    });
 
     auto end_time = std::chrono::high_resolution_clock::now();
     time_a += std::chrono::duration<double>(end_time - start_time).count();
 }
 
+void SoftTwoOpt::apply(std::vector<size_t>& path, const std::vector<size_t>& active_cities) const
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    distance_matrix.visit([&](const auto& distance) {
+        apply_soft_2opt(path, &active_cities, distance, nearest_neighbors, near_range, sorted_by_distance);
+    });
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    time_a += std::chrono::duration<double>(end_time - start_time).count();
+}
 }
\ No newline at end of file
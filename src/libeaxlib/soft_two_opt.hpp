@@ -7,19 +7,50 @@
 
 namespace eax {
 
-// TODO: SoftTwoOptクラスをここに追加
-// 旧eaxのtwo_optをベースに実装
+/**
+ * @brief 配列で表した巡回路に対する軽量な2-opt局所探索
+ * @details
+ *  巡回路のベクターと各都市の位置の配列を直接書き換え、反転は区間とその補集合のうち短い方に対して行う。
+ *  改善の候補は近傍リストの先頭 near_range 都市に限り、最初に見つかった改善を適用する (first improvement)。
+ *  don't-look bit の代わりに調べ直す都市のキューを持ち、改善した辺の端点だけをキューに戻す。
+ *  交叉で変わった辺の端点だけを指定すれば、子個体の仕上げとして巡回路の一部だけを調べられる。
+ *  作業領域はスレッドごとに確保するので、複数のスレッドから同時に呼び出せる。
+ */
 class SoftTwoOpt {
 public:
-    SoftTwoOpt(const tsp::adjacency_matrix_t& distance_matrix,
+    /**
+     * @brief 指定した距離と近傍リストで初期化する
+     * @param distance_matrix 距離 (距離行列または距離オラクルへのビュー。参照先はSoftTwoOptより長く生存すること)
+     * @param nearest_neighbors 近傍リスト (要素は共有され、コピーされない)
+     * @param near_range 近傍範囲
+     */
+    SoftTwoOpt(tsp::DistanceView distance_matrix,
                 const tsp::NN_list_t& nearest_neighbors,
                 size_t near_range = 20);
-    
-    void apply(std::vector<size_t>& path);
+
+    /**
+     * @brief すべての都市を起点として2-optを適用する
+     * @param path 巡回路を表す頂点のベクター (その場で書き換える)
+     */
+    void apply(std::vector<size_t>& path) const;
+
+    /**
+     * @brief 指定した都市だけを起点として2-optを適用する
+     * @details 改善した場合は、変更した辺の端点も起点として調べ直す
+     * @param path 巡回路を表す頂点のベクター (その場で書き換える)
+     * @param active_cities 起点とする都市 (交叉で変わった辺の端点など)
+     */
+    void apply(std::vector<size_t>& path, const std::vector<size_t>& active_cities) const;
 
 private:
-    tsp::adjacency_matrix_t distance_matrix;
+    tsp::DistanceView distance_matrix;
     tsp::NN_list_t nearest_neighbors;
     const size_t near_range;
+    /**
+     * @brief 近傍範囲内の近傍都市が距離の近い順に並んでいるかどうか (TwoOpt と同じ)
+     */
+    bool sorted_by_distance = true;
 };
+
+void print_soft_2opt_time();
 }
\ No newline at end of file
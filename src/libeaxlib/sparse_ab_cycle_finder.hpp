@@ -0,0 +1,204 @@
+#pragma once
+
+#include <random>
+#include <limits>
+#include <cstdint>
+
+#include "object_pool.hpp"
+
+#include "eaxdef.hpp"
+#include "object_pools.hpp"
+#include "ab_cycle_finder.hpp"
+
+namespace eax {
+
+/**
+ * @brief 親間で異なる枝だけからなる疎なグラフでABサイクルを見つける関数オブジェクトのクラス
+ * @details
+ *  親の隣接関係を1回だけ読み、一方の親にしかない枝を持つ都市を取り出して局所的な番号を振る。
+ *  以降の探索は取り出した都市と枝だけで行うので、親のコピーや都市数の大きさの集合の初期化は行わず、
+ *  探索の計算量は親間で異なる枝の数に比例する。
+ *  共通の枝は最初から除くため、ABCycleFinder のように共通の枝を往復するだけの長さ2のサイクルは生じない。
+ *  見つかるABサイクルの分布は ABCycleFinder とは異なるが、すべてのABサイクルを見つけることは保証される。
+ */
+class SparseABCycleFinder {
+public:
+    SparseABCycleFinder(ObjectPools& object_pools)
+        : AB_cycle_set_pool(object_pools.AB_cycle_set_pool.share()) {}
+
+    SparseABCycleFinder(mpi::ObjectPool<ABCycleSet> AB_cycle_set_pool)
+        : AB_cycle_set_pool(std::move(AB_cycle_set_pool)) {}
+
+    /**
+     * @brief ABサイクルを見つける
+     * @param needs 必要なABサイクルの数
+     * @param parent1 親個体1
+     * @param parent2 親個体2
+     * @param rng 乱数生成器
+     * @return 見つけたABサイクルの集まり (各サイクルは親1の枝から始まる)
+     * @tparam Individual 親個体の型
+     */
+    template <individual_readable Individual>
+    ABCycleSetPtr operator()(size_t needs,
+            const Individual& parent1,
+            const Individual& parent2,
+            std::mt19937& rng)
+    {
+        using namespace std;
+        extract_different_edges(parent1, parent2);
+
+        auto AB_cycles_ptr = AB_cycle_set_pool.acquire_unique();
+        ABCycleSet& AB_cycles = *AB_cycles_ptr;
+        AB_cycles.clear();
+        uniform_int_distribution<size_t> dist_01(0, 1);
+        path.clear();
+
+        // path[k] から path[k + 1] へは、k が偶数なら親1の枝、奇数なら親2の枝でたどる
+        while (AB_cycles.size() < needs) {
+            if (path.empty()) {
+                if (alive.empty()) {
+                    break;
+                }
+                const uint32_t start = alive[uniform_int_distribution<size_t>(0, alive.size() - 1)(rng)];
+                vertices[start].position[0] = 0;
+                path.push_back(start);
+            }
+
+            const size_t k = path.size() - 1;
+            const size_t parent = k % 2;
+            const uint32_t current = path.back();
+            Vertex& current_vertex = vertices[current];
+            if (current_vertex.degree[parent] == 0) {
+                // 経路の途中では必ず次の枝が残っているので、ここに来るのは開始都市の枝を使い切った場合だけ
+                path.clear();
+                continue;
+            }
+            const size_t choice = current_vertex.degree[parent] == 2 ? dist_01(rng) : 0;
+            const uint32_t next = current_vertex.edges[parent][choice];
+            remove_edge(current, next, parent);
+
+            const size_t parity = (k + 1) % 2;
+            const uint32_t j = vertices[next].position[parity];
+            if (j < path.size() && path[j] == next) {
+                // path[j] から path[k] を経て path[j] に戻る交互閉路ができた
+                // 親1の枝から始まるように並べる
+                const size_t first = j % 2 == 0 ? j : j + 1;
+                for (size_t i = first; i <= k; ++i) {
+                    AB_cycles.push_vertex(vertices[path[i]].city);
+                }
+                if (first != j) {
+                    AB_cycles.push_vertex(vertices[path[j]].city);
+                }
+                AB_cycles.close_cycle();
+                path.resize(j + 1);
+            } else {
+                vertices[next].position[parity] = static_cast<uint32_t>(path.size());
+                path.push_back(next);
+            }
+        }
+
+        return AB_cycles_ptr;
+    }
+
+    using completeness_category = complete_ABCycleFinder_tag;
+private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief 親間で異なる枝を持つ都市
+     */
+    struct Vertex {
+        size_t city;
+        /**
+         * @brief edges[p] の先頭 degree[p] 個が、親 p にしかない枝のうち未使用の枝の相手 (局所番号)
+         */
+        std::array<std::array<uint32_t, 2>, 2> edges;
+        std::array<uint8_t, 2> degree;
+        /**
+         * @brief 探索中の経路上の位置 (位置の偶奇ごと)
+         */
+        std::array<uint32_t, 2> position;
+        /**
+         * @brief alive の中での位置
+         */
+        uint32_t alive_index;
+    };
+
+    /**
+     * @brief 親間で異なる枝を取り出し、局所番号の隣接関係を構築する
+     */
+    template <individual_readable Individual>
+    void extract_different_edges(const Individual& parent1, const Individual& parent2) {
+        const size_t city_count = parent1.size();
+        if (local_index.size() != city_count) {
+            local_index.assign(city_count, NONE);
+        }
+
+        // 枝 (city, neighbor) が other にないかどうか
+        auto is_unique = [](const auto& other, size_t city, size_t neighbor) {
+            return other[city][0] != neighbor && other[city][1] != neighbor;
+        };
+
+        vertices.clear();
+        for (size_t city = 0; city < city_count; ++city) {
+            if (is_unique(parent2, city, parent1[city][0]) || is_unique(parent2, city, parent1[city][1])) {
+                local_index[city] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(Vertex{city, {}, {0, 0}, {NONE, NONE}, 0});
+            }
+        }
+
+        alive.clear();
+        for (uint32_t i = 0; i < vertices.size(); ++i) {
+            Vertex& vertex = vertices[i];
+            for (size_t e = 0; e < 2; ++e) {
+                const size_t a = parent1[vertex.city][e];
+                if (is_unique(parent2, vertex.city, a)) {
+                    vertex.edges[0][vertex.degree[0]++] = local_index[a];
+                }
+                const size_t b = parent2[vertex.city][e];
+                if (is_unique(parent1, vertex.city, b)) {
+                    vertex.edges[1][vertex.degree[1]++] = local_index[b];
+                }
+            }
+            vertex.alive_index = static_cast<uint32_t>(alive.size());
+            alive.push_back(i);
+        }
+
+        // 次の呼び出しのために、書き込んだ要素だけを戻す
+        for (const Vertex& vertex : vertices) {
+            local_index[vertex.city] = NONE;
+        }
+    }
+
+    /**
+     * @brief 親 parent の枝 (u, v) を両端から取り除く
+     */
+    void remove_edge(uint32_t u, uint32_t v, size_t parent) {
+        for (uint32_t endpoint : {u, v}) {
+            Vertex& vertex = vertices[endpoint];
+            const uint32_t other = endpoint == u ? v : u;
+            auto& edges = vertex.edges[parent];
+            const size_t index = edges[0] == other ? 0 : 1;
+            edges[index] = edges[--vertex.degree[parent]];
+            if (vertex.degree[0] == 0 && vertex.degree[1] == 0) {
+                const uint32_t last = alive.back();
+                alive[vertex.alive_index] = last;
+                vertices[last].alive_index = vertex.alive_index;
+                alive.pop_back();
+            }
+        }
+    }
+
+    mpi::ObjectPool<ABCycleSet> AB_cycle_set_pool;
+    /**
+     * @brief 都市から局所番号への対応 (呼び出しの間はすべて NONE)
+     */
+    std::vector<uint32_t> local_index;
+    std::vector<Vertex> vertices;
+    /**
+     * @brief 未使用の枝が残っている都市の局所番号
+     */
+    std::vector<uint32_t> alive;
+    std::vector<uint32_t> path;
+};
+}
\ No newline at end of file
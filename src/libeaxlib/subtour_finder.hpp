@@ -36,8 +36,8 @@ public:
      * @return 部分巡回路リストのポインタ
      */
     template <std::ranges::range ABCycles>
-        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, const ab_cycle_t&>
-    subtour_list_pooled_ptr operator()(const std::vector<size_t>& pos,
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, ab_cycle_view_t>
+    subtour_list_pooled_ptr operator()(const std::vector<city_index_t>& pos,
                                         const ABCycles& applied_ab_cycles) {
         auto subtour_list_ptr = subtour_list_pool.acquire_unique();
         SubtourList& subtour_list = *subtour_list_ptr;
@@ -59,8 +59,8 @@ public:
     }
 private:
     template <std::ranges::range ABCycles>
-        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, const eax::ab_cycle_t&>
-    static void set_cut_positions(const std::vector<size_t>& pos,
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, eax::ab_cycle_view_t>
+    static void set_cut_positions(const std::vector<city_index_t>& pos,
                             std::vector<std::tuple<size_t, size_t, size_t>>& cut_positions,
                             const ABCycles& AB_cycles) {
         cut_positions.clear();
@@ -88,7 +88,7 @@ private:
                 cut_positions.emplace_back(pos_ba, pos_b1, pos_b2);
             }
         };
-        for (const eax::ab_cycle_t& cycle : AB_cycles) {
+        for (const eax::ab_cycle_view_t cycle : AB_cycles) {
             for (size_t i = 2; i < cycle.size() - 2; i += 2) {
                 cut(cycle[i - 1], cycle[i], cycle[i + 1], cycle[i + 2]);
             }
@@ -28,27 +28,56 @@ public:
 
     /**
      * @brief 部分巡回路を統合する
+     * @tparam Distance 距離行列の型
      * @tparam ABCycles ABサイクル群の型
      * @param working_individual 作業中の中間個体
      * @param tsp TSPインスタンス
+     * @param adjacency_matrix tsp の距離 (tsp.distance().visit() で選んだ具体的な型)
      * @param applied_ab_cycles 適用したABサイクル群
      */
-    template <std::ranges::range ABCycles>
-        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, const ab_cycle_t&>
+    template <tsp::distance_matrix_like Distance, std::ranges::range ABCycles>
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, ab_cycle_view_t>
     void operator()(IntermediateIndividual& working_individual,
                                     const tsp::TSP& tsp,
+                                    const Distance& adjacency_matrix,
                                     const ABCycles& applied_ab_cycles) {
+        auto subtour_list_ptr = find_subtours(working_individual, applied_ab_cycles);
+        merge_subtours(working_individual, tsp, adjacency_matrix, *subtour_list_ptr);
+    }
+
+    /**
+     * @brief ABサイクル群を適用した中間個体の部分巡回路を求める
+     * @details merge_subtours() の前に部分巡回路の数を知りたい場合に、operator() の代わりに使う
+     * @tparam ABCycles ABサイクル群の型
+     * @param working_individual ABサイクル群を適用した中間個体
+     * @param applied_ab_cycles 適用したABサイクル群
+     * @return 部分巡回路リストのポインタ
+     */
+    template <std::ranges::range ABCycles>
+        requires std::convertible_to<std::ranges::range_value_t<ABCycles>, ab_cycle_view_t>
+    SubtourFinder::subtour_list_pooled_ptr find_subtours(const IntermediateIndividual& working_individual,
+                                                         const ABCycles& applied_ab_cycles) {
+        return subtour_finder(working_individual.get_pos(), applied_ab_cycles);
+    }
+
+    /**
+     * @brief find_subtours() で求めた部分巡回路を1つの巡回路に統合する
+     * @param working_individual 作業中の中間個体
+     * @param tsp TSPインスタンス
+     * @param adjacency_matrix tsp の距離 (tsp.distance().visit() で選んだ具体的な型)
+     * @param subtour_list 部分巡回路リスト (統合に合わせて更新される)
+     */
+    void merge_subtours(IntermediateIndividual& working_individual,
+                        const tsp::TSP& tsp,
+                        const tsp::distance_matrix_like auto& adjacency_matrix,
+                        SubtourList& subtour_list) {
 
-        auto& adjacency_matrix = tsp.adjacency_matrix;
         auto& NN_list = tsp.NN_list;
         auto& path = working_individual.get_path();
         auto& pos = working_individual.get_pos();
-                                    
-        auto subtour_list_ptr = subtour_finder(pos, applied_ab_cycles);
-        SubtourList& subtour_list = *subtour_list_ptr;
 
         using namespace std;
-        using distance_type = std::remove_cvref_t<decltype(adjacency_matrix)>::value_type::value_type;
+        using distance_type = int64_t;
         using edge = pair<size_t, size_t>;
 
         auto elem_of_min_sub_tour_ptr = any_size_vector_pool.acquire_unique();
@@ -83,39 +112,57 @@ public:
             edge e1 = {0, 0};
             edge e2 = {0, 0};
             distance_type min_cost = std::numeric_limits<distance_type>::max();
+
+            // 部分巡回路のi番目の都市と近傍都市をつなぎ替えるコストを評価する
+            auto evaluate = [&](size_t i, size_t neighbor_city, distance_type current_to_neighbor) {
+                size_t current_city = elem_of_min_sub_tour[i];
+                for (size_t k = 0; k < 2; ++k) {
+                    size_t connected_to_current_city = elem_of_min_sub_tour[i - 1 + 2 * k];
+                    const distance_type current_edge = adjacency_matrix[current_city][connected_to_current_city];
+                    for (size_t l = 0; l < 2; ++l) {
+                        size_t connected_to_neighbor_city = working_individual[neighbor_city][l];
+                        const distance_type removed = current_edge + adjacency_matrix[neighbor_city][connected_to_neighbor_city];
+
+                        distance_type cost = - removed + current_to_neighbor + adjacency_matrix[connected_to_current_city][connected_to_neighbor_city];
+                        
+                        if (cost < min_cost) {
+                            min_cost = cost;
+                            e1 = {current_city, connected_to_current_city};
+                            e2 = {neighbor_city, connected_to_neighbor_city};
+                        }
+                        
+                        cost = - removed + adjacency_matrix[current_city][connected_to_neighbor_city] + adjacency_matrix[connected_to_current_city][neighbor_city];
+
+                        if (cost < min_cost) {
+                            min_cost = cost;
+                            e1 = {current_city, connected_to_current_city};
+                            e2 = {connected_to_neighbor_city, neighbor_city};
+                        }
+                    }
+                }
+            };
+
             while (e1.first == 0 && e2.first == 0) {
+                if (start >= NN_list.width()) {
+                    // 近傍リストを使い切った場合は、部分巡回路外の最も近い都市を探索する
+                    for (size_t i = 1; i <= min_sub_tour_size; ++i) {
+                        size_t current_city = elem_of_min_sub_tour[i];
+                        size_t neighbor_city = tsp.nearest_outside(current_city, in_min_sub_tour);
+                        evaluate(i, neighbor_city, adjacency_matrix[current_city][neighbor_city]);
+                    }
+                    break;
+                }
+
                 for (size_t i = 1; i <= min_sub_tour_size; ++i) {
                     size_t current_city = elem_of_min_sub_tour[i];
-                    size_t limit = std::min(start + search_range, NN_list[current_city].size());
+                    const auto neighbors = NN_list[current_city];
+                    size_t limit = std::min(start + search_range, neighbors.size());
                     for (size_t j = start; j < limit; ++j) {
-                        size_t neighbor_city = NN_list[current_city][j];
+                        size_t neighbor_city = neighbors[j];
                         if (in_min_sub_tour[neighbor_city])
                             continue;
 
-                        for (size_t k = 0; k < 2; ++k) {
-                            size_t connected_to_current_city = elem_of_min_sub_tour[i - 1 + 2 * k];
-                            for (size_t l = 0; l < 2; ++l) {
-                                size_t connected_to_neighbor_city = working_individual[neighbor_city][l];
-
-                                distance_type cost = - adjacency_matrix[current_city][connected_to_current_city] - adjacency_matrix[neighbor_city][connected_to_neighbor_city]
-                                                    + adjacency_matrix[current_city][neighbor_city] + adjacency_matrix[connected_to_current_city][connected_to_neighbor_city];
-                                
-                                if (cost < min_cost) {
-                                    min_cost = cost;
-                                    e1 = {current_city, connected_to_current_city};
-                                    e2 = {neighbor_city, connected_to_neighbor_city};
-                                }
-                                
-                                cost = - adjacency_matrix[current_city][connected_to_current_city] - adjacency_matrix[neighbor_city][connected_to_neighbor_city]
-                                    + adjacency_matrix[current_city][connected_to_neighbor_city] + adjacency_matrix[connected_to_current_city][neighbor_city];
-
-                                if (cost < min_cost) {
-                                    min_cost = cost;
-                                    e1 = {current_city, connected_to_current_city};
-                                    e2 = {connected_to_neighbor_city, neighbor_city};
-                                }
-                            }
-                        }
+                        evaluate(i, neighbor_city, neighbors.distance(j));
                     }
                 }
                 
@@ -4,9 +4,11 @@
 
 #include "object_pool.hpp"
 #include "limited_range_integer_set.hpp"
+#include "epoch_stamped_array.hpp"
 
 #include "eaxdef.hpp"
 #include "object_pools.hpp"
+#include "ab_cycle_set.hpp"
 
 namespace eax {
 
@@ -17,17 +19,20 @@ class TabuABCycleFinder {
 public:
     TabuABCycleFinder(ObjectPools& object_pools)
         : any_size_vector_pool(object_pools.any_size_vector_pool.share()),
-          vector_of_tsp_size_pool(object_pools.vector_of_tsp_size_pool.share()),
+          AB_cycle_set_pool(object_pools.AB_cycle_set_pool.share()),
+          stamped_array_of_tsp_size_pool(object_pools.stamped_array_of_tsp_size_pool.share()),
           doubly_linked_list_pool(object_pools.doubly_linked_list_pool.share()),
           LRIS_pool(object_pools.LRIS_pool.share()) {}
 
     TabuABCycleFinder(
         mpi::ObjectPool<std::vector<size_t>> any_size_vector_pool,
-        mpi::ObjectPool<std::vector<size_t>> vector_of_tsp_size_pool,
-        mpi::ObjectPool<std::vector<std::array<size_t, 2>>> doubly_linked_list_pool,
+        mpi::ObjectPool<ABCycleSet> AB_cycle_set_pool,
+        mpi::ObjectPool<mpi::EpochStampedArray<size_t>> stamped_array_of_tsp_size_pool,
+        mpi::ObjectPool<doubly_linked_list_t> doubly_linked_list_pool,
         mpi::ObjectPool<mpi::LimitedRangeIntegerSet> LRIS_pool)
         : any_size_vector_pool(std::move(any_size_vector_pool)),
-          vector_of_tsp_size_pool(std::move(vector_of_tsp_size_pool)),
+          AB_cycle_set_pool(std::move(AB_cycle_set_pool)),
+          stamped_array_of_tsp_size_pool(std::move(stamped_array_of_tsp_size_pool)),
           doubly_linked_list_pool(std::move(doubly_linked_list_pool)),
           LRIS_pool(std::move(LRIS_pool)) {}
 
@@ -38,9 +43,9 @@ public:
      * @param parent2 親個体2
      * @param rng 乱数生成器
      * @param tabu_edges タブーエッジの集合
-     * @return ABサイクルのポインタのベクター
+     * @return 見つけたABサイクルの集まり
      */
-    std::vector<mpi::pooled_unique_ptr<ab_cycle_t>> operator()(size_t needs,
+    mpi::pooled_unique_ptr<ABCycleSet> operator()(size_t needs,
             const doubly_linked_list_readable auto& parent1,
             const doubly_linked_list_readable auto& parent2,
             std::mt19937& rng,
@@ -51,10 +56,10 @@ public:
 
         auto parent1_tabu_ptr = doubly_linked_list_pool.acquire_unique();
         auto parent2_tabu_ptr = doubly_linked_list_pool.acquire_unique();
-        std::vector<std::array<size_t, 2>>& parent1_tabu = *parent1_tabu_ptr;
-        std::vector<std::array<size_t, 2>>& parent2_tabu = *parent2_tabu_ptr;
-        parent1_tabu.assign(city_count, {numeric_limits<size_t>::max(), numeric_limits<size_t>::max()});
-        parent2_tabu.assign(city_count, {numeric_limits<size_t>::max(), numeric_limits<size_t>::max()});
+        doubly_linked_list_t& parent1_tabu = *parent1_tabu_ptr;
+        doubly_linked_list_t& parent2_tabu = *parent2_tabu_ptr;
+        parent1_tabu.assign(city_count, {numeric_limits<city_index_t>::max(), numeric_limits<city_index_t>::max()});
+        parent2_tabu.assign(city_count, {numeric_limits<city_index_t>::max(), numeric_limits<city_index_t>::max()});
         for (const auto& [u, v] : tabu_edges) {
             // 親1のタブーエッジを設定
             if (parent1[u][0] == v) {
@@ -95,7 +100,7 @@ public:
         struct connections {
             // edge_pair[0]が least recently used edge
             // edge_pair[1]が最近通ったエッジ or すでにABサイクルを構成しているエッジ
-            std::array<size_t, 2>& edge_pair;
+            std::array<city_index_t, 2>& edge_pair;
             constexpr size_t least_recently_used_edge() const {
                 return edge_pair[0];
             }
@@ -122,15 +127,15 @@ public:
 
         auto parent1_copy_ptr = doubly_linked_list_pool.acquire_unique();
         auto parent2_copy_ptr = doubly_linked_list_pool.acquire_unique();
-        std::vector<std::array<size_t, 2>>& parent1_copy = *parent1_copy_ptr;
-        std::vector<std::array<size_t, 2>>& parent2_copy = *parent2_copy_ptr;
+        doubly_linked_list_t& parent1_copy = *parent1_copy_ptr;
+        doubly_linked_list_t& parent2_copy = *parent2_copy_ptr;
         for (size_t i = 0; i < city_count; ++i) {
             parent1_copy[i] = parent1[i];
             parent2_copy[i] = parent2[i];
         }
 
         struct parent {
-            std::vector<std::array<size_t, 2>>& parent;
+            doubly_linked_list_t& parent;
             constexpr connections operator[](size_t index) {
                 return connections{parent[index]};
             }
@@ -144,14 +149,16 @@ public:
             }
         } parents = {{parent1_copy}, {parent2_copy}};
 
-        vector<mpi::pooled_unique_ptr<ab_cycle_t>> AB_cycles;
+        auto AB_cycles_ptr = AB_cycle_set_pool.acquire_unique();
+        ABCycleSet& AB_cycles = *AB_cycles_ptr;
+        AB_cycles.clear();
 
         auto visited_ptr = any_size_vector_pool.acquire_unique();
-        auto first_visited_ptr = vector_of_tsp_size_pool.acquire_unique();
+        auto first_visited_ptr = stamped_array_of_tsp_size_pool.acquire_unique();
         std::vector<size_t>& visited = *visited_ptr;
-        std::vector<size_t>& first_visited = *first_visited_ptr;
+        mpi::EpochStampedArray<size_t>& first_visited = *first_visited_ptr;
         visited.clear();
-        first_visited.assign(city_count, 0);
+        first_visited.reset(city_count, 0);
 
         // numeric_limits<size_t>::max() は、 cities_having_2_edges と
         // cities_having_just_1_edge のどちらにも含まれないので、
@@ -173,13 +180,10 @@ public:
                 first_visited[current_city] = 0;
             }
 
-            auto cycle = find_AB_cycle_phase1(current_city, visited, first_visited, cities_having_2_edges, cities_having_just_1_edge, rng, parents);
+            find_AB_cycle_phase1(current_city, visited, first_visited, cities_having_2_edges, cities_having_just_1_edge, rng, parents, AB_cycles);
 
-            if (cycle->size() > 2 && !contains_tabu_edge(*cycle, parent1_tabu, parent2_tabu)) {
-                AB_cycles.emplace_back(std::move(cycle));
-                if (AB_cycles.size() >= needs) {
-                    return AB_cycles; // 必要な数のABサイクルが見つかった
-                }
+            if (close_AB_cycle_if_allowed(AB_cycles, parent1_tabu, parent2_tabu) && AB_cycles.size() >= needs) {
+                return AB_cycles_ptr; // 必要な数のABサイクルが見つかった
             }
         }
 
@@ -201,34 +205,33 @@ public:
                 current_city = next_city;
             }
 
-            auto cycle = create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge);
-            if (cycle->size() > 2 && !contains_tabu_edge(*cycle, parent1_tabu, parent2_tabu)) {
-                AB_cycles.emplace_back(std::move(cycle));
-                if (AB_cycles.size() >= needs) {
-                    return AB_cycles; // 必要な数のABサイクルが見つかった
-                }
+            create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+            if (close_AB_cycle_if_allowed(AB_cycles, parent1_tabu, parent2_tabu) && AB_cycles.size() >= needs) {
+                return AB_cycles_ptr; // 必要な数のABサイクルが見つかった
             }
 
         }
 
-        return AB_cycles;
+        return AB_cycles_ptr;
 
     }
 
     using completeness_category = incomplete_ABCycleFinder_tag;
 private:
     mpi::ObjectPool<std::vector<size_t>> any_size_vector_pool;
-    mpi::ObjectPool<std::vector<size_t>> vector_of_tsp_size_pool;
-    mpi::ObjectPool<std::vector<std::array<size_t, 2>>> doubly_linked_list_pool;
+    mpi::ObjectPool<ABCycleSet> AB_cycle_set_pool;
+    mpi::ObjectPool<mpi::EpochStampedArray<size_t>> stamped_array_of_tsp_size_pool;
+    mpi::ObjectPool<doubly_linked_list_t> doubly_linked_list_pool;
     mpi::ObjectPool<mpi::LimitedRangeIntegerSet> LRIS_pool;
 
-    mpi::pooled_unique_ptr<ab_cycle_t> find_AB_cycle_phase1(size_t& current_city,
+    void find_AB_cycle_phase1(size_t& current_city,
             std::vector<size_t>& visited,
-            std::vector<size_t>& first_visited,
+            mpi::EpochStampedArray<size_t>& first_visited,
             mpi::LimitedRangeIntegerSet& cities_having_2_edges,
             mpi::LimitedRangeIntegerSet& cities_having_just_1_edge,
             std::mt19937& rng,
-            auto& parents) {
+            auto& parents,
+            ABCycleSet& AB_cycles) {
         
         using namespace std;
         uniform_int_distribution<size_t> dist_01(0, 1);
@@ -260,7 +263,8 @@ private:
                 // エッジの数が1なら、探索途中か、スタートにたどり着いて一周したか
                 if (current_city == visited.front()) { // スタートにたどり着いたなら
                     // ABサイクル構成処理
-                    return create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge);
+                    create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+                    return;
                 } else {
                     continue; // 探索途中なら、次の都市へ
                 }
@@ -271,13 +275,15 @@ private:
                 if (current_city == visited.front()) { // スタートにたどりついたなら
                     if ((visited.size() + 1) % 2 == 0) { // 親Bのエッジでスタートして、親Aのエッジで戻ってきた
                         // ABサイクル構成処理
-                        return create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge);
+                        create_AB_cycle(visited, 0, cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+                        return;
                     } else { // 親Bのエッジでスタートして、親Bのエッジで帰ってきた
                         continue;
                     }
                 } else if (first_visited[current_city] != 0 && (visited.size() - first_visited[current_city] + 1) % 2 == 0) {
                     // 交差している　かつ　ABサイクルを構成するなら
-                    return create_AB_cycle(visited, first_visited[current_city], cities_having_2_edges, cities_having_just_1_edge);
+                    create_AB_cycle(visited, first_visited[current_city], cities_having_2_edges, cities_having_just_1_edge, AB_cycles);
+                    return;
                 } else if (first_visited[current_city] != 0) { // 交差しているが、ABサイクルを構成しないなら
                     continue;
                 } else { // 初めて通る都市なら
@@ -289,17 +295,14 @@ private:
 
     }
 
-    mpi::pooled_unique_ptr<ab_cycle_t> create_AB_cycle(std::vector<size_t>& finding_path,
+    void create_AB_cycle(std::vector<size_t>& finding_path,
                         size_t end_index,
                         mpi::LimitedRangeIntegerSet& cities_having_2_edges,
-                        mpi::LimitedRangeIntegerSet& cities_having_just_1_edge)
+                        mpi::LimitedRangeIntegerSet& cities_having_just_1_edge,
+                        ABCycleSet& AB_cycles)
     {
         bool starts_with_B = finding_path.size() % 2 == 0;
         size_t start_index = finding_path.size() - 1;
-        auto AB_cycle_ptr = any_size_vector_pool.acquire_unique();
-        std::vector<size_t>& AB_cycle = *AB_cycle_ptr;
-        AB_cycle.clear();
-        AB_cycle.reserve(start_index - end_index);
         
         size_t last = 0;
         // ABサイクルはAのエッジから始まるようにする
@@ -316,7 +319,7 @@ private:
 
         for (size_t i = start_index; i > end_index; i -= 1) {
             size_t current = finding_path[i];
-            AB_cycle.push_back(current);
+            AB_cycles.push_vertex(current);
             if (cities_having_2_edges.contains(current)) {
                 cities_having_2_edges.erase(current);
                 cities_having_just_1_edge.insert(current);
@@ -326,12 +329,27 @@ private:
         }
 
         if (starts_with_B) {
-            AB_cycle.push_back(last);
+            AB_cycles.push_vertex(last);
         }
 
         finding_path.resize(end_index + 1);
+    }
 
-        return AB_cycle_ptr;
+    /**
+     * @brief 構築中のABサイクルが長さ2より長く、tabuエッジを含まなければ確定し、そうでなければ破棄する
+     * @return 確定した場合はtrue
+     */
+    static bool close_AB_cycle_if_allowed(ABCycleSet& AB_cycles,
+            const doubly_linked_list_t& parent1_tabu,
+            const doubly_linked_list_t& parent2_tabu)
+    {
+        const ab_cycle_view_t cycle = AB_cycles.open_cycle();
+        if (cycle.size() > 2 && !contains_tabu_edge(cycle, parent1_tabu, parent2_tabu)) {
+            AB_cycles.close_cycle();
+            return true;
+        }
+        AB_cycles.discard_open_cycle();
+        return false;
     }
 
     /**
@@ -341,9 +359,9 @@ private:
      * @param parent2_tabu 親2のタブーエッジ
      * @return 含む場合はtrue、含まない場合はfalse
      */
-    static bool contains_tabu_edge(const ab_cycle_t& AB_cycle,
-            const std::vector<std::array<size_t, 2>>& parent1_tabu,
-            const std::vector<std::array<size_t, 2>>& parent2_tabu)
+    static bool contains_tabu_edge(ab_cycle_view_t AB_cycle,
+            const doubly_linked_list_t& parent1_tabu,
+            const doubly_linked_list_t& parent2_tabu)
     {
         for (size_t i = 0; i < AB_cycle.size(); ++i) {
             size_t u = AB_cycle[i];
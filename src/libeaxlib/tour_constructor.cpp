@@ -0,0 +1,278 @@
+#include "tour_constructor.hpp"
+#include "disjoint_set.hpp"
+#include "limited_range_integer_set.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace tsp {
+    namespace {
+        constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+        /**
+         * @brief 未訪問の都市の集合 (k-d木があれば O(log N)、なければ線形探索で最近傍を求める)
+         */
+        class RemainingCities {
+        public:
+            RemainingCities(const TSP& tsp, const KDTree& spatial_index)
+                : tsp(tsp), spatial_index(spatial_index),
+                  cities(tsp.city_count - 1, spatial_index.empty() ? mpi::LimitedRangeIntegerSet::InitSet::Universal
+                                                                   : mpi::LimitedRangeIntegerSet::InitSet::Empty) {
+                if (!spatial_index.empty()) {
+                    active_set = spatial_index.make_active_set();
+                }
+            }
+
+            void remove(size_t city) {
+                if (spatial_index.empty()) {
+                    cities.erase(city);
+                } else {
+                    spatial_index.deactivate(active_set, city);
+                }
+            }
+
+            /**
+             * @brief 残っている都市のうち、都市に最も近い都市を取得する (残っていない場合は NONE)
+             */
+            size_t nearest(size_t city) const {
+                if (!spatial_index.empty()) {
+                    return spatial_index.nearest_active(city, active_set);
+                }
+                const DistanceView distance = tsp.distance();
+                size_t best = NONE;
+                int64_t best_distance = std::numeric_limits<int64_t>::max();
+                for (size_t other : cities) {
+                    if (other == city) {
+                        continue;
+                    }
+                    int64_t d = distance(city, other);
+                    if (d < best_distance) {
+                        best_distance = d;
+                        best = other;
+                    }
+                }
+                return best;
+            }
+
+        private:
+            const TSP& tsp;
+            const KDTree& spatial_index;
+            KDTree::ActiveSet active_set;
+            mpi::LimitedRangeIntegerSet cities;
+        };
+
+        /**
+         * @brief 2^16 × 2^16 の格子上のヒルベルト曲線に沿った位置を取得する
+         */
+        uint64_t hilbert_index(uint32_t x, uint32_t y) {
+            constexpr uint32_t SIDE = 1u << 16;
+            uint64_t index = 0;
+            for (uint32_t s = SIDE / 2; s > 0; s /= 2) {
+                uint32_t rx = (x & s) > 0;
+                uint32_t ry = (y & s) > 0;
+                index += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+                if (ry == 0) {
+                    if (rx == 1) {
+                        x = SIDE - 1 - x;
+                        y = SIDE - 1 - y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return index;
+        }
+    }
+
+    InitialTourType parse_initial_tour_type(const std::string& type_name) {
+        if (type_name == "random") {
+            return InitialTourType::Random;
+        } else if (type_name == "greedy") {
+            return InitialTourType::Greedy;
+        } else if (type_name == "nn") {
+            return InitialTourType::NearestNeighbor;
+        } else if (type_name == "hilbert") {
+            return InitialTourType::SpaceFillingCurve;
+        }
+        throw std::runtime_error("Unsupported initial tour type: " + type_name);
+    }
+
+    TourConstructor::TourConstructor(const TSP& tsp, InitialTourType type)
+        : tsp(&tsp), type(type) {
+        const bool has_coordinates = tsp.distance_oracle.has_coordinates();
+        if (type == InitialTourType::SpaceFillingCurve && !has_coordinates) {
+            throw std::runtime_error("Space-filling curve tours require node coordinates.");
+        }
+        if (has_coordinates && (type == InitialTourType::Greedy || type == InitialTourType::NearestNeighbor)) {
+            spatial_index = tsp.spatial_index.empty() ? KDTree(tsp.distance_oracle.coordinates()) : tsp.spatial_index;
+        }
+
+        if (type == InitialTourType::Greedy) {
+            const size_t width = std::min(CANDIDATE_NEIGHBOR_COUNT, tsp.NN_list.width());
+            candidate_edges.reserve(tsp.city_count * width);
+            for (size_t i = 0; i < tsp.city_count; ++i) {
+                const auto neighbors = tsp.NN_list[i];
+                for (size_t k = 0; k < width; ++k) {
+                    candidate_edges.push_back({std::min(i, neighbors[k]), std::max(i, neighbors[k]), neighbors.distance(k)});
+                }
+            }
+            std::sort(candidate_edges.begin(), candidate_edges.end(), [](const CandidateEdge& a, const CandidateEdge& b) {
+                return a.i != b.i ? a.i < b.i : a.j < b.j;
+            });
+            candidate_edges.erase(std::unique(candidate_edges.begin(), candidate_edges.end(), [](const CandidateEdge& a, const CandidateEdge& b) {
+                return a.i == b.i && a.j == b.j;
+            }), candidate_edges.end());
+        }
+    }
+
+    std::vector<size_t> TourConstructor::construct(uint64_t seed) const {
+        if (tsp->city_count == 0) {
+            return {};
+        }
+        switch (type) {
+            case InitialTourType::Greedy:
+                return construct_greedy(seed);
+            case InitialTourType::NearestNeighbor:
+                return construct_nearest_neighbor(seed);
+            case InitialTourType::SpaceFillingCurve:
+                return construct_space_filling_curve(seed);
+            case InitialTourType::Random:
+                break;
+        }
+        std::mt19937_64 rng(seed);
+        std::vector<size_t> tour(tsp->city_count);
+        std::iota(tour.begin(), tour.end(), 0);
+        std::shuffle(tour.begin(), tour.end(), rng);
+        return tour;
+    }
+
+    std::vector<size_t> TourConstructor::construct_greedy(uint64_t seed) const {
+        const size_t n = tsp->city_count;
+        std::mt19937_64 rng(seed);
+
+        // 摂動を加えた長さの短い順に、次数が2未満で閉路を作らない辺を採用する
+        std::uniform_real_distribution<double> noise(1.0, 1.0 + GREEDY_NOISE);
+        std::vector<std::pair<double, size_t>> order(candidate_edges.size());
+        for (size_t k = 0; k < candidate_edges.size(); ++k) {
+            order[k] = {static_cast<double>(candidate_edges[k].distance) * noise(rng), k};
+        }
+        std::sort(order.begin(), order.end());
+
+        std::vector<std::array<size_t, 2>> adjacent(n, {NONE, NONE});
+        std::vector<uint8_t> degree(n, 0);
+        mpi::DisjointSet fragments(n);
+        for (const auto& [key, k] : order) {
+            const CandidateEdge& edge = candidate_edges[k];
+            if (degree[edge.i] < 2 && degree[edge.j] < 2 && fragments.unite(edge.i, edge.j)) {
+                adjacent[edge.i][degree[edge.i]++] = edge.j;
+                adjacent[edge.j][degree[edge.j]++] = edge.i;
+            }
+        }
+
+        // 断片の端点だけを残し、断片の終端から最も近い端点の断片へ順につなぐ
+        RemainingCities endpoints(*tsp, spatial_index);
+        std::vector<size_t> endpoint_list;
+        for (size_t city = 0; city < n; ++city) {
+            if (degree[city] == 2) {
+                endpoints.remove(city);
+            } else {
+                endpoint_list.push_back(city);
+            }
+        }
+
+        std::vector<size_t> tour;
+        tour.reserve(n);
+        size_t start = endpoint_list[std::uniform_int_distribution<size_t>(0, endpoint_list.size() - 1)(rng)];
+        while (start != NONE) {
+            endpoints.remove(start);
+            size_t previous = NONE;
+            size_t city = start;
+            while (city != NONE) {
+                tour.push_back(city);
+                size_t next = adjacent[city][0] != previous ? adjacent[city][0] : adjacent[city][1];
+                previous = city;
+                city = next;
+            }
+            if (previous != start) {
+                endpoints.remove(previous);
+            }
+            start = endpoints.nearest(previous);
+        }
+        return tour;
+    }
+
+    std::vector<size_t> TourConstructor::construct_nearest_neighbor(uint64_t seed) const {
+        const size_t n = tsp->city_count;
+        std::mt19937_64 rng(seed);
+        RemainingCities remaining(*tsp, spatial_index);
+        std::vector<uint8_t> visited(n, false);
+        const size_t width = std::min(CANDIDATE_NEIGHBOR_COUNT, tsp->NN_list.width());
+
+        std::vector<size_t> tour;
+        tour.reserve(n);
+        size_t city = std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+        while (true) {
+            tour.push_back(city);
+            visited[city] = true;
+            remaining.remove(city);
+            if (tour.size() == n) {
+                break;
+            }
+
+            // 近傍リストの先頭に未訪問の都市があればその中で最も近い都市、なければ未訪問の都市全体で最も近い都市へ進む
+            size_t next = NONE;
+            int64_t best_distance = std::numeric_limits<int64_t>::max();
+            const auto neighbors = tsp->NN_list[city];
+            for (size_t k = 0; k < width; ++k) {
+                if (!visited[neighbors[k]] && neighbors.distance(k) < best_distance) {
+                    best_distance = neighbors.distance(k);
+                    next = neighbors[k];
+                }
+            }
+            if (next == NONE) {
+                next = remaining.nearest(city);
+            }
+            city = next;
+        }
+        return tour;
+    }
+
+    std::vector<size_t> TourConstructor::construct_space_filling_curve(uint64_t seed) const {
+        const size_t n = tsp->city_count;
+        const Coordinates& coordinates = tsp->distance_oracle.coordinates();
+        std::mt19937_64 rng(seed);
+
+        // 座標をランダムに回転してから格子に写すことで、シードごとに異なる曲線の順序を得る
+        const double angle = std::uniform_real_distribution<double>(0.0, 2.0 * std::numbers::pi)(rng);
+        const double cos_a = std::cos(angle);
+        const double sin_a = std::sin(angle);
+        std::vector<double> u(n), v(n);
+        for (size_t i = 0; i < n; ++i) {
+            u[i] = coordinates.x[i] * cos_a - coordinates.y[i] * sin_a;
+            v[i] = coordinates.x[i] * sin_a + coordinates.y[i] * cos_a;
+        }
+        auto [min_u, max_u] = std::minmax_element(u.begin(), u.end());
+        auto [min_v, max_v] = std::minmax_element(v.begin(), v.end());
+        const double span = std::max(*max_u - *min_u, *max_v - *min_v);
+        const double scale = span > 0.0 ? 65535.0 / span : 0.0;
+
+        std::vector<std::pair<uint64_t, size_t>> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t gx = static_cast<uint32_t>((u[i] - *min_u) * scale);
+            uint32_t gy = static_cast<uint32_t>((v[i] - *min_v) * scale);
+            keys[i] = {hilbert_index(gx, gy), i};
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<size_t> tour(n);
+        for (size_t i = 0; i < n; ++i) {
+            tour[i] = keys[i].second;
+        }
+        return tour;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "tsp_loader.hpp"
+
+namespace tsp {
+    /**
+     * @brief 初期集団の巡回路の構築方法
+     */
+    enum class InitialTourType {
+        /**
+         * @brief ランダムな順列
+         */
+        Random,
+        /**
+         * @brief 近傍リスト上の辺を短い順に採用する貪欲法 (辺の長さにランダムな摂動を加える)
+         */
+        Greedy,
+        /**
+         * @brief ランダムな都市から始める最近傍法
+         */
+        NearestNeighbor,
+        /**
+         * @brief ランダムに回転した座標上のヒルベルト曲線の順序 (座標が必要)
+         */
+        SpaceFillingCurve,
+    };
+
+    /**
+     * @brief 文字列 ("random", "greedy", "nn" または "hilbert") から巡回路の構築方法を取得する
+     * @throws std::runtime_error 対応していない文字列の場合
+     */
+    InitialTourType parse_initial_tour_type(const std::string& type_name);
+
+    /**
+     * @brief 2-optに渡す初期巡回路を構築するクラス
+     * @details
+     *  ランダムな順列から2-optを始めると、2-optの時間の大半が交差の解消に使われる。
+     *  貪欲法、最近傍法、空間充填曲線で構築した巡回路は最適解から数十%以内の長さなので、2-optの反復回数を大きく削減できる。
+     *  シードごとに異なる巡回路を構築するので、集団の多様性も保たれる。
+     *  construct は const で内部状態を変更しないので、複数のスレッドから同時に呼び出せる。
+     */
+    class TourConstructor {
+    public:
+        /**
+         * @brief 指定したインスタンスと構築方法で初期化する
+         * @param tsp TSPのインスタンス (TourConstructorより長く生存すること)
+         * @param type 巡回路の構築方法
+         * @throws std::runtime_error SpaceFillingCurve で座標がない場合
+         */
+        TourConstructor(const TSP& tsp, InitialTourType type);
+
+        /**
+         * @brief 巡回路を構築する
+         * @param seed 乱数シード
+         * @return 都市の訪問順
+         */
+        std::vector<size_t> construct(uint64_t seed) const;
+
+        InitialTourType get_type() const {
+            return type;
+        }
+
+        size_t city_count() const {
+            return tsp->city_count;
+        }
+
+        const TSP& instance() const {
+            return *tsp;
+        }
+
+        /**
+         * @brief 貪欲法と最近傍法で使う1都市あたりの近傍都市の数
+         */
+        static constexpr size_t CANDIDATE_NEIGHBOR_COUNT = 10;
+        /**
+         * @brief 貪欲法で辺の長さに掛ける乱数 1 + U[0, GREEDY_NOISE) の幅
+         */
+        static constexpr double GREEDY_NOISE = 0.1;
+
+    private:
+        struct CandidateEdge {
+            size_t i;
+            size_t j;
+            int64_t distance;
+        };
+
+        std::vector<size_t> construct_greedy(uint64_t seed) const;
+        std::vector<size_t> construct_nearest_neighbor(uint64_t seed) const;
+        std::vector<size_t> construct_space_filling_curve(uint64_t seed) const;
+
+        const TSP* tsp;
+        InitialTourType type;
+        /**
+         * @brief 貪欲法の候補辺 (i < j、重複なし)
+         */
+        std::vector<CandidateEdge> candidate_edges;
+        /**
+         * @brief 未訪問の都市の最近傍探索に使うk-d木 (座標がない場合は空)
+         */
+        KDTree spatial_index;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+#include <concepts>
+
+#include "shared_array.hpp"
+
+namespace tsp {
+    /**
+     * @brief 対称な距離行列の上三角部分だけを平坦な配列に保持する距離行列
+     * @details
+     *  対角成分を除いた上三角部分 N(N-1)/2 要素を1本の配列に格納する。
+     *  要素の型 W を uint16_t や int32_t にすることで、int64_t の N×N 行列に比べて
+     *  メモリ使用量と距離参照時のメモリ帯域を大幅に削減できる。
+     *  各行の先頭位置は構築時に表にしておき、距離の参照では乗算を行わない。
+     * @tparam W 距離を格納する整数型
+     */
+    template <typename W>
+    requires std::is_integral_v<W>
+    class TriangularDistanceMatrix {
+    public:
+        using weight_type = W;
+        using value_type = int64_t;
+
+        /**
+         * @brief 行の距離を読み取るためのプロキシ (matrix[i][j] の形で使用する)
+         */
+        class Row {
+        public:
+            int64_t operator[](size_t j) const {
+                return (*matrix)(i, j);
+            }
+        private:
+            friend class TriangularDistanceMatrix;
+            Row(const TriangularDistanceMatrix* matrix, size_t i) : matrix(matrix), i(i) {}
+            const TriangularDistanceMatrix* matrix;
+            size_t i;
+        };
+
+        TriangularDistanceMatrix() = default;
+
+        /**
+         * @brief すべての距離が0の行列を構築する
+         * @param city_count 都市数
+         */
+        explicit TriangularDistanceMatrix(size_t city_count)
+            : city_count(city_count), weights(element_count(city_count), 0), row_offsets(build_row_offsets(city_count)) {}
+
+        /**
+         * @brief 既存の上三角部分の配列から行列を構築する
+         * @param city_count 都市数
+         * @param weights 上三角部分の配列 (要素数は element_count(city_count))
+         */
+        TriangularDistanceMatrix(size_t city_count, SharedArray<W> weights)
+            : city_count(city_count), weights(std::move(weights)), row_offsets(build_row_offsets(city_count)) {}
+
+        /**
+         * @brief 距離関数から行列を構築する
+         * @param city_count 都市数
+         * @param distance_func i < j について距離を返す関数
+         */
+        template <typename F>
+        requires std::invocable<F&, size_t, size_t>
+        TriangularDistanceMatrix(size_t city_count, F&& distance_func)
+            : TriangularDistanceMatrix(city_count) {
+            W* data = weights.mutable_data();
+            size_t index = 0;
+            for (size_t i = 0; i < city_count; ++i) {
+                for (size_t j = i + 1; j < city_count; ++j) {
+                    data[index++] = static_cast<W>(distance_func(i, j));
+                }
+            }
+        }
+
+        /**
+         * @brief 都市数 city_count の行列が保持する要素数
+         */
+        static constexpr size_t element_count(size_t city_count) {
+            return city_count < 2 ? 0 : city_count * (city_count - 1) / 2;
+        }
+
+        /**
+         * @brief 指定した最大距離を型 W で表現できるかどうか
+         */
+        static constexpr bool can_represent(int64_t max_distance) {
+            return max_distance >= 0 && static_cast<uint64_t>(max_distance) <= static_cast<uint64_t>(std::numeric_limits<W>::max());
+        }
+
+        int64_t operator()(size_t i, size_t j) const {
+            if (i == j) {
+                return 0;
+            }
+            if (i > j) {
+                std::swap(i, j);
+            }
+            return static_cast<int64_t>(weights[index(i, j)]);
+        }
+
+        Row operator[](size_t i) const {
+            return Row(this, i);
+        }
+
+        void set(size_t i, size_t j, int64_t value) {
+            if (i > j) {
+                std::swap(i, j);
+            }
+            weights.mutable_data()[index(i, j)] = static_cast<W>(value);
+        }
+
+        /**
+         * @brief 都市iの行 (都市 i+1 から city_count-1 までの距離) の先頭を取得する (構築用)
+         */
+        W* row_data(size_t i) {
+            return weights.mutable_data() + i * (2 * city_count - i - 1) / 2;
+        }
+
+        size_t size() const {
+            return city_count;
+        }
+
+        /**
+         * @brief 距離の格納に使用しているバイト数
+         */
+        size_t memory_bytes() const {
+            return weights.size_bytes();
+        }
+
+        const SharedArray<W>& data() const {
+            return weights;
+        }
+
+    private:
+        /**
+         * @brief i < j のときの平坦な配列上の位置
+         */
+        size_t index(size_t i, size_t j) const {
+            return row_offsets[i] + j;
+        }
+
+        /**
+         * @brief 各行について index(i, j) - j となる値の表を作る (i = 0 では符号なしの回り込みを使う)
+         */
+        static std::vector<size_t> build_row_offsets(size_t city_count) {
+            std::vector<size_t> offsets(city_count);
+            for (size_t i = 0; i < city_count; ++i) {
+                offsets[i] = i * (2 * city_count - i - 1) / 2 - i - 1;
+            }
+            return offsets;
+        }
+
+        size_t city_count = 0;
+        SharedArray<W> weights;
+        /**
+         * @brief 行ごとの平坦な配列上の位置の基準 (index(i, j) = row_offsets[i] + j)
+         */
+        std::vector<size_t> row_offsets;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "tsp_binary_format.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <memory>
+
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+
+namespace tsp {
+namespace binary {
+    namespace {
+        constexpr std::array<char, 8> MAGIC = {'E', 'A', 'X', 'T', 'S', 'P', 'B', '\0'};
+        constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+        struct Section {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        /**
+         * @brief ファイル先頭のヘッダ (ネイティブのエンディアンで保存する)
+         */
+        struct Header {
+            std::array<char, 8> magic;
+            uint32_t version;
+            uint32_t neighbor_entry_size;
+            uint64_t source_hash;
+            uint64_t source_size;
+            uint64_t distance_matrix_limit;
+            uint64_t full_neighbor_list_limit;
+            uint64_t neighbor_count;
+            uint64_t candidate_type;
+            uint64_t city_count;
+            uint32_t distance_type;
+            uint32_t matrix_kind;
+            uint64_t neighbor_width;
+            Section name;
+            Section distance_type_name;
+            Section x;
+            Section y;
+            Section matrix;
+            Section neighbors;
+        };
+
+        uint64_t align_up(uint64_t value) {
+            return (value + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+        }
+
+        bool section_in_range(const Section& section, size_t file_size) {
+            return section.offset <= file_size && section.size <= file_size - section.offset;
+        }
+
+        template <typename T>
+        SharedArray<T> map_section(const std::shared_ptr<const MappedFile>& file, const Section& section) {
+            const T* data = reinterpret_cast<const T*>(file->data() + section.offset);
+            return SharedArray<T>(file, data, section.size / sizeof(T));
+        }
+    }
+
+    uint64_t hash_bytes(const void* data, size_t size, uint64_t hash) {
+        constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+        const std::byte* bytes = static_cast<const std::byte*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<uint64_t>(bytes[i]);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    SourceFingerprint fingerprint_file(const std::string& file_name) {
+        MappedFile file(file_name);
+        return {hash_bytes(file.data(), file.size()), file.size()};
+    }
+
+    std::string temporary_file_name(const std::string& file_name) {
+        static std::atomic<uint64_t> counter = 0;
+        return file_name + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(counter++);
+    }
+
+    std::optional<TSP> load(const std::string& binary_file, const SourceFingerprint& source, const LoadOptions& options) {
+        if (!std::filesystem::exists(binary_file)) {
+            return std::nullopt;
+        }
+
+        std::shared_ptr<const MappedFile> file;
+        try {
+            file = std::make_shared<const MappedFile>(binary_file);
+        } catch (const std::runtime_error&) {
+            return std::nullopt;
+        }
+
+        if (file->size() < sizeof(Header)) {
+            return std::nullopt;
+        }
+        Header header;
+        std::memcpy(&header, file->data(), sizeof(Header));
+
+        if (header.magic != MAGIC
+            || header.version != FORMAT_VERSION
+            || header.neighbor_entry_size != sizeof(NeighborList::Entry)
+            || SourceFingerprint{header.source_hash, header.source_size} != source
+            || header.distance_matrix_limit != options.distance_matrix_limit
+            || header.full_neighbor_list_limit != options.full_neighbor_list_limit
+            || header.neighbor_count != options.neighbor_count
+            || header.candidate_type != static_cast<uint64_t>(options.candidate_type)) {
+            return std::nullopt;
+        }
+
+        const size_t n = header.city_count;
+        for (const Section& section : {header.name, header.distance_type_name, header.x, header.y, header.matrix, header.neighbors}) {
+            if (!section_in_range(section, file->size())) {
+                return std::nullopt;
+            }
+        }
+        // 座標を持たない (EXPLICIT) 場合は距離行列が必須
+        const bool has_coordinates = header.x.size != 0 || header.y.size != 0 || n == 0;
+        if ((has_coordinates && (header.x.size != n * sizeof(double) || header.y.size != n * sizeof(double)))
+            || (!has_coordinates && header.matrix_kind == 0)
+            || header.neighbors.size != n * header.neighbor_width * sizeof(NeighborList::Entry)) {
+            return std::nullopt;
+        }
+
+        TSP tsp;
+        tsp.city_count = n;
+        tsp.name.assign(reinterpret_cast<const char*>(file->data() + header.name.offset), header.name.size);
+        tsp.distance_type.assign(reinterpret_cast<const char*>(file->data() + header.distance_type_name.offset), header.distance_type_name.size);
+
+        if (has_coordinates) {
+            Coordinates coordinates;
+            coordinates.x.resize(n);
+            coordinates.y.resize(n);
+            std::memcpy(coordinates.x.data(), file->data() + header.x.offset, header.x.size);
+            std::memcpy(coordinates.y.data(), file->data() + header.y.offset, header.y.size);
+            tsp.distance_oracle = DistanceOracle(std::move(coordinates), static_cast<DistanceType>(header.distance_type));
+        }
+
+        const size_t matrix_elements = TriangularDistanceMatrix<int32_t>::element_count(n);
+        switch (header.matrix_kind) {
+            case 0:
+                break;
+            case 1:
+                if (header.matrix.size != matrix_elements * sizeof(uint16_t)) {
+                    return std::nullopt;
+                }
+                tsp.distance_matrix.emplace<TriangularDistanceMatrix<uint16_t>>(n, map_section<uint16_t>(file, header.matrix));
+                break;
+            case 2:
+                if (header.matrix.size != matrix_elements * sizeof(int32_t)) {
+                    return std::nullopt;
+                }
+                tsp.distance_matrix.emplace<TriangularDistanceMatrix<int32_t>>(n, map_section<int32_t>(file, header.matrix));
+                break;
+            default:
+                return std::nullopt;
+        }
+
+        tsp.NN_list = NeighborList(n, header.neighbor_width, map_section<NeighborList::Entry>(file, header.neighbors));
+        if (!tsp.NN_list.is_complete() && tsp.distance_oracle.has_coordinates()) {
+            // k-d木は保存せず、座標から再構築する O(N log N)
+            tsp.spatial_index = KDTree(tsp.distance_oracle.coordinates());
+        }
+        return tsp;
+    }
+
+    void save(const TSP& tsp, const std::string& binary_file, const SourceFingerprint& source, const LoadOptions& options) {
+        static const Coordinates no_coordinates;
+        const Coordinates& coordinates = tsp.distance_oracle.has_coordinates() ? tsp.distance_oracle.coordinates() : no_coordinates;
+
+        const void* matrix_data = nullptr;
+        uint64_t matrix_size = 0;
+        uint32_t matrix_kind = static_cast<uint32_t>(tsp.distance_matrix.index());
+        std::visit([&](const auto& matrix) {
+            if constexpr (!std::is_same_v<std::remove_cvref_t<decltype(matrix)>, std::monostate>) {
+                matrix_data = matrix.data().data();
+                matrix_size = matrix.data().size_bytes();
+            }
+        }, tsp.distance_matrix);
+
+        Header header{};
+        header.magic = MAGIC;
+        header.version = FORMAT_VERSION;
+        header.neighbor_entry_size = sizeof(NeighborList::Entry);
+        header.source_hash = source.hash;
+        header.source_size = source.size;
+        header.distance_matrix_limit = options.distance_matrix_limit;
+        header.full_neighbor_list_limit = options.full_neighbor_list_limit;
+        header.neighbor_count = options.neighbor_count;
+        header.candidate_type = static_cast<uint64_t>(options.candidate_type);
+        header.city_count = tsp.city_count;
+        header.distance_type = static_cast<uint32_t>(tsp.distance_oracle.get_type());
+        header.matrix_kind = matrix_kind;
+        header.neighbor_width = tsp.NN_list.width();
+
+        // セクションの配置を決める
+        uint64_t offset = align_up(sizeof(Header));
+        auto place = [&offset](Section& section, uint64_t size) {
+            section = {offset, size};
+            offset = align_up(offset + size);
+        };
+        place(header.name, tsp.name.size());
+        place(header.distance_type_name, tsp.distance_type.size());
+        place(header.x, coordinates.x.size() * sizeof(double));
+        place(header.y, coordinates.y.size() * sizeof(double));
+        place(header.matrix, matrix_size);
+        place(header.neighbors, tsp.NN_list.data().size_bytes());
+
+        const std::string temp_file = temporary_file_name(binary_file);
+        {
+            std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not open the file: " + temp_file);
+            }
+
+            uint64_t written = 0;
+            auto write_at = [&out, &written](const Section& section, const void* data) {
+                static constexpr std::array<char, SECTION_ALIGNMENT> zeros{};
+                while (written < section.offset) {
+                    uint64_t padding = std::min<uint64_t>(section.offset - written, zeros.size());
+                    out.write(zeros.data(), padding);
+                    written += padding;
+                }
+                out.write(static_cast<const char*>(data), section.size);
+                written += section.size;
+            };
+            write_at({0, sizeof(Header)}, &header);
+            write_at(header.name, tsp.name.data());
+            write_at(header.distance_type_name, tsp.distance_type.data());
+            write_at(header.x, coordinates.x.data());
+            write_at(header.y, coordinates.y.data());
+            write_at(header.matrix, matrix_data);
+            write_at(header.neighbors, tsp.NN_list.data().data());
+
+            if (!out) {
+                out.close();
+                std::filesystem::remove(temp_file);
+                throw std::runtime_error("Failed to write the file: " + temp_file);
+            }
+        }
+        std::filesystem::rename(temp_file, binary_file);
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <cstdint>
+
+#include "tsp_loader.hpp"
+
+namespace tsp {
+namespace binary {
+    /**
+     * @brief バイナリ形式のバージョン (レイアウトを変更したら更新する)
+     */
+    constexpr uint32_t FORMAT_VERSION = 3;
+
+    /**
+     * @brief 元のTSPファイルの内容のハッシュ
+     */
+    struct SourceFingerprint {
+        uint64_t hash = 0;
+        uint64_t size = 0;
+
+        bool operator==(const SourceFingerprint&) const = default;
+    };
+
+    /**
+     * @brief FNV-1a のハッシュの初期値
+     */
+    constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+
+    /**
+     * @brief バイト列のハッシュを計算する (FNV-1a)
+     * @param data 先頭のポインタ
+     * @param size バイト数
+     * @param hash 途中までのハッシュ (続けて計算する場合)
+     * @return ハッシュ
+     */
+    uint64_t hash_bytes(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS);
+
+    /**
+     * @brief ファイルの内容のハッシュを計算する (FNV-1a)
+     * @param file_name ファイル名
+     * @return ハッシュとファイルサイズ
+     * @throws std::runtime_error ファイルを開けない場合
+     */
+    SourceFingerprint fingerprint_file(const std::string& file_name);
+
+    /**
+     * @brief 書き込み途中のファイルに使う一時ファイル名を取得する
+     * @details
+     *  プロセスIDと呼び出しごとに増えるカウンタを付けるので、同じファイルを複数のプロセスやスレッドが
+     *  同時に書き込んでも一時ファイルは衝突しない (最後に rename したものが残る)。
+     * @param file_name 書き込み先のファイル名
+     * @return 一時ファイル名
+     */
+    std::string temporary_file_name(const std::string& file_name);
+
+    /**
+     * @brief 前処理済みのバイナリファイルをメモリマップして読み込む
+     * @details
+     *  距離行列と近傍リストはマップした領域をコピーせずに参照する。
+     *  元のファイルのハッシュ、形式のバージョン、読み込みオプションのいずれかが一致しない場合は古いものとみなす。
+     * @param binary_file バイナリファイル名
+     * @param source 元のTSPファイルのハッシュ
+     * @param options 読み込みオプション
+     * @return 読み込んだTSP (ファイルが存在しないか古い場合は std::nullopt)
+     */
+    std::optional<TSP> load(const std::string& binary_file, const SourceFingerprint& source, const LoadOptions& options);
+
+    /**
+     * @brief TSPを前処理済みのバイナリファイルに保存する
+     * @details 一時ファイルに書き込んでから置き換えるため、並行して読み込まれても壊れたファイルは見えない
+     * @param tsp 保存するTSP
+     * @param binary_file バイナリファイル名
+     * @param source 元のTSPファイルのハッシュ
+     * @param options 読み込みオプション
+     * @throws std::runtime_error 書き込みに失敗した場合
+     */
+    void save(const TSP& tsp, const std::string& binary_file, const SourceFingerprint& source, const LoadOptions& options);
+}
+}
\ No newline at end of file
@@ -1,131 +1,365 @@
 #include "tsp_loader.hpp"
+#include "tsp_binary_format.hpp"
+#include "alpha_nearness.hpp"
+#include "distance_kernels.hpp"
+#include "mapped_file.hpp"
+#include "tsplib_tokenizer.hpp"
+#include "parallel_for.hpp"
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <filesystem>
 #include <algorithm>
+#include <charconv>
+#include <limits>
 
 namespace tsp {
-    TSP TSP_Loader::load_tsp(const std::string& file_name) {
-        TSP tsp;
-        std::ifstream file(file_name);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open the file: " + file_name);
+    namespace {
+        /**
+         * @brief EDGE_WEIGHT_SECTION の重みを読み、上三角の距離行列に直接書き込む
+         * @details
+         *  EDGE_WEIGHT_FORMAT に従って数値を先頭から順に読み、i < j の要素だけを書き込む。
+         *  対角成分は読み飛ばし、FULL_MATRIX の下三角は上三角と一致することだけを確認する。
+         * @param tokenizer EDGE_WEIGHT_SECTION の直後を指すトークナイザ
+         * @param format EDGE_WEIGHT_FORMAT の文字列
+         * @param matrix 書き込み先の行列
+         * @return すべての重みを読めた場合は true、型 W で表現できない重みがあった場合は false
+         * @throws std::runtime_error 重みの数が足りない、数値でない、負である、または形式に対応していない場合
+         */
+        template <typename W>
+        bool read_edge_weights(TsplibTokenizer& tokenizer, std::string_view format, TriangularDistanceMatrix<W>& matrix) {
+            const size_t n = matrix.size();
+
+            auto read = [&tokenizer]() {
+                int64_t weight;
+                if (!tokenizer.next_number(weight)) {
+                    TsplibTokenizer::fail(tokenizer.offset(), "Missing or invalid edge weight in EDGE_WEIGHT_SECTION");
+                }
+                return weight;
+            };
+            auto next = [&](W& out) {
+                int64_t weight = read();
+                if (weight < 0) {
+                    TsplibTokenizer::fail(tokenizer.offset(), "Negative edge weight: " + std::to_string(weight));
+                }
+                if (!TriangularDistanceMatrix<W>::can_represent(weight)) {
+                    return false;
+                }
+                out = static_cast<W>(weight);
+                return true;
+            };
+
+            if (format == "FULL_MATRIX") {
+                for (size_t i = 0; i < n; ++i) {
+                    for (size_t j = 0; j < i; ++j) {
+                        if (read() != matrix(j, i)) {
+                            TsplibTokenizer::fail(tokenizer.offset(), "FULL_MATRIX is not symmetric");
+                        }
+                    }
+                    read(); // 対角成分
+                    W* row = matrix.row_data(i);
+                    for (size_t k = 0; k < n - i - 1; ++k) {
+                        if (!next(row[k])) {
+                            return false;
+                        }
+                    }
+                }
+            } else if (format == "UPPER_ROW" || format == "UPPER_DIAG_ROW") {
+                // 行の並びが格納順と同じなので、先頭から順に書き込める
+                const bool has_diagonal = format == "UPPER_DIAG_ROW";
+                for (size_t i = 0; i < n; ++i) {
+                    if (has_diagonal) {
+                        read();
+                    }
+                    W* row = matrix.row_data(i);
+                    for (size_t k = 0; k < n - i - 1; ++k) {
+                        if (!next(row[k])) {
+                            return false;
+                        }
+                    }
+                }
+            } else if (format == "LOWER_ROW" || format == "LOWER_DIAG_ROW") {
+                const bool has_diagonal = format == "LOWER_DIAG_ROW";
+                for (size_t i = 0; i < n; ++i) {
+                    for (size_t j = 0; j < i; ++j) {
+                        W weight;
+                        if (!next(weight)) {
+                            return false;
+                        }
+                        matrix.set(j, i, weight);
+                    }
+                    if (has_diagonal) {
+                        read();
+                    }
+                }
+            } else {
+                TsplibTokenizer::fail(tokenizer.offset(), "Unsupported EDGE_WEIGHT_FORMAT: " + std::string(format));
+            }
+            return true;
         }
+    }
 
-        auto trim = [](std::string& s) {
-            s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch); }));
-            s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) { return !std::isspace(ch); }).base(), s.end());
+    CandidateType parse_candidate_type(const std::string& type_name) {
+        if (type_name == "nearest") {
+            return CandidateType::Nearest;
+        } else if (type_name == "alpha") {
+            return CandidateType::Alpha;
+        }
+        throw std::runtime_error("Unsupported candidate type: " + type_name);
+    }
+
+    InstanceData TSP_Loader::load_instance(const std::string& file_name, const LoadOptions& options) {
+        return std::make_shared<const TSP>(load_tsp(file_name, options));
+    }
+
+    TSP TSP_Loader::load_tsp(const std::string& file_name, const LoadOptions& options) {
+        if (options.binary_cache_directory.empty()) {
+            return parse_tsp(file_name, options);
+        }
+
+        const std::string binary_file = (std::filesystem::path(options.binary_cache_directory)
+                                         / std::filesystem::path(file_name).filename()).string() + ".tspbin";
+        const binary::SourceFingerprint source = binary::fingerprint_file(file_name);
+        if (auto cached = binary::load(binary_file, source, options)) {
+            return std::move(*cached);
+        }
+
+        TSP tsp = parse_tsp(file_name, options);
+        try {
+            binary::save(tsp, binary_file, source, options);
+        } catch (const std::exception& e) {
+            // バイナリファイルを作れなくても読み込み自体は成功しているので続行する
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+        return tsp;
+    }
+
+    TSP TSP_Loader::parse_tsp(const std::string& file_name, const LoadOptions& options) {
+        TSP tsp;
+        tsp.city_count = 0;
+        const MappedFile file(file_name);
+        TsplibTokenizer tokenizer(std::string_view(reinterpret_cast<const char*>(file.data()), file.size()));
+
+        // "KEY : value" の value を取得する
+        auto value_of = [&tokenizer](std::string_view line, std::string_view key) {
+            size_t colon_pos = line.find(':');
+            if (colon_pos == std::string_view::npos) {
+                TsplibTokenizer::fail(tokenizer.line_offset(), "Invalid line format for " + std::string(key) + ": " + std::string(line));
+            }
+            // 前後の空白をトリム
+            return TsplibTokenizer::trim(line.substr(colon_pos + 1));
         };
 
-        std::string line;
-        while (std::getline(file, line)) {
+        std::string_view edge_weight_format;
+        bool has_edge_weight_section = false;
+        std::string_view line;
+        while (tokenizer.next_line(line)) {
             if (line.starts_with("NAME")) {
-                size_t colon_pos = line.find(':');
-                if (colon_pos == std::string::npos) {
-                    throw std::runtime_error("Invalid line format for NAME: " + line);
-                }
-                auto name_part = line.substr(colon_pos + 1);
-                // 前後の空白をトリム
-                trim(name_part);
-                tsp.name = name_part;
+                tsp.name = value_of(line, "NAME");
             } else if (line.starts_with("DIMENSION")) {
-                size_t colon_pos = line.find(':');
-                if (colon_pos == std::string::npos) {
-                    throw std::runtime_error("Invalid line format for DIMENSION: " + line);
+                auto dimension_part = value_of(line, "DIMENSION");
+                auto [end, ec] = std::from_chars(dimension_part.data(), dimension_part.data() + dimension_part.size(), tsp.city_count);
+                if (ec != std::errc() || dimension_part.empty()) {
+                    TsplibTokenizer::fail(tokenizer.line_offset(), "Invalid number format for DIMENSION: " + std::string(dimension_part));
                 }
-                auto dimension_part = line.substr(colon_pos + 1);
-                // 前後の空白をトリム
-                trim(dimension_part);
-                try {
-                    tsp.city_count = std::stoul(dimension_part);
-                } catch (const std::exception& e) {
-                    throw std::runtime_error("Invalid number format for DIMENSION: " + dimension_part);
-                }
-                tsp.adjacency_matrix.resize(tsp.city_count, std::vector<int64_t>(tsp.city_count, 0));
             } else if (line.starts_with("EDGE_WEIGHT_TYPE")) {
-                size_t colon_pos = line.find(':');
-                if (colon_pos == std::string::npos) {
-                    throw std::runtime_error("Invalid line format for EDGE_WEIGHT_TYPE: " + line);
-                }
-                auto type_part = line.substr(colon_pos + 1);
-                // 前後の空白をトリム
-                trim(type_part);
-                tsp.distance_type = type_part;
+                tsp.distance_type = value_of(line, "EDGE_WEIGHT_TYPE");
+            } else if (line.starts_with("EDGE_WEIGHT_FORMAT")) {
+                edge_weight_format = value_of(line, "EDGE_WEIGHT_FORMAT");
+            } else if (line.starts_with("EDGE_WEIGHT_SECTION")) {
+                has_edge_weight_section = true;
+                break; // Start reading the edge weights
             } else if (line.starts_with("NODE_COORD_SECTION")) {
-                break; // Start reading the adjacency matrix
+                break; // Start reading the coordinates
             }
         }
-        
-        std::vector<std::pair<double, double>> coordinates(tsp.city_count);
+
+        if (tsp.distance_type == "EXPLICIT") {
+            if (!has_edge_weight_section) {
+                TsplibTokenizer::fail(tokenizer.offset(), "EDGE_WEIGHT_SECTION is missing for EXPLICIT edge weights.");
+            }
+            // まず uint16_t の行列に読み込み、収まらない重みがあれば int32_t の行列に読み直す。
+            // 一時的な行列を持たないので、ピークのメモリ使用量は最終的な行列1つ分で済む
+            const TsplibTokenizer section_start = tokenizer;
+            if (!read_edge_weights(tokenizer, edge_weight_format, tsp.distance_matrix.emplace<TriangularDistanceMatrix<uint16_t>>(tsp.city_count))) {
+                tokenizer = section_start;
+                if (!read_edge_weights(tokenizer, edge_weight_format, tsp.distance_matrix.emplace<TriangularDistanceMatrix<int32_t>>(tsp.city_count))) {
+                    TsplibTokenizer::fail(tokenizer.offset(), "Edge weight does not fit in 32 bits.");
+                }
+            }
+            build_neighbor_list(tsp, options);
+            return tsp;
+        }
+
+        DistanceType distance_type = parse_distance_type(tsp.distance_type);
+
+        // 座標をSoA形式の配列に直接書き込む
+        Coordinates coordinates;
+        coordinates.x.resize(tsp.city_count);
+        coordinates.y.resize(tsp.city_count);
         size_t city_index = 0;
-        while (std::getline(file, line)) {
-            if (line.find("EOF") != std::string::npos) {
+        while (tokenizer.next_line(line)) {
+            if (line.find("EOF") != std::string_view::npos) {
                 break; // End of the coordinates section
             }
-            std::istringstream iss(line);
+            const char* p = line.data();
+            const char* end = line.data() + line.size();
+            if (TsplibTokenizer::skip_blanks(p, end) == end) {
+                continue; // 空行
+            }
+
             size_t id;
             double x, y;
-            if (iss >> id >> x >> y) {
-                if (id < 1 || id > tsp.city_count) {
-                    throw std::runtime_error("City ID out of range: " + std::to_string(id));
-                }
-                coordinates[id - 1] = {x, y};
-                city_index++;
-            } else {
-                throw std::runtime_error("Invalid line format: " + line);
+            if (!TsplibTokenizer::parse_field(p, end, id)
+                || !TsplibTokenizer::parse_field(p, end, x)
+                || !TsplibTokenizer::parse_field(p, end, y)) {
+                TsplibTokenizer::fail(tokenizer.offset_of(p), "Invalid line format: " + std::string(line));
+            }
+            if (id < 1 || id > tsp.city_count) {
+                TsplibTokenizer::fail(tokenizer.line_offset(), "City ID out of range: " + std::to_string(id));
             }
+            coordinates.x[id - 1] = x;
+            coordinates.y[id - 1] = y;
+            city_index++;
         }
 
         if (city_index != tsp.city_count) {
-            throw std::runtime_error("Number of cities does not match the specified dimension.");
+            TsplibTokenizer::fail(tokenizer.offset(), "Number of cities does not match the specified dimension.");
+        }
+
+        tsp.distance_oracle = DistanceOracle(std::move(coordinates), distance_type);
+
+        build_distance_matrix(tsp, options);
+        build_neighbor_list(tsp, options);
+
+        return tsp;
+    }
+
+    void TSP_Loader::build_distance_matrix(TSP& tsp, const LoadOptions& options) {
+        // 最大距離の上界から要素の型を選ぶ。都市数が上限を超えるか int32_t に収まらない場合は距離オラクルで距離を計算する
+        if (tsp.city_count > options.distance_matrix_limit) {
+            return;
+        }
+
+        const int64_t max_distance = tsp.distance_oracle.max_distance_bound();
+        const Coordinates& coordinates = tsp.distance_oracle.coordinates();
+        const DistanceType type = tsp.distance_oracle.get_type();
+        const size_t n = tsp.city_count;
+
+        // 行ごとにベクトル化したカーネルで計算し、行を並列に埋める
+        auto fill = [&]<typename W>(TriangularDistanceMatrix<W>& matrix) {
+            mpi::parallel_for(0, n, [&](size_t i) {
+                thread_local std::vector<int32_t> buffer;
+                buffer.resize(n);
+                kernels::distance_row(coordinates, type, i, i + 1, n, buffer.data());
+                std::copy(buffer.begin(), buffer.begin() + (n - i - 1), matrix.row_data(i));
+            }, options.thread_count);
+        };
+
+        if (TriangularDistanceMatrix<uint16_t>::can_represent(max_distance)) {
+            fill(tsp.distance_matrix.emplace<TriangularDistanceMatrix<uint16_t>>(n));
+        } else if (TriangularDistanceMatrix<int32_t>::can_represent(max_distance)) {
+            fill(tsp.distance_matrix.emplace<TriangularDistanceMatrix<int32_t>>(n));
         }
-        
-        
-        // Fill the adjacency matrix based on the coordinates
-        for (size_t i = 0; i < tsp.city_count; ++i) {
-            for (size_t j = 0; j < tsp.city_count; ++j) {
-                if (i == j) {
-                    tsp.adjacency_matrix[i][j] = 0; // Distance to itself is 0
+    }
+
+    void TSP_Loader::build_neighbor_list(TSP& tsp, const LoadOptions& options) {
+        const DistanceView distance = tsp.distance();
+        const size_t n = tsp.city_count;
+
+        if (n <= options.full_neighbor_list_limit) {
+            // 全都市を距離でソートする
+            const bool use_kernel = tsp.distance_oracle.has_coordinates()
+                                    && kernels::can_use_row_kernel(tsp.distance_oracle.max_distance_bound());
+            tsp.NN_list = NeighborList(n, n == 0 ? 0 : n - 1);
+            mpi::parallel_for(0, n, [&](size_t i) {
+                NeighborList::Entry* row = tsp.NN_list.row_data(i);
+                if (use_kernel) {
+                    thread_local std::vector<int32_t> buffer;
+                    buffer.resize(n);
+                    kernels::distance_row(tsp.distance_oracle.coordinates(), tsp.distance_oracle.get_type(), i, 0, n, buffer.data());
+                    for (size_t j = 0; j < i; ++j) {
+                        row[j] = NeighborList::make_entry(j, buffer[j]);
+                    }
+                    for (size_t j = i + 1; j < n; ++j) {
+                        row[j - 1] = NeighborList::make_entry(j, buffer[j]);
+                    }
                 } else {
-                    double x1 = coordinates[i].first;
-                    double y1 = coordinates[i].second;
-                    double x2 = coordinates[j].first;
-                    double y2 = coordinates[j].second;
-                    if (tsp.distance_type == "EUC_2D") {
-                        tsp.adjacency_matrix[i][j] = distance::EUC_2D(x1, y1, x2, y2);
-                    } else if (tsp.distance_type == "ATT") {
-                        tsp.adjacency_matrix[i][j] = distance::ATT(x1, y1, x2, y2);
-                    } else if (tsp.distance_type == "CEIL_2D") {
-                        tsp.adjacency_matrix[i][j] = distance::CEIL_2D(x1, y1, x2, y2);
-                    } else {
-                        throw std::runtime_error("Unsupported distance type: " + tsp.distance_type);
+                    for (size_t j = 0; j < i; ++j) {
+                        row[j] = NeighborList::make_entry(j, distance(i, j));
+                    }
+                    for (size_t j = i + 1; j < n; ++j) {
+                        row[j - 1] = NeighborList::make_entry(j, distance(i, j));
                     }
                 }
-            }
+                std::sort(row, row + tsp.NN_list.width(),
+                          [](const NeighborList::Entry& a, const NeighborList::Entry& b) {
+                              return a.distance < b.distance;
+                          });
+            }, options.thread_count);
+        } else if (!tsp.distance_oracle.has_coordinates()) {
+            // 座標がない (EXPLICIT) 場合は距離行列の行ごとに近い順に neighbor_count 都市だけ部分ソートする O(N^2)
+            const size_t width = std::min(options.neighbor_count, n - 1);
+            tsp.NN_list = NeighborList(n, width);
+            mpi::parallel_for(0, n, [&](size_t i) {
+                thread_local std::vector<NeighborList::Entry> candidates;
+                candidates.clear();
+                for (size_t j = 0; j < n; ++j) {
+                    if (j != i) {
+                        candidates.push_back(NeighborList::make_entry(j, distance(i, j)));
+                    }
+                }
+                std::partial_sort(candidates.begin(), candidates.begin() + width, candidates.end(),
+                                  [](const NeighborList::Entry& a, const NeighborList::Entry& b) {
+                                      return a.distance != b.distance ? a.distance < b.distance : a.city < b.city;
+                                  });
+                std::copy(candidates.begin(), candidates.begin() + width, tsp.NN_list.row_data(i));
+            }, options.thread_count);
+        } else {
+            // k-d木で近い順に neighbor_count 都市だけ取得する O(N log N)
+            tsp.spatial_index = KDTree(tsp.distance_oracle.coordinates());
+            const size_t width = std::min(options.neighbor_count, n - 1);
+            tsp.NN_list = NeighborList(n, width);
+            mpi::parallel_for(0, n, [&](size_t i) {
+                NeighborList::Entry* row = tsp.NN_list.row_data(i);
+                auto neighbors = tsp.spatial_index.k_nearest(i, width);
+                for (size_t j = 0; j < width; ++j) {
+                    row[j] = NeighborList::make_entry(neighbors[j], distance(i, neighbors[j]));
+                }
+            }, options.thread_count);
         }
 
-        // Construct the nearest neighbor list
-        tsp.NN_list.resize(tsp.city_count);
-        for (size_t i = 0; i < tsp.city_count; ++i) {
-            tsp.NN_list[i].resize(tsp.city_count - 1);
-
-            for (size_t j = 0; j < i; ++j) {
-                tsp.NN_list[i][j] = j;
+        if (options.candidate_type == CandidateType::Alpha && n >= 3) {
+            // alpha 値の計算で近傍リストの外の都市を探すのにk-d木を使う
+            if (tsp.spatial_index.empty() && tsp.distance_oracle.has_coordinates()) {
+                tsp.spatial_index = KDTree(tsp.distance_oracle.coordinates());
             }
-            for (size_t j = i + 1; j < tsp.city_count; ++j) {
-                tsp.NN_list[i][j - 1] = j;
+            AlphaNearnessOptions alpha_options;
+            alpha_options.thread_count = options.thread_count;
+            tsp.NN_list = AlphaNearness(tsp, alpha_options).candidates(options.neighbor_count);
+            if (tsp.NN_list.is_complete()) {
+                tsp.spatial_index = KDTree();
             }
         }
+    }
 
-        for (size_t i = 0; i < tsp.city_count; ++i) {
-            std::sort(tsp.NN_list[i].begin(), tsp.NN_list[i].end(),
-                      [&tsp, i](size_t a, size_t b) {
-                          return tsp.adjacency_matrix[i][a] < tsp.adjacency_matrix[i][b];
-                      });
+    size_t TSP::nearest_outside(size_t city, const std::vector<uint8_t>& excluded) const {
+        if (!spatial_index.empty()) {
+            return spatial_index.nearest_outside(city, excluded);
         }
 
-        file.close();
-        return tsp;
+        const DistanceView distance = this->distance();
+        size_t best = std::numeric_limits<size_t>::max();
+        int64_t best_distance = std::numeric_limits<int64_t>::max();
+        for (size_t i = 0; i < city_count; ++i) {
+            if (excluded[i]) {
+                continue;
+            }
+            int64_t d = distance(city, i);
+            if (d < best_distance) {
+                best_distance = d;
+                best = i;
+            }
+        }
+        return best;
     }
 }
\ No newline at end of file
@@ -3,38 +3,137 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <variant>
+#include <memory>
+#include <limits>
 
-namespace tsp {
-    namespace distance {
-        inline int64_t EUC_2D(double x1, double y1, double x2, double y2) {
-            return size_t(std::sqrt((x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2)) + 0.5);
-        }
-        
-        inline int64_t ATT(double x1, double y1, double x2, double y2) {
-            double dx = x1 - x2;
-            double dy = y1 - y2;
-            double rij = std::sqrt((dx * dx + dy * dy) / 10.0);
-            int64_t tij = int(rij + 0.5);
-            if (tij < rij) return tij + 1;
-            else return tij;
-        }
+#include "distance_oracle.hpp"
+#include "neighbor_list.hpp"
+#include "kd_tree.hpp"
 
-        inline int64_t CEIL_2D(double x1, double y1, double x2, double y2) {
-            double dx = x1 - x2;
-            double dy = y1 - y2;
-            return int64_t(std::ceil(std::sqrt(dx * dx + dy * dy)));
-        }
-    }
-    
-    using adjacency_matrix_t = std::vector<std::vector<int64_t>>;
-    using NN_list_t = std::vector<std::vector<size_t>>;
+namespace tsp {
+    /**
+     * @brief 読み込み時に最大距離から要素の型を選択する上三角距離行列
+     * @details std::monostate は距離行列を構築していないことを表す
+     */
+    using CompactDistanceMatrix = std::variant<std::monostate,
+                                               TriangularDistanceMatrix<uint16_t>,
+                                               TriangularDistanceMatrix<int32_t>>;
 
     struct TSP {
         std::string name;
         std::string distance_type;
         size_t city_count;
-        adjacency_matrix_t adjacency_matrix;
+        /**
+         * @brief 上三角の距離行列 (都市数が LoadOptions::distance_matrix_limit を超える場合は構築しない)
+         * @details EDGE_WEIGHT_TYPE が EXPLICIT の場合は距離の唯一の情報源なので、都市数によらず常に保持する
+         */
+        CompactDistanceMatrix distance_matrix;
+        /**
+         * @brief 近傍リスト (都市数が LoadOptions::full_neighbor_list_limit を超える場合は近い順に LoadOptions::neighbor_count 都市まで)
+         * @details LoadOptions::candidate_type が Alpha の場合は alpha 値の小さい順に LoadOptions::neighbor_count 都市まで
+         */
         NN_list_t NN_list;
+        /**
+         * @brief 近傍リストが全都市を含まない場合の近傍探索に使うk-d木 (近傍リストが全都市を含む場合と座標がない場合は空)
+         */
+        KDTree spatial_index;
+        /**
+         * @brief 座標から距離を計算する距離オラクル (EXPLICIT の場合は座標を持たない)
+         */
+        DistanceOracle distance_oracle;
+
+        /**
+         * @brief 距離行列があれば距離行列を、なければ距離オラクルを参照するビューを取得する
+         * @return 距離ビュー
+         */
+        DistanceView distance() const {
+            return std::visit([this](const auto& matrix) -> DistanceView {
+                if constexpr (std::is_same_v<std::remove_cvref_t<decltype(matrix)>, std::monostate>) {
+                    return DistanceView(distance_oracle);
+                } else {
+                    return DistanceView(matrix);
+                }
+            }, distance_matrix);
+        }
+
+        /**
+         * @brief excluded[c] が偽である都市のうち、都市に最も近い都市を取得する
+         * @details 近傍リストを使い切った部分巡回路の統合で使用する
+         * @param city 基準の都市
+         * @param excluded 除外する都市のフラグ
+         * @return 最も近い都市 (該当する都市がない場合は std::numeric_limits<size_t>::max())
+         */
+        size_t nearest_outside(size_t city, const std::vector<uint8_t>& excluded) const;
+    };
+
+    /**
+     * @brief 読み込んだインスタンスを共有する読み取り専用のハンドル
+     * @details
+     *  Environment などにはTSP自体ではなくこのハンドルを持たせ、インスタンスの実体を1つだけにする。
+     *  DistanceView は参照先のTSPを指すので、ハンドルが生存している間は有効である。
+     */
+    using InstanceData = std::shared_ptr<const TSP>;
+
+    /**
+     * @brief 近傍リストの並べ方
+     */
+    enum class CandidateType {
+        /**
+         * @brief 距離の近い順
+         */
+        Nearest,
+        /**
+         * @brief 1-treeに基づく alpha 値の小さい順 (AlphaNearness)
+         */
+        Alpha,
+    };
+
+    /**
+     * @brief 文字列 ("nearest" または "alpha") から近傍リストの並べ方を取得する
+     * @throws std::runtime_error 対応していない文字列の場合
+     */
+    CandidateType parse_candidate_type(const std::string& type_name);
+
+    /**
+     * @brief TSPファイルの読み込みオプション
+     */
+    struct LoadOptions {
+        /**
+         * @brief 距離行列を構築する都市数の上限
+         * @details 都市数がこれを超える場合、距離行列は構築せず距離オラクルのみを使用する
+         */
+        size_t distance_matrix_limit = 20000;
+        /**
+         * @brief 全都市を含む近傍リストを構築する都市数の上限
+         * @details
+         *  都市数がこれを超える場合、k-d木で近い順に neighbor_count 都市だけの近傍リストを構築する。
+         *  全都市を対象とした2-optの結果が変わるため、既定では切り詰めない。
+         */
+        size_t full_neighbor_list_limit = std::numeric_limits<size_t>::max();
+        /**
+         * @brief 近傍リストを切り詰める場合の1都市あたりの近傍都市の数
+         * @details candidate_type が Alpha の場合は、都市数によらず近傍リストをこの数に切り詰める
+         */
+        size_t neighbor_count = 50;
+        /**
+         * @brief 近傍リストの並べ方
+         * @details
+         *  Alpha の場合は距離の近い順の近傍リストから alpha 値を計算し、
+         *  alpha 値の小さい順に neighbor_count 都市を並べた近傍リストに置き換える
+         */
+        CandidateType candidate_type = CandidateType::Nearest;
+        /**
+         * @brief 前処理済みのバイナリファイルを置くディレクトリ (空の場合はバイナリファイルを使用しない)
+         * @details
+         *  <ディレクトリ>/<TSPファイル名>.tspbin が元のファイルと一致すればメモリマップして読み込み、
+         *  存在しないか古い場合はTSPファイルを解析して作成する
+         */
+        std::string binary_cache_directory;
+        /**
+         * @brief 距離行列と近傍リストの構築に使うスレッド数 (0の場合はハードウェアのスレッド数)
+         */
+        size_t thread_count = 0;
     };
 
     class TSP_Loader {
@@ -42,7 +141,27 @@ namespace tsp {
             TSP_Loader() = default;
             ~TSP_Loader() = default;
 
-            static TSP load_tsp(const std::string& file_name);
+            static TSP load_tsp(const std::string& file_name, const LoadOptions& options = {});
+            /**
+             * @brief TSPファイルを読み込み、共有ハンドルとして取得する
+             * @details load_tsp と同じく読み込み、結果をコピーせずにハンドルへ移す
+             */
+            static InstanceData load_instance(const std::string& file_name, const LoadOptions& options = {});
         private:
+            /**
+             * @brief TSPLIB形式のテキストファイルを解析する
+             * @details
+             *  座標 (NODE_COORD_SECTION) のほか、EXPLICIT の EDGE_WEIGHT_SECTION を
+             *  FULL_MATRIX / UPPER_ROW / UPPER_DIAG_ROW / LOWER_ROW / LOWER_DIAG_ROW 形式で読み込める
+             */
+            static TSP parse_tsp(const std::string& file_name, const LoadOptions& options);
+            /**
+             * @brief 座標から距離行列を構築する (都市数が上限を超える場合は構築しない)
+             */
+            static void build_distance_matrix(TSP& tsp, const LoadOptions& options);
+            /**
+             * @brief 近傍リストを構築する (candidate_type が Alpha の場合は alpha 値の順の近傍リストに置き換える)
+             */
+            static void build_neighbor_list(TSP& tsp, const LoadOptions& options);
     };
 }
\ No newline at end of file
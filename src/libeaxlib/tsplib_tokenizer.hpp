@@ -0,0 +1,142 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+namespace tsp {
+    /**
+     * @brief TSPLIB形式のテキストを割り当てなしで読み進めるトークナイザ
+     * @details
+     *  テキスト (通常はメモリマップしたファイル) を行単位で切り出し、
+     *  数値は std::from_chars で直接解析する。エラーにはファイル先頭からのバイトオフセットを含める。
+     */
+    class TsplibTokenizer {
+    public:
+        explicit TsplibTokenizer(std::string_view text) : text(text) {}
+
+        /**
+         * @brief 次の行を取得する (改行文字は含まない)
+         * @param line 取得した行
+         * @return 行を取得できた場合は true、テキストの末尾に達した場合は false
+         */
+        bool next_line(std::string_view& line) {
+            if (position >= text.size()) {
+                return false;
+            }
+            current_line_offset = position;
+            size_t end = text.find('\n', position);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            line = text.substr(position, end - position);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            position = end + 1;
+            return true;
+        }
+
+        /**
+         * @brief 空白と改行を飛ばして次の数値を読む (EDGE_WEIGHT_SECTION のように行をまたぐ数値列用)
+         * @param value 解析した値
+         * @return 解析できた場合は true。テキストの末尾に達したか、次のトークンが数値でない場合は false (位置は進めない)
+         */
+        template <typename T>
+        bool next_number(T& value) {
+            while (position < text.size() && is_space(text[position])) {
+                ++position;
+            }
+            if (position >= text.size()) {
+                return false;
+            }
+            const char* p = text.data() + position;
+            if (!parse_field(p, text.data() + text.size(), value)) {
+                return false;
+            }
+            position = offset_of(p);
+            return true;
+        }
+
+        /**
+         * @brief 最後に取得した行の先頭のバイトオフセット
+         */
+        size_t line_offset() const {
+            return current_line_offset;
+        }
+
+        /**
+         * @brief 現在の読み取り位置のバイトオフセット
+         */
+        size_t offset() const {
+            return position;
+        }
+
+        /**
+         * @brief テキスト中の位置のバイトオフセットを取得する
+         */
+        size_t offset_of(const char* p) const {
+            return static_cast<size_t>(p - text.data());
+        }
+
+        /**
+         * @brief 空白とタブを飛ばして数値を1つ解析する
+         * @param p 解析を始める位置 (成功した場合は数値の直後に進む)
+         * @param end 解析範囲の末尾
+         * @param value 解析した値
+         * @return 解析できた場合は true
+         */
+        template <typename T>
+        static bool parse_field(const char*& p, const char* end, T& value) {
+            p = skip_blanks(p, end);
+            // from_chars は先頭の '+' を受け付けないので読み飛ばす
+            if (p != end && *p == '+') {
+                ++p;
+            }
+            auto [next, ec] = std::from_chars(p, end, value);
+            if (ec != std::errc()) {
+                return false;
+            }
+            p = next;
+            return true;
+        }
+
+        static bool is_space(char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+        }
+
+        static const char* skip_blanks(const char* p, const char* end) {
+            while (p != end && (*p == ' ' || *p == '\t')) {
+                ++p;
+            }
+            return p;
+        }
+
+        /**
+         * @brief 前後の空白を取り除く
+         */
+        static std::string_view trim(std::string_view s) {
+            constexpr std::string_view whitespace = " \t\r\n\v\f";
+            size_t begin = s.find_first_not_of(whitespace);
+            if (begin == std::string_view::npos) {
+                return {};
+            }
+            size_t end = s.find_last_not_of(whitespace);
+            return s.substr(begin, end - begin + 1);
+        }
+
+        /**
+         * @brief バイトオフセットを付けて例外を投げる
+         * @throws std::runtime_error 常に投げる
+         */
+        [[noreturn]] static void fail(size_t offset, const std::string& message) {
+            throw std::runtime_error(message + " (at byte " + std::to_string(offset) + ")");
+        }
+
+    private:
+        std::string_view text;
+        size_t position = 0;
+        size_t current_line_offset = 0;
+    };
+}
\ No newline at end of file
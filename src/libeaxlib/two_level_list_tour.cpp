@@ -0,0 +1,251 @@
+#include "two_level_list_tour.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace eax {
+    void TwoLevelListTour::reset(const std::vector<size_t>& path) {
+        const size_t n = path.size();
+        cities.resize(n);
+        reversed = false;
+        needs_rebalance = false;
+        if (n == 0) {
+            segments.clear();
+            return;
+        }
+
+        const size_t group_size = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(n))));
+        const size_t segment_count = (n + group_size - 1) / group_size;
+        max_segment_size = static_cast<uint32_t>(4 * group_size);
+        segments.resize(segment_count);
+        for (size_t s = 0; s < segment_count; ++s) {
+            Segment& segment = segments[s];
+            segment.next = static_cast<uint32_t>((s + 1) % segment_count);
+            segment.prev = static_cast<uint32_t>((s + segment_count - 1) % segment_count);
+            segment.rank = static_cast<uint32_t>(s);
+            segment.reversed = false;
+
+            const size_t begin = s * group_size;
+            const size_t end = std::min(n, begin + group_size);
+            buffer.assign(path.begin() + begin, path.begin() + end);
+            assign_oriented(static_cast<uint32_t>(s), buffer.data(), buffer.data() + buffer.size());
+        }
+    }
+
+    void TwoLevelListTour::reverse_range(size_t prev_L, size_t next_R) {
+        const uint32_t a = static_cast<uint32_t>(get_next(prev_L));
+        if (a == next_R) { // 反転する区間が空
+            return;
+        }
+        const uint32_t b = static_cast<uint32_t>(get_prev(next_R));
+        reverse_path(a, b);
+
+        if (needs_rebalance) {
+            // 大きくなりすぎたセグメントがあれば、巡回路の向きを保ったまま分け直す O(N)
+            std::vector<size_t> path;
+            to_path(path);
+            reset(path);
+        }
+    }
+
+    void TwoLevelListTour::to_path(std::vector<size_t>& path) const {
+        path.clear();
+        path.reserve(cities.size());
+        uint32_t s = 0;
+        for (size_t k = 0; k < segments.size(); ++k) {
+            const Segment& segment = segments[s];
+            if (is_backward(s)) {
+                for (uint32_t city = segment.last; city != NONE; city = cities[city].prev) {
+                    path.push_back(city);
+                }
+            } else {
+                for (uint32_t city = segment.first; city != NONE; city = cities[city].next) {
+                    path.push_back(city);
+                }
+            }
+            s = next_segment(s);
+        }
+    }
+
+    uint32_t TwoLevelListTour::segment_distance(uint32_t a, uint32_t b) const {
+        const uint32_t segment_count = static_cast<uint32_t>(segments.size());
+        const uint32_t from = segments[reversed ? b : a].rank;
+        const uint32_t to = segments[reversed ? a : b].rank;
+        return (to + segment_count - from) % segment_count;
+    }
+
+    void TwoLevelListTour::oriented_cities(uint32_t segment, std::vector<uint32_t>& out) const {
+        out.clear();
+        for (uint32_t city = segments[segment].first; city != NONE; city = cities[city].next) {
+            out.push_back(city);
+        }
+        if (is_backward(segment)) {
+            std::reverse(out.begin(), out.end());
+        }
+    }
+
+    void TwoLevelListTour::assign_oriented(uint32_t segment, const uint32_t* begin, const uint32_t* end) {
+        const uint32_t size = static_cast<uint32_t>(end - begin);
+        const bool backward = is_backward(segment);
+        // セグメント内の first から数えた i 番目の都市
+        auto raw = [begin, size, backward](uint32_t i) {
+            return backward ? begin[size - 1 - i] : begin[i];
+        };
+        for (uint32_t i = 0; i < size; ++i) {
+            City& node = cities[raw(i)];
+            node.segment = segment;
+            node.rank = i;
+            node.prev = i > 0 ? raw(i - 1) : NONE;
+            node.next = i + 1 < size ? raw(i + 1) : NONE;
+        }
+        Segment& target = segments[segment];
+        target.first = raw(0);
+        target.last = raw(size - 1);
+        target.size = size;
+        if (size > max_segment_size) {
+            needs_rebalance = true;
+        }
+    }
+
+    void TwoLevelListTour::reverse_path(uint32_t a, uint32_t b) {
+        if (get_next(b) == a) { // 巡回路全体の反転は向きの反転と同じ
+            reversed = !reversed;
+            return;
+        }
+
+        // 補集合を反転した場合は、最後に巡回路全体の向きを反転する
+        bool flip = false;
+        bool side_chosen = false;
+        while (true) {
+            const uint32_t sa = cities[a].segment;
+            const uint32_t sb = cities[b].segment;
+            if (sa == sb) {
+                const uint32_t i = position(a);
+                const uint32_t j = position(b);
+                if (i <= j) {
+                    reverse_within(sa, i, j);
+                } else {
+                    // a から b までが巡回路を一周する場合、補集合はセグメント内に収まる
+                    reverse_within(sa, j + 1, i - 1);
+                    flip = !flip;
+                }
+                break;
+            }
+            if (!side_chosen) {
+                side_chosen = true;
+                if (2 * segment_distance(sa, sb) > segments.size()) {
+                    const uint32_t complement_begin = static_cast<uint32_t>(get_next(b));
+                    const uint32_t complement_end = static_cast<uint32_t>(get_prev(a));
+                    a = complement_begin;
+                    b = complement_end;
+                    flip = !flip;
+                    continue;
+                }
+            }
+            if (position(a) != 0) {
+                split_before(a, sb);
+                continue;
+            }
+            if (position(b) != segments[sb].size - 1) {
+                split_after(b, sa);
+                continue;
+            }
+            reverse_segments(sa, sb);
+            break;
+        }
+        if (flip) {
+            reversed = !reversed;
+        }
+    }
+
+    void TwoLevelListTour::reverse_within(uint32_t segment, uint32_t i, uint32_t j) {
+        oriented_cities(segment, buffer);
+        std::reverse(buffer.begin() + i, buffer.begin() + j + 1);
+        assign_oriented(segment, buffer.data(), buffer.data() + buffer.size());
+    }
+
+    void TwoLevelListTour::split_before(uint32_t a, uint32_t avoided) {
+        const uint32_t segment = cities[a].segment;
+        const uint32_t prev = prev_segment(segment);
+        const uint32_t next = next_segment(segment);
+        oriented_cities(segment, buffer);
+        const uint32_t* begin = buffer.data();
+        const uint32_t* split = begin + position(a);
+        const uint32_t* end = begin + buffer.size();
+
+        if (prev != avoided && split - begin <= end - split) {
+            // a より前の部分を前のセグメントの末尾に移す
+            oriented_cities(prev, other_buffer);
+            other_buffer.insert(other_buffer.end(), begin, split);
+            assign_oriented(prev, other_buffer.data(), other_buffer.data() + other_buffer.size());
+            assign_oriented(segment, split, end);
+        } else {
+            // a 以降の部分を次のセグメントの先頭に移す
+            oriented_cities(next, other_buffer);
+            other_buffer.insert(other_buffer.begin(), split, end);
+            assign_oriented(next, other_buffer.data(), other_buffer.data() + other_buffer.size());
+            assign_oriented(segment, begin, split);
+        }
+    }
+
+    void TwoLevelListTour::split_after(uint32_t b, uint32_t avoided) {
+        const uint32_t segment = cities[b].segment;
+        const uint32_t prev = prev_segment(segment);
+        const uint32_t next = next_segment(segment);
+        oriented_cities(segment, buffer);
+        const uint32_t* begin = buffer.data();
+        const uint32_t* split = begin + position(b) + 1;
+        const uint32_t* end = begin + buffer.size();
+
+        if (next != avoided && end - split <= split - begin) {
+            // b より後の部分を次のセグメントの先頭に移す
+            oriented_cities(next, other_buffer);
+            other_buffer.insert(other_buffer.begin(), split, end);
+            assign_oriented(next, other_buffer.data(), other_buffer.data() + other_buffer.size());
+            assign_oriented(segment, begin, split);
+        } else {
+            // b までの部分を前のセグメントの末尾に移す
+            oriented_cities(prev, other_buffer);
+            other_buffer.insert(other_buffer.end(), begin, split);
+            assign_oriented(prev, other_buffer.data(), other_buffer.data() + other_buffer.size());
+            assign_oriented(segment, split, end);
+        }
+    }
+
+    void TwoLevelListTour::reverse_segments(uint32_t a, uint32_t b) {
+        // 巡回路の向きの a から b までの列は、segment.next の向きでは start から end までの列
+        const uint32_t start = reversed ? b : a;
+        const uint32_t end = reversed ? a : b;
+        buffer.clear();
+        for (uint32_t s = start;; s = segments[s].next) {
+            buffer.push_back(s);
+            if (s == end) {
+                break;
+            }
+        }
+        std::reverse(buffer.begin(), buffer.end());
+
+        const uint32_t segment_count = static_cast<uint32_t>(segments.size());
+        const uint32_t count = static_cast<uint32_t>(buffer.size());
+        const uint32_t base_rank = segments[start].rank;
+        const uint32_t outer_prev = segments[start].prev;
+        const uint32_t outer_next = segments[end].next;
+        for (uint32_t i = 0; i < count; ++i) {
+            Segment& segment = segments[buffer[i]];
+            segment.reversed = !segment.reversed;
+            segment.rank = (base_rank + i) % segment_count;
+            if (count == segment_count) {
+                // 全セグメントを反転する場合は環をつなぎ直す
+                segment.prev = buffer[(i + count - 1) % count];
+                segment.next = buffer[(i + 1) % count];
+            } else {
+                segment.prev = i > 0 ? buffer[i - 1] : outer_prev;
+                segment.next = i + 1 < count ? buffer[i + 1] : outer_next;
+            }
+        }
+        if (count != segment_count) {
+            segments[outer_prev].next = buffer.front();
+            segments[outer_next].prev = buffer.back();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace eax {
+    /**
+     * @brief 2段の双方向リストで表した巡回路
+     * @details
+     *  巡回路を約 √N 都市ずつのセグメントに分け、セグメント内の都市とセグメント自体をそれぞれ双方向リストでつなぐ。
+     *  各セグメントは反転フラグと、セグメントの列での順序番号を持ち、各都市はセグメント内での順序番号を持つ。
+     *  区間の反転は、セグメントの境界で分割したうえでセグメントの列を反転し、各セグメントの反転フラグを切り替える O(√N)。
+     *  反転する区間とその補集合のうち短い方を反転し、補集合を反転した場合は巡回路全体の向きのフラグを切り替えるので、
+     *  向きも含めて指定した区間を反転した巡回路と同じになる。
+     *  都市とセグメントはそれぞれ uint32 の添字でつないだ連続した配列に保持する。
+     */
+    class TwoLevelListTour {
+    public:
+        TwoLevelListTour() = default;
+
+        /**
+         * @brief 指定した訪問順の巡回路を構築する
+         * @param path 都市の訪問順
+         */
+        explicit TwoLevelListTour(const std::vector<size_t>& path) {
+            reset(path);
+        }
+
+        /**
+         * @brief 確保済みの配列を再利用して、指定した訪問順の巡回路を構築し直す O(N)
+         * @param path 都市の訪問順 (都市数は uint32 に収まること)
+         */
+        void reset(const std::vector<size_t>& path);
+
+        /**
+         * @brief 巡回路で次の都市を取得する O(1)
+         */
+        size_t get_next(size_t city) const {
+            const City& node = cities[city];
+            const Segment& segment = segments[node.segment];
+            const uint32_t next = segment.reversed != reversed ? node.prev : node.next;
+            if (next != NONE) {
+                return next;
+            }
+            const Segment& next_segment = segments[reversed ? segment.prev : segment.next];
+            return next_segment.reversed != reversed ? next_segment.last : next_segment.first;
+        }
+
+        /**
+         * @brief 巡回路で前の都市を取得する O(1)
+         */
+        size_t get_prev(size_t city) const {
+            const City& node = cities[city];
+            const Segment& segment = segments[node.segment];
+            const uint32_t prev = segment.reversed != reversed ? node.next : node.prev;
+            if (prev != NONE) {
+                return prev;
+            }
+            const Segment& prev_segment = segments[reversed ? segment.next : segment.prev];
+            return prev_segment.reversed != reversed ? prev_segment.first : prev_segment.last;
+        }
+
+        /**
+         * @brief prev_L の次の都市 L から next_R の前の都市 R までの区間を反転する O(√N)
+         * @details PathTree::reverse_range と同じく、反転後は prev_L の次が R、R から逆順にたどって L の次が next_R になる
+         * @param prev_L 反転する区間の直前の都市
+         * @param next_R 反転する区間の直後の都市
+         */
+        void reverse_range(size_t prev_L, size_t next_R);
+
+        /**
+         * @brief 巡回路を訪問順のベクターに書き出す O(N)
+         * @param path 訪問順を格納するベクター
+         */
+        void to_path(std::vector<size_t>& path) const;
+
+        size_t size() const {
+            return cities.size();
+        }
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        /**
+         * @brief 都市 (next, prev は同じセグメント内の都市だけをつなぎ、端では NONE)
+         */
+        struct City {
+            uint32_t segment;
+            /**
+             * @brief セグメント内で first から数えた順序番号
+             */
+            uint32_t rank;
+            uint32_t next;
+            uint32_t prev;
+        };
+
+        /**
+         * @brief セグメント (first から next をたどると last に着く)
+         */
+        struct Segment {
+            uint32_t first;
+            uint32_t last;
+            uint32_t next;
+            uint32_t prev;
+            /**
+             * @brief セグメントの列で、next の向きに数えた順序番号
+             */
+            uint32_t rank;
+            uint32_t size;
+            /**
+             * @brief セグメント内を last から first の向きにたどるかどうか
+             */
+            bool reversed;
+        };
+
+        /**
+         * @brief セグメント内を巡回路の向きにたどるとき、prev の向きに進むかどうか
+         */
+        bool is_backward(uint32_t segment) const {
+            return segments[segment].reversed != reversed;
+        }
+
+        uint32_t next_segment(uint32_t segment) const {
+            return reversed ? segments[segment].prev : segments[segment].next;
+        }
+
+        uint32_t prev_segment(uint32_t segment) const {
+            return reversed ? segments[segment].next : segments[segment].prev;
+        }
+
+        /**
+         * @brief 巡回路の向きでのセグメント内の位置
+         */
+        uint32_t position(uint32_t city) const {
+            const City& node = cities[city];
+            return is_backward(node.segment) ? segments[node.segment].size - 1 - node.rank : node.rank;
+        }
+
+        /**
+         * @brief 巡回路の向きに a から b までのセグメントの数 (a == b の場合は0)
+         */
+        uint32_t segment_distance(uint32_t a, uint32_t b) const;
+
+        /**
+         * @brief セグメントの都市を巡回路の向きに並べて取得する
+         */
+        void oriented_cities(uint32_t segment, std::vector<uint32_t>& out) const;
+
+        /**
+         * @brief セグメントの都市を巡回路の向きに並べた列で置き換える (順序番号も振り直す)
+         */
+        void assign_oriented(uint32_t segment, const uint32_t* begin, const uint32_t* end);
+
+        /**
+         * @brief 巡回路の向きに a から b までの区間を反転する
+         */
+        void reverse_path(uint32_t a, uint32_t b);
+
+        /**
+         * @brief セグメント内の巡回路の向きでの位置 [i, j] の都市を反転する
+         */
+        void reverse_within(uint32_t segment, uint32_t i, uint32_t j);
+
+        /**
+         * @brief a がセグメントの先頭になるように、a の前後の短い方を隣のセグメントに移す
+         * @param avoided a の前の部分を移してはいけないセグメント (反転する区間の末尾のセグメント)
+         */
+        void split_before(uint32_t a, uint32_t avoided);
+
+        /**
+         * @brief b がセグメントの末尾になるように、b の前後の短い方を隣のセグメントに移す
+         * @param avoided b の後の部分を移してはいけないセグメント (反転する区間の先頭のセグメント)
+         */
+        void split_after(uint32_t b, uint32_t avoided);
+
+        /**
+         * @brief 巡回路の向きに a から b までのセグメントの列を反転する
+         */
+        void reverse_segments(uint32_t a, uint32_t b);
+
+        std::vector<City> cities;
+        std::vector<Segment> segments;
+        /**
+         * @brief 巡回路全体を segment.prev の向きにたどるかどうか
+         */
+        bool reversed = false;
+        /**
+         * @brief 都市を移した結果、これより大きくなったセグメントがあれば反転の後にセグメントを分け直す
+         */
+        uint32_t max_segment_size = 0;
+        bool needs_rebalance = false;
+        /**
+         * @brief セグメントの都市の並べ替えに使う作業領域
+         */
+        std::vector<uint32_t> buffer;
+        std::vector<uint32_t> other_buffer;
+    };
+}
\ No newline at end of file
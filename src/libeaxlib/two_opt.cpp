@@ -1,9 +1,13 @@
 #include "two_opt.hpp"
+#include "two_level_list_tour.hpp"
 
 #include <iostream>
 #include <numeric>
 #include <array>
 #include <chrono>
+#include <atomic>
+#include <stdexcept>
+#include <algorithm>
 
 namespace {
     struct Node {
@@ -273,9 +277,18 @@ namespace {
     
     class PathTree {
     public:
+        PathTree() = default;
+
         PathTree(const std::vector<size_t>& path) {
+            reset(path);
+        }
+
+        /**
+         * @brief 確保済みのノードを再利用して、指定した巡回路の木を構築し直す
+         */
+        void reset(const std::vector<size_t>& path) {
             size_t n = path.size();
-            nodes.resize(n);
+            nodes.assign(n, Node{});
             for (size_t i = 0; i < n; ++i) {
                 nodes[i].city = i;
             }
@@ -391,6 +404,20 @@ namespace {
             }
         }
         
+        size_t size() const {
+            return nodes.size();
+        }
+
+        /**
+         * @brief 巡回路を訪問順のベクターに書き出す
+         */
+        void to_path(std::vector<size_t>& path) {
+            path.clear();
+            for_each([&path](Node& node) {
+                path.push_back(node.city);
+            });
+        }
+
         /**
          * @pre func は PathTree の状態を変更しないこと
          */
@@ -424,22 +451,200 @@ namespace {
         size_t root;
     };
 
-    double time_a = 0.0;
+    std::atomic<double> time_a = 0.0;
     
+    /**
+     * @brief Or-opt で移す区間の最大の長さ
+     */
+    constexpr size_t OR_OPT_MAX_SEGMENT = 3;
+
+    /**
+     * @brief 区間 first..last を隣接する c と d = next(c) の間に移す
+     * @details
+     *  p = prev(first), n = next(last) とし、p first..last n ... c d を p n ... c last..first d にする。
+     *  操作は2-optと同じ区間の反転を2〜3回組み合わせて行う。c と d は区間に含まれてはならない。
+     * @param keep_orientation true の場合は c first..last d の向きで挿入する
+     */
+    template <typename Tour>
+    void move_segment(Tour& tree, size_t first, size_t last, size_t c, size_t d, bool keep_orientation) {
+        const size_t p = tree.get_prev(first);
+        const size_t n = tree.get_next(last);
+        if (d != p) {
+            tree.reverse_range(p, d);
+            if (c != n) {
+                tree.reverse_range(p, last);
+            }
+        } else {
+            // c d(=p) first..last n の場合は前の向きに同じ操作をする
+            tree.reverse_range(c, n);
+        }
+        if (keep_orientation) {
+            // c first..last d にする
+            tree.reverse_range(c, d);
+        }
+    }
+
+    /**
+     * @brief current_city を端点とする長さ1〜3の区間を、current_city の近傍都市の隣の辺に (どちらかの向きで) 移す Or-opt を試す
+     * @details
+     *  区間 first..last を p と n の間から c と d の間に移す (move_segment を参照)。
+     *  2-optと同様に、current_city と区間外の隣の都市との距離より近い近傍都市だけを調べる。
+     * @param touched 改善した場合に、変更した辺の端点を格納する
+     * @return 改善した場合は true
+     */
+    template <typename Tour, tsp::distance_matrix_like Distance>
+    bool try_or_opt(
+        Tour& tree,
+        size_t current_city,
+        const Distance& distance_matrix,
+        const tsp::NN_list_t& nearest_neighbors,
+        size_t near_range,
+        bool sorted_by_distance,
+        std::array<size_t, 6>& touched
+    ) {
+        if (tree.size() < 2 * OR_OPT_MAX_SEGMENT + 2) {
+            return false;
+        }
+        for (bool forward : {true, false}) {
+            // forward の場合は current_city から次の向きに、そうでなければ前の向きに区間を伸ばす
+            std::array<size_t, OR_OPT_MAX_SEGMENT> segment;
+            size_t first = current_city;
+            size_t last = current_city;
+            for (size_t length = 1; length <= OR_OPT_MAX_SEGMENT; ++length) {
+                if (length > 1) {
+                    if (forward) {
+                        last = tree.get_next(last);
+                    } else {
+                        first = tree.get_prev(first);
+                    }
+                } else if (!forward) {
+                    // 長さ1の区間は forward で調べた
+                    continue;
+                }
+                segment[length - 1] = forward ? last : first;
+                auto in_segment = [&segment, length](size_t city) {
+                    return std::find(segment.begin(), segment.begin() + length, city) != segment.begin() + length;
+                };
+
+                const size_t p = tree.get_prev(first);
+                const size_t n = tree.get_next(last);
+                const size_t outer_city = forward ? p : n;
+                const int64_t removed = distance_matrix[p][first] + distance_matrix[last][n] - distance_matrix[p][n];
+                for (size_t i = 0; i < near_range; ++i) {
+                    const size_t neighbor_city = nearest_neighbors[current_city][i];
+                    if (distance_matrix[current_city][neighbor_city] >= distance_matrix[current_city][outer_city]) {
+                        if (sorted_by_distance) break;
+                        continue;
+                    }
+                    if (in_segment(neighbor_city)) {
+                        continue;
+                    }
+                    for (bool after_neighbor : {true, false}) {
+                        // 区間を c と d = next(c) の間に移す
+                        const size_t c = after_neighbor ? neighbor_city : tree.get_prev(neighbor_city);
+                        const size_t d = after_neighbor ? tree.get_next(neighbor_city) : neighbor_city;
+                        if (in_segment(c) || in_segment(d)) {
+                            continue;
+                        }
+                        const int64_t base = removed + distance_matrix[c][d];
+                        const int64_t gain_keep = base - distance_matrix[c][first] - distance_matrix[last][d];
+                        const int64_t gain_reverse = base - distance_matrix[c][last] - distance_matrix[first][d];
+                        if (gain_keep <= 0 && gain_reverse <= 0) {
+                            continue;
+                        }
+
+                        move_segment(tree, first, last, c, d, gain_keep > gain_reverse);
+                        touched = {p, n, first, last, c, d};
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief current_city と隣の都市の間の辺について、2-optの代わりに1都市を移す 2h-opt を試す
+     * @details
+     *  2-optと同じく a = current_city, b = a の隣の都市, c = a の近傍都市, d = c の同じ向きの隣の都市とし、
+     *  辺 (a, b) と (c, d) を付け替える代わりに、c を a と b の間に移すか、b を c と d の間に移す。
+     *  2-optと同様に、a との距離が b より近い近傍都市だけを調べる。
+     * @param touched 改善した場合に、変更した辺の端点を格納する
+     * @return 改善した場合は true
+     */
+    template <typename Tour, tsp::distance_matrix_like Distance>
+    bool try_two_h_opt(
+        Tour& tree,
+        size_t current_city,
+        const Distance& distance_matrix,
+        const tsp::NN_list_t& nearest_neighbors,
+        size_t near_range,
+        bool sorted_by_distance,
+        std::array<size_t, 6>& touched
+    ) {
+        if (tree.size() < 5) {
+            return false;
+        }
+        const size_t a = current_city;
+        for (bool forward : {true, false}) {
+            // forward の場合は次の向きを、そうでなければ前の向きを「隣」とする
+            auto succ = [&tree, forward](size_t city) { return forward ? tree.get_next(city) : tree.get_prev(city); };
+            auto pred = [&tree, forward](size_t city) { return forward ? tree.get_prev(city) : tree.get_next(city); };
+            const size_t b = succ(a);
+            const size_t nb = succ(b);
+            for (size_t i = 0; i < near_range; ++i) {
+                const size_t c = nearest_neighbors[a][i];
+                if (distance_matrix[a][c] >= distance_matrix[a][b]) {
+                    if (sorted_by_distance) break;
+                    continue;
+                }
+                const size_t d = succ(c);
+                const size_t pc = pred(c);
+                // c を a と b の間に移す: (pc, c), (c, d), (a, b) を (pc, d), (a, c), (c, b) にする
+                const int64_t gain_move_c = distance_matrix[a][b] + distance_matrix[pc][c] + distance_matrix[c][d]
+                                          - distance_matrix[a][c] - distance_matrix[c][b] - distance_matrix[pc][d];
+                // b を c と d の間に移す: (a, b), (b, nb), (c, d) を (a, nb), (c, b), (b, d) にする
+                const int64_t gain_move_b = d == b ? 0
+                                          : distance_matrix[a][b] + distance_matrix[b][nb] + distance_matrix[c][d]
+                                          - distance_matrix[a][nb] - distance_matrix[c][b] - distance_matrix[b][d];
+                if (gain_move_c <= 0 && gain_move_b <= 0) {
+                    continue;
+                }
+
+                // move_segment は次の向きに隣接する2都市の間に移す
+                if (gain_move_c >= gain_move_b) {
+                    move_segment(tree, c, c, forward ? a : b, forward ? b : a, false);
+                    touched = {a, b, pc, c, d, a};
+                } else {
+                    move_segment(tree, b, b, forward ? c : d, forward ? d : c, false);
+                    touched = {a, b, nb, c, d, b};
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename Tour, tsp::distance_matrix_like Distance>
     void apply_neighbor_2opt(
         std::vector<size_t>& path,
-        const tsp::adjacency_matrix_t& distance_matrix,
+        const Distance& distance_matrix,
         const tsp::NN_list_t& nearest_neighbors,
         const std::vector<std::vector<size_t>>& near_cities,
         size_t near_range,
+        bool sorted_by_distance,
+        bool or_opt,
+        bool two_h_opt,
         std::mt19937::result_type seed
     ){
         std::mt19937 rng(seed);
-        // 平衡二分木を構築
+        // 平衡二分木を構築 (作業領域はスレッドごとに使い回す)
         const size_t n = path.size();
-        PathTree tree(path);
+        thread_local Tour tree;
+        tree.reset(path);
 
-        std::vector<uint8_t> is_active(n, true);
+        thread_local std::vector<uint8_t> is_active;
+        is_active.assign(n, true);
         
         std::uniform_int_distribution<size_t> dist(0, n - 1);
         bool improved = true;
@@ -476,7 +681,7 @@ namespace {
                             improved = true;
                             break;
                         }
-                    } else break;
+                    } else if (sorted_by_distance) break;
                 }
                 
                 if (improved) break;
@@ -500,10 +705,22 @@ namespace {
                             improved = true;
                             break;
                         }
-                    } else break;
+                    } else if (sorted_by_distance) break;
                 }
                 
                 if (improved) break;
+
+                std::array<size_t, 6> touched_cities;
+                if ((two_h_opt && try_two_h_opt(tree, current_city, distance_matrix, nearest_neighbors, near_range, sorted_by_distance, touched_cities))
+                    || (or_opt && try_or_opt(tree, current_city, distance_matrix, nearest_neighbors, near_range, sorted_by_distance, touched_cities))) {
+                    for (size_t city : touched_cities) {
+                        for (auto neighbor : near_cities[city]) {
+                            is_active[neighbor] = true;
+                        }
+                    }
+                    improved = true;
+                    break;
+                }
                 
                 is_active[current_city] = false;
                 
@@ -513,25 +730,27 @@ namespace {
             } while (current_city != start);
         }
 
-        // 最後に木を走査してパスを更新
-        path.clear();
-        tree.for_each([&path](Node& node) {
-            path.push_back(node.city);
-        });
+        // 最後に巡回路を走査してパスを更新
+        tree.to_path(path);
         
     }
     
+    template <typename Tour, tsp::distance_matrix_like Distance>
     void apply_global_2opt(
         std::vector<size_t>& path,
-        const tsp::adjacency_matrix_t& distance_matrix,
+        const Distance& distance_matrix,
         const tsp::NN_list_t& nearest_neighbors,
+        bool sorted_by_distance,
+        bool or_opt,
+        bool two_h_opt,
         std::mt19937::result_type seed
     ) {
         std::mt19937 rng(seed);
         // 平衡二分木を構築
         const size_t n = path.size();
-        const size_t NN_list_size = nearest_neighbors[0].size();
-        PathTree tree(path);
+        const size_t NN_list_size = nearest_neighbors.width();
+        thread_local Tour tree;
+        tree.reset(path);
         
         std::uniform_int_distribution<size_t> dist(0, n - 1);
         bool improved = true;
@@ -555,7 +774,7 @@ namespace {
                             improved = true;
                             break;
                         }
-                    } else break;
+                    } else if (sorted_by_distance) break;
                 }
                 
                 if (improved) break;
@@ -575,10 +794,17 @@ namespace {
                             improved = true;
                             break;
                         }
-                    } else break;
+                    } else if (sorted_by_distance) break;
                 }
                 
                 if (improved) break;
+
+                std::array<size_t, 6> touched_cities;
+                if ((two_h_opt && try_two_h_opt(tree, current_city, distance_matrix, nearest_neighbors, NN_list_size, sorted_by_distance, touched_cities))
+                    || (or_opt && try_or_opt(tree, current_city, distance_matrix, nearest_neighbors, NN_list_size, sorted_by_distance, touched_cities))) {
+                    improved = true;
+                    break;
+                }
                 
                 prev_city = current_city;
                 current_city = next_city;
@@ -586,11 +812,8 @@ namespace {
             } while (current_city != start);
         }
 
-        // 最後に木を走査してパスを更新
-        path.clear();
-        tree.for_each([&path](Node& node) {
-            path.push_back(node.city);
-        });
+        // 最後に巡回路を走査してパスを更新
+        tree.to_path(path);
         
     }
 
@@ -602,32 +825,62 @@ void print_2opt_time() {
     std::cout << "Time: " << time_a << " seconds" << std::endl;
 }
 
-TwoOpt::TwoOpt(const tsp::adjacency_matrix_t &distance_matrix, const tsp::NN_list_t &nearest_neighbors, size_t near_range)
-    : distance_matrix(distance_matrix), nearest_neighbors(nearest_neighbors), near_range(std::min(near_range, nearest_neighbors[0].size()))
+TwoOptBackend parse_two_opt_backend(const std::string& backend_name) {
+    if (backend_name == "splay") {
+        return TwoOptBackend::SplayTree;
+    } else if (backend_name == "two-level") {
+        return TwoOptBackend::TwoLevelList;
+    }
+    throw std::runtime_error("Unknown 2-opt backend '" + backend_name + "'. Options are 'splay' or 'two-level'.");
+}
+
+TwoOpt::TwoOpt(tsp::DistanceView distance_matrix, const tsp::NN_list_t &nearest_neighbors, size_t near_range, TwoOptBackend backend, bool or_opt, bool two_h_opt)
+    : distance_matrix(distance_matrix), nearest_neighbors(nearest_neighbors), near_range(std::min(near_range, nearest_neighbors.width())), backend(backend), or_opt(or_opt), two_h_opt(two_h_opt)
 {
     size_t n = distance_matrix.size();
-    if (near_range >= nearest_neighbors[0].size()) { // 近傍の範囲が距離行列のサイズを超える場合は、近傍はすべての都市なので
-                                                     // 近傍の都市のベクターを作る必要はない
+    const size_t checked_range = uses_global_2opt() ? nearest_neighbors.width() : this->near_range;
+    for (size_t i = 0; i < n && sorted_by_distance; ++i) {
+        const auto neighbors = nearest_neighbors[i];
+        for (size_t j = 1; j < checked_range; ++j) {
+            if (neighbors.distance(j) < neighbors.distance(j - 1)) {
+                sorted_by_distance = false;
+                break;
+            }
+        }
+    }
+    if (uses_global_2opt()) { // 近傍の範囲が距離行列のサイズを超える場合は、近傍はすべての都市なので
+                              // 近傍の都市のベクターを作る必要はない
         return;
     }
     near_cities.resize(n);
     for (size_t i = 0; i < n; ++i) {
-        for (size_t j = 0; j < near_range; ++j) {
-            auto& neighbor_index = nearest_neighbors[i][j];
+        for (size_t j = 0; j < this->near_range; ++j) {
+            size_t neighbor_index = nearest_neighbors[i][j];
             near_cities[neighbor_index].push_back(i);
         }
     }
 }
 
-void TwoOpt::apply(std::vector<size_t>& path, std::mt19937::result_type seed)
+void TwoOpt::apply(std::vector<size_t>& path, std::mt19937::result_type seed) const
 {
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    if (near_range >= nearest_neighbors[0].size()) {
-        apply_global_2opt(path, distance_matrix, nearest_neighbors, seed);
-    } else {
-        apply_neighbor_2opt(path, distance_matrix, nearest_neighbors, near_cities, near_range, seed);
-    }
+    // 距離の型は呼び出しごとに1回だけ選び、局所探索はその型で実体化したコードで行う
+    this->distance_matrix.visit([&](const auto& distance_matrix) {
+        if (backend == TwoOptBackend::TwoLevelList) {
+            if (uses_global_2opt()) {
+                apply_global_2opt<TwoLevelListTour>(path, distance_matrix, nearest_neighbors, sorted_by_distance, or_opt, two_h_opt, seed);
+            } else {
+                apply_neighbor_2opt<TwoLevelListTour>(path, distance_matrix, nearest_neighbors, near_cities, near_range, sorted_by_distance, or_opt, two_h_opt, seed);
+            }
+        } else {
+            if (uses_global_2opt()) {
+                apply_global_2opt<PathTree>(path, distance_matrix, nearest_neighbors, sorted_by_distance, or_opt, two_h_opt, seed);
+            } else {
+                apply_neighbor_2opt<PathTree>(path, distance_matrix, nearest_neighbors, near_cities, near_range, sorted_by_distance, or_opt, two_h_opt, seed);
+            }
+        }
+    });
 
     auto end_time = std::chrono::high_resolution_clock::now();
     time_a += std::chrono::duration<double>(end_time - start_time).count();
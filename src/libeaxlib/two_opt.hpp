@@ -3,37 +3,82 @@
 #include "tsp_loader.hpp"
 
 #include <vector>
+#include <string>
 #include <cstdint>
 #include <random>
 
 namespace eax {
     /**
-     * @brief 2-opt局所探索を表すクラス
+     * @brief 2-optで巡回路の反転に使うデータ構造
+     */
+    enum class TwoOptBackend {
+        /**
+         * @brief ポインタでつないだスプレー木 (反転フラグを遅延して伝播する)
+         */
+        SplayTree,
+        /**
+         * @brief 連続した配列に保持した2段の双方向リスト (TwoLevelListTour)
+         */
+        TwoLevelList,
+    };
+
+    /**
+     * @brief 文字列 ("splay" または "two-level") から2-optのデータ構造を取得する
+     * @throws std::runtime_error 対応していない文字列の場合
+     */
+    TwoOptBackend parse_two_opt_backend(const std::string& backend_name);
+
+    /**
+     * @brief 2-opt局所探索 (必要に応じて 2h-opt と Or-opt も行う) を表すクラス
      */
     class TwoOpt {
     public:
         /**
-         * @brief 指定した距離行列と近傍リストで2-opt局所探索を初期化する
-         * @param distance_matrix 距離行列
+         * @brief 指定した距離と近傍リストで2-opt局所探索を初期化する
+         * @param distance_matrix 距離 (距離行列または距離オラクルへのビュー。参照先はTwoOptより長く生存すること)
          * @param nearest_neighbors 近傍リスト
          * @param near_range 近傍範囲
+         * @param backend 巡回路の反転に使うデータ構造 (どちらでも同じ巡回路になるが、出力の始点は異なる)
+         * @param or_opt 2-optで改善できない都市について、その都市を端点とする長さ1〜3の区間を近傍都市の隣に移す Or-opt も試すかどうか
+         * @param two_h_opt 2-optで改善できない都市について、2-optの代わりに近傍都市か隣の都市の1都市を移す 2h-opt も試すかどうか (Or-opt より先に試す)
          */
-        TwoOpt(const tsp::adjacency_matrix_t& distance_matrix,
+        TwoOpt(tsp::DistanceView distance_matrix,
                const tsp::NN_list_t& nearest_neighbors,
-               size_t near_range = 50);
+               size_t near_range = 50,
+               TwoOptBackend backend = TwoOptBackend::SplayTree,
+               bool or_opt = false,
+               bool two_h_opt = false);
         
         /**
          * @brief 指定した巡回路に対して2-opt局所探索を適用する
          * @param path 巡回路を表す頂点のベクター
+         * @details 作業領域はスレッドごとに確保するので、複数のスレッドから同時に呼び出せる
          * @param seed 乱数シード
          */
-        void apply(std::vector<size_t>& path, std::mt19937::result_type seed = std::mt19937::default_seed);
+        void apply(std::vector<size_t>& path, std::mt19937::result_type seed = std::mt19937::default_seed) const;
 
     private:
-        tsp::adjacency_matrix_t distance_matrix;
+        /**
+         * @brief 近傍リストが全都市を含み、近傍範囲がそれ以上の場合は全都市を対象とした2-optを使う
+         */
+        bool uses_global_2opt() const {
+            return nearest_neighbors.is_complete() && near_range >= nearest_neighbors.width();
+        }
+
+        tsp::DistanceView distance_matrix;
         tsp::NN_list_t nearest_neighbors;
         std::vector<std::vector<size_t>> near_cities;
         const size_t near_range;
+        /**
+         * @brief 近傍範囲内の近傍都市が距離の近い順に並んでいるかどうか
+         * @details
+         *  近い順に並んでいれば、利得が正にならない近傍都市が現れた時点で以降の近傍都市を打ち切れる。
+         *  alpha-nearness の近傍リストのように距離の順でない場合は、近傍範囲内のすべての都市を調べる。
+         */
+        bool sorted_by_distance = true;
+        TwoOptBackend backend;
+        bool or_opt;
+        bool two_h_opt;
     };
     
     void print_2opt_time();
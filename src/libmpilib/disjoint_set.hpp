@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <numeric>
+
+namespace mpi
+{
+    /**
+     * @brief 互いに素な集合を管理する Union-Find
+     * @details 経路半減と、大きさによる併合を行う
+     */
+    class DisjointSet {
+    public:
+        /**
+         * @brief 要素 0, 1, ..., size - 1 をそれぞれ1要素の集合として構築する
+         * @param size 要素数
+         */
+        explicit DisjointSet(size_t size) : parent(size), set_size(size, 1)
+        {
+            std::iota(parent.begin(), parent.end(), 0);
+        }
+
+        /**
+         * @brief 要素が属する集合の代表元を取得する
+         */
+        size_t find(size_t x)
+        {
+            while (parent[x] != x) {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        }
+
+        /**
+         * @brief 2つの要素が属する集合を併合する
+         * @return 異なる集合を併合した場合は true、すでに同じ集合に属していた場合は false
+         */
+        bool unite(size_t a, size_t b)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return false;
+            }
+            if (set_size[a] < set_size[b]) {
+                std::swap(a, b);
+            }
+            parent[b] = a;
+            set_size[a] += set_size[b];
+            return true;
+        }
+
+        bool same(size_t a, size_t b)
+        {
+            return find(a) == find(b);
+        }
+
+    private:
+        std::vector<size_t> parent;
+        std::vector<size_t> set_size;
+    };
+}
\ No newline at end of file
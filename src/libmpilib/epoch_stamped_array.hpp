@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+namespace mpi
+{
+    /**
+     * @brief 全要素の初期化を O(1) で行える固定長配列を表すクラス
+     * @details
+     *  各要素に最後に書き込んだ世代 (エポック) を記録し、現在の世代と異なる要素は初期値とみなす。
+     *  reset() は世代を進めるだけなので、使うたびに全要素を初期化していた作業領域を、
+     *  書き込んだ要素の数に比例する手間で使い回せる。
+     *  世代が一周した場合だけ、世代の記録を O(N) で消去する。
+     * @tparam T 要素の型
+     */
+    template <typename T>
+    class EpochStampedArray {
+    public:
+        using value_type = T;
+        using size_type = size_t;
+
+        /**
+         * @brief 指定した要素数と初期値で配列を構築する
+         * @param size 要素数
+         * @param initial_value 書き込まれていない要素の値
+         */
+        EpochStampedArray(size_t size = 0, const T& initial_value = T())
+            : values(size), stamps(size, 0), initial_value(initial_value) {}
+
+        /**
+         * @brief すべての要素を初期値に戻す O(1)
+         */
+        void reset()
+        {
+            if (++epoch == 0) {
+                std::fill(stamps.begin(), stamps.end(), 0);
+                epoch = 1;
+            }
+        }
+
+        /**
+         * @brief 初期値を変えて、すべての要素を新しい初期値に戻す O(1)
+         * @param initial_value 書き込まれていない要素の値
+         */
+        void reset(const T& initial_value)
+        {
+            this->initial_value = initial_value;
+            reset();
+        }
+
+        /**
+         * @brief 要素数と初期値を変えて、すべての要素を初期値に戻す
+         * @details 要素数が変わる場合は O(N)、変わらない場合は O(1)
+         * @param size 要素数
+         * @param initial_value 書き込まれていない要素の値
+         */
+        void reset(size_t size, const T& initial_value)
+        {
+            if (size != values.size()) {
+                values.resize(size);
+                stamps.assign(size, 0);
+                epoch = 1;
+            }
+            reset(initial_value);
+        }
+
+        /**
+         * @brief 要素への参照を返す
+         * @details 現在の世代で書き込まれていない要素は、初期値を書き込んでから返す
+         * @param index 要素の位置
+         * @return 要素への参照
+         */
+        T& operator[](size_t index)
+        {
+            if (stamps[index] != epoch) {
+                stamps[index] = epoch;
+                values[index] = initial_value;
+            }
+            return values[index];
+        }
+
+        /**
+         * @brief 要素の値を返す
+         * @param index 要素の位置
+         * @return 要素の値 (現在の世代で書き込まれていなければ初期値)
+         */
+        const T& operator[](size_t index) const
+        {
+            return stamps[index] == epoch ? values[index] : initial_value;
+        }
+
+        /**
+         * @brief 要素が現在の世代で書き込まれたかを判定する
+         * @param index 要素の位置
+         * @return 書き込まれている場合はtrue、そうでない場合はfalse
+         */
+        bool is_set(size_t index) const
+        {
+            return stamps[index] == epoch;
+        }
+
+        /**
+         * @brief 要素数を返す
+         * @return 要素数
+         */
+        size_type size() const
+        {
+            return values.size();
+        }
+
+    private:
+        std::vector<T> values;
+        std::vector<uint32_t> stamps;
+        /**
+         * @brief 現在の世代 (stamps の初期値 0 とは常に異なる)
+         */
+        uint32_t epoch = 1;
+        T initial_value;
+    };
+}
\ No newline at end of file
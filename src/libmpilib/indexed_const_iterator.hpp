@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace mpi
+{
+    /**
+     * @brief コンテナへのポインタと添字で要素をたどる読み取り専用のランダムアクセスイテレータ
+     * @details
+     *  要素を値で返すコンテナ (格納形式と公開する型が異なるもの) のイテレータとして使う。
+     *  参照外しは (*container)[index] を呼ぶので、コンテナは添字演算子を持つこと。
+     * @tparam Container 要素をたどるコンテナの型
+     * @tparam Ref 参照外しで返す型 (値またはビュー)
+     */
+    template <typename Container, typename Ref>
+    class indexed_const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cvref_t<Ref>;
+        using difference_type = std::ptrdiff_t;
+        using reference = Ref;
+        using pointer = void;
+
+        indexed_const_iterator() = default;
+        indexed_const_iterator(const Container* container, size_t index) : container(container), index(index) {}
+
+        reference operator*() const { return (*container)[index]; }
+        reference operator[](difference_type n) const { return (*container)[index + n]; }
+
+        indexed_const_iterator& operator++() { ++index; return *this; }
+        indexed_const_iterator operator++(int) { indexed_const_iterator old = *this; ++index; return old; }
+        indexed_const_iterator& operator--() { --index; return *this; }
+        indexed_const_iterator operator--(int) { indexed_const_iterator old = *this; --index; return old; }
+        indexed_const_iterator& operator+=(difference_type n) { index += n; return *this; }
+        indexed_const_iterator& operator-=(difference_type n) { index -= n; return *this; }
+        friend indexed_const_iterator operator+(indexed_const_iterator it, difference_type n) { return it += n; }
+        friend indexed_const_iterator operator+(difference_type n, indexed_const_iterator it) { return it += n; }
+        friend indexed_const_iterator operator-(indexed_const_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const indexed_const_iterator& a, const indexed_const_iterator& b) {
+            return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+        }
+        friend bool operator==(const indexed_const_iterator& a, const indexed_const_iterator& b) { return a.index == b.index; }
+        friend auto operator<=>(const indexed_const_iterator& a, const indexed_const_iterator& b) { return a.index <=> b.index; }
+    private:
+        const Container* container = nullptr;
+        size_t index = 0;
+    };
+}
\ No newline at end of file
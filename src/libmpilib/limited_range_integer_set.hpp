@@ -1,20 +1,31 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <limits>
 #include <stdexcept>
 
+#include "epoch_stamped_array.hpp"
+#include "indexed_const_iterator.hpp"
+
 namespace mpi
 {
     /**
      * @brief 制限付き範囲整数集合を表すクラス
+     * @details
+     *  要素の並びと各値の位置を、世代付きの配列 (EpochStampedArray) に32ビットで持つ。
+     *  reset() は世代を進めるだけの O(1) で、全体集合にリセットした直後の要素の並びは
+     *  書き込まれていない位置を恒等的な並び (k 番目が MIN + k) とみなして表す。
      */
     class LimitedRangeIntegerSet {
     public:
         using size_type = size_t;
-        using iterator = typename std::vector<size_t>::const_iterator;
-        using const_iterator = typename std::vector<size_t>::const_iterator;
+        /**
+         * @brief 集合の要素を先頭から順にたどるランダムアクセスイテレータ
+         */
+        using const_iterator = indexed_const_iterator<LimitedRangeIntegerSet, size_t>;
+        using iterator = const_iterator;
         enum class InitSet {
             /**
              * @brief 空集合で初期化する
@@ -33,48 +44,33 @@ namespace mpi
          * @param min 集合に含まれる最小の整数値 (デフォルトは0)
          */
         LimitedRangeIntegerSet(size_t max, InitSet init_set = InitSet::Universal, size_t min = 0) 
-            : MAX(max), MIN(min)
+            : MAX(max), MIN(min), elements(max - min + 1), positions(max - min + 1)
         {
-            switch (init_set) {
-                case InitSet::Empty:
-                    positions.resize(max - min + 1, std::numeric_limits<size_t>::max());
-                    break;
-                case InitSet::Universal:
-                    elements.reserve(max - min + 1);
-                    positions.reserve(max - min + 1);
-                    for (size_t i = 0; i <= max - min; ++i) {
-                        elements.push_back(i + min);
-                        positions.push_back(i);
-                    }
-                    break;
-                default:
-                    throw std::invalid_argument("Invalid initialization set");
+            if (max - min >= NONE) {
+                throw std::length_error("LimitedRangeIntegerSet range does not fit in 32 bits");
             }
+            reset(init_set);
         }
         
         /**
-         * @brief 集合を指定した初期化セットでリセットする
+         * @brief 集合を指定した初期化セットでリセットする O(1)
          * @param init_set 初期化セット
          */
         void reset(InitSet init_set = InitSet::Universal)
         {
             switch (init_set) {
                 case InitSet::Empty:
-                    elements.clear();
-                    positions.assign(MAX - MIN + 1, std::numeric_limits<size_t>::max());
+                    count = 0;
                     break;
                 case InitSet::Universal:
-                    elements.clear();
-                    elements.reserve(MAX - MIN + 1);
-                    positions.clear();
-                    for (size_t i = 0; i <= MAX - MIN; ++i) {
-                        elements.push_back(i + MIN);
-                        positions.push_back(i);
-                    }
+                    count = MAX - MIN + 1;
                     break;
                 default:
                     throw std::invalid_argument("Invalid initialization set");
             }
+            universal = init_set == InitSet::Universal;
+            elements.reset();
+            positions.reset();
         }
         
         /**
@@ -88,7 +84,7 @@ namespace mpi
                 return false;
             }
             
-            return positions[value - MIN] != std::numeric_limits<size_t>::max();
+            return position_of(value) != NONE;
         }
         
         /**
@@ -102,16 +98,16 @@ namespace mpi
                 return 0;
             }
             
-            size_t pos = positions[value - MIN];
-            if (pos == std::numeric_limits<size_t>::max()) {
+            size_t pos = position_of(value);
+            if (pos == NONE) {
                 return 0; // 値が存在しない
             }
             
-            size_t last_value = elements.back();
-            elements[pos] = last_value;
-            positions[last_value - MIN] = pos;
-            elements.pop_back();
-            positions[value - MIN] = std::numeric_limits<size_t>::max();
+            size_t last_value = element_at(count - 1);
+            elements[pos] = static_cast<index_type>(last_value - MIN);
+            positions[last_value - MIN] = static_cast<index_type>(pos);
+            --count;
+            positions[value - MIN] = static_cast<index_type>(NONE);
             
             return 1; // 成功
         }
@@ -127,16 +123,16 @@ namespace mpi
                 throw std::out_of_range("Value out of range");
             }
             
-            size_t pos = positions[value - MIN];
-            if (pos != std::numeric_limits<size_t>::max()) {
-                return {elements.begin() + pos, false}; // 既に存在する
+            size_t pos = position_of(value);
+            if (pos != NONE) {
+                return {iterator(this, pos), false}; // 既に存在する
             }
             
-            elements.push_back(value);
-            pos = elements.size() - 1;
-            positions[value - MIN] = pos;
+            pos = count++;
+            elements[pos] = static_cast<index_type>(value - MIN);
+            positions[value - MIN] = static_cast<index_type>(pos);
             
-            return {elements.begin() + pos, true}; // 新たに挿入された
+            return {iterator(this, pos), true}; // 新たに挿入された
         }
         
         /**
@@ -145,7 +141,7 @@ namespace mpi
          */
         iterator begin() const
         {
-            return elements.cbegin();
+            return const_iterator(this, 0);
         }
         
         /**
@@ -154,7 +150,7 @@ namespace mpi
          */
         const_iterator cbegin() const
         {
-            return elements.cbegin();
+            return const_iterator(this, 0);
         }
 
         /**
@@ -163,7 +159,7 @@ namespace mpi
          */
         iterator end() const
         {
-            return elements.cend();
+            return const_iterator(this, count);
         }
         
         /**
@@ -172,22 +168,63 @@ namespace mpi
          */
         const_iterator cend() const
         {
-            return elements.cend();
+            return const_iterator(this, count);
         }
         
+        /**
+         * @brief k 番目の要素を返す (要素の並びは begin() からたどる順序と同じ)
+         * @param k 位置 (k < size())
+         */
+        size_t operator[](size_t k) const
+        {
+            return element_at(k);
+        }
+
         /**
          * @brief 集合の要素数を返す
          * @return 要素数
          */
         size_type size() const
         {
-            return elements.size();
+            return count;
         }
         
     private:
+        /**
+         * @brief 要素 (MIN からの差) と位置を格納する型 (範囲の大きさは 2^32 - 1 未満)
+         */
+        using index_type = uint32_t;
+        static constexpr size_t NONE = std::numeric_limits<index_type>::max();
+
+        /**
+         * @brief k 番目の要素を返す (k < count)
+         */
+        size_t element_at(size_t k) const
+        {
+            // 書き込まれていない位置は、全体集合にリセットした直後の並びのまま
+            return (elements.is_set(k) ? elements[k] : k) + MIN;
+        }
+
+        /**
+         * @brief 値の要素の並びでの位置を返す (含まれていなければ NONE)
+         */
+        size_t position_of(size_t value) const
+        {
+            const size_t i = value - MIN;
+            if (positions.is_set(i)) {
+                return positions[i];
+            }
+            return universal ? i : NONE;
+        }
+
         const size_t MAX;
         const size_t MIN;
-        std::vector<size_t> elements;
-        std::vector<size_t> positions;
+        EpochStampedArray<index_type> elements;
+        EpochStampedArray<index_type> positions;
+        size_t count = 0;
+        /**
+         * @brief 最後のリセットが全体集合へのリセットかどうか
+         */
+        bool universal = true;
     };
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mpi
+{
+    /**
+     * @brief 使用するスレッド数を決める (0の場合はハードウェアのスレッド数)
+     */
+    inline size_t resolve_thread_count(size_t thread_count)
+    {
+        if (thread_count == 0) {
+            thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        return thread_count;
+    }
+
+    /**
+     * @brief [begin, end) の各インデックスについて関数を並列に呼び出す
+     * @details
+     *  インデックスを chunk_size ずつ原子的なカウンタで動的に割り当てるため、
+     *  反復ごとのコストが異なる場合でもスレッド間の負荷が偏りにくい。
+     *  呼び出し元のスレッドも処理に参加する。関数が例外を投げた場合は残りの処理を打ち切り、最初の例外を再送出する。
+     * @param begin 開始インデックス
+     * @param end 終了インデックス (含まない)
+     * @param func 各インデックスについて呼び出す関数 (異なるスレッドから同時に呼び出される)
+     * @param thread_count 使用するスレッド数 (0の場合はハードウェアのスレッド数)
+     * @param chunk_size 一度に割り当てるインデックスの数
+     */
+    template <typename Func>
+    void parallel_for(size_t begin, size_t end, Func&& func, size_t thread_count = 0, size_t chunk_size = 16)
+    {
+        if (begin >= end) {
+            return;
+        }
+        chunk_size = std::max<size_t>(1, chunk_size);
+        const size_t chunk_count = (end - begin + chunk_size - 1) / chunk_size;
+        thread_count = std::min(resolve_thread_count(thread_count), chunk_count);
+
+        if (thread_count <= 1) {
+            for (size_t i = begin; i < end; ++i) {
+                func(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next(begin);
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto worker = [&]() {
+            try {
+                while (true) {
+                    size_t chunk_begin = next.fetch_add(chunk_size, std::memory_order_relaxed);
+                    if (chunk_begin >= end) {
+                        break;
+                    }
+                    size_t chunk_end = std::min(chunk_begin + chunk_size, end);
+                    for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                        func(i);
+                    }
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(end, std::memory_order_relaxed);
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(thread_count - 1);
+            for (size_t t = 1; t < thread_count; ++t) {
+                threads.emplace_back(worker);
+            }
+            worker();
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
\ No newline at end of file
@@ -23,7 +23,7 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
     using namespace std;
     using Context = eax::Context;
     // オブジェクトプール
-    eax::ObjectPools object_pools(context.env.tsp.city_count);
+    eax::ObjectPools object_pools(context.env.tsp->city_count);
     
     // 交叉関数
     eax::EAX_N_AB eax_n_ab(object_pools);
@@ -33,9 +33,9 @@ std::pair<mpi::genetic_algorithm::TerminationReason, std::vector<Individual>> ex
         auto& env = context.env;
         switch (context.eax_type) {
             case eax::EAXType::One_AB:
-                return eax_n_ab(parent1, parent2, env.num_children, env.tsp, context.random_gen, 1);
+                return eax_n_ab(parent1, parent2, env.num_children, *env.tsp, context.random_gen, 1);
             case eax::EAXType::Block2:
-                return eax_block2(parent1, parent2, env.num_children, env.tsp, context.random_gen);
+                return eax_block2(parent1, parent2, env.num_children, *env.tsp, context.random_gen);
             default:
                 throw std::runtime_error("Unknown EAX type.");
         }